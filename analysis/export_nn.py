@@ -0,0 +1,368 @@
+#!/usr/bin/env python3
+"""Quantize a small dense / 1D-conv network to the int8 tables of src/nn_int8.h.
+
+    python3 analysis/export_nn.py --rules -o project/src/gesture_nn.h
+    python3 analysis/export_nn.py --train ../logs/*.csv --hidden 16 16 \
+        -o project/src/gesture_nn.h
+    python3 analysis/export_nn.py --model cnn.json -o project/src/gesture_nn.h
+
+--rules fits a 5-16-16-4 MLP to the hand-written classify_rules() on synthetic
+windows, so the int8 path can run end to end before there is labelled data.
+--train fits the same MLP on session CSVs labelled by file name (as
+export_tree.py does). Both use the input of quantize_features_u8():
+[amag_std, dom_freq/10, gx_std/300, gy_std/300, gz_std/300] as u8, which the
+network sees as int8 q - 128 (scale 1/255, zero point -128).
+
+--model takes a float network trained elsewhere (the notebook, Keras, ...) as
+JSON:
+
+    {"input": "features" | "window", "in_len": 100, "in_ch": 6,
+     "layers": [{"op": "conv1d", "out_ch": 8, "kernel": 5, "stride": 2,
+                 "relu": true, "w": [[...]], "b": [...]},
+                {"op": "dense", "out_ch": 4, "relu": false, ...}],
+     "calibration": [[...], ...]}
+
+Activations are [time][channel], flattened. w[o] holds the taps of output
+channel o in [kernel][in_ch] order (a Keras Conv1D kernel (k, in_ch, out_ch)
+transposed to (out_ch, k, in_ch)); a dense layer sees the whole input as one
+tap. "window" inputs are the six IMU channels [ax, ay, az, gx, gy, gz] divided
+by their full scale (NN_ACCEL_FS_G, NN_GYRO_FS_DPS), quantized like
+quantize_bits(..., 8) in lab_algorithms/quantization.c (scale 1/128, zero
+point 0). Calibration inputs are in the same units and set the activation
+ranges.
+
+The header also carries a few inputs with the outputs of the integer model
+below, which the host check (imu_nncheck) and the NN_BENCH boot test compare
+nn_run() against bit for bit.
+
+Only the standard library is needed.
+"""
+import argparse
+import json
+import math
+import random
+import sys
+from pathlib import Path
+
+import export_tree
+
+CLASSES = export_tree.CLASSES
+FEATURES_U8 = ["amag_std", "dom_freq/10", "gx_std/300", "gy_std/300", "gz_std/300"]
+N_TESTS = 4
+
+
+# ---- Input quantization -----------------------------------------------------------
+def features_u8(amag_std, dom_freq, gx_std, gy_std, gz_std):
+    """quantize_features_u8(), float32 and round-half-even like lrintf()."""
+    f32 = export_tree.f32
+    v = [f32(amag_std), f32(f32(dom_freq) / 10.0), f32(f32(gx_std) / 300.0),
+         f32(f32(gy_std) / 300.0), f32(f32(gz_std) / 300.0)]
+    out = []
+    for x in v:
+        x = 0.0 if not x > 0 else min(x, 1.0)
+        out.append(round(f32(x * 255.0)))
+    return out
+
+
+def quantize_q7(x):
+    """quantize_bits(&x, 1, 8, ...) of lab_algorithms/quantization.c."""
+    x = min(max(export_tree.f32(x), -1.0), 127.0 / 128.0)
+    return max(-128, min(127, round(export_tree.f32(x * 128.0))))
+
+
+# ---- Float model ----------------------------------------------------------------------
+def shapes(net):
+    """(in_len, in_ch, kernel, stride, out_len) of every layer."""
+    out, length, ch = [], net["in_len"], net["in_ch"]
+    for layer in net["layers"]:
+        k, s = (length, 1) if layer["op"] == "dense" else (layer["kernel"], layer.get("stride", 1))
+        if k > length:
+            sys.exit(f"layer {len(out)}: kernel {k} longer than its input ({length})")
+        out_len = (length - k) // s + 1
+        out.append((length, ch, k, s, out_len))
+        length, ch = out_len, layer["out_ch"]
+    return out
+
+
+def layer_forward(layer, shape, x):
+    _, ch, k, s, out_len = shape
+    taps = k * ch
+    y = []
+    for t in range(out_len):
+        window = x[t * s * ch: t * s * ch + taps]
+        for w, b in zip(layer["w"], layer["b"]):
+            v = b + sum(wi * xi for wi, xi in zip(w, window))
+            y.append(max(v, 0.0) if layer.get("relu") else v)
+    return y
+
+
+def forward(net, x):
+    acts = [x]
+    for layer, shape in zip(net["layers"], shapes(net)):
+        acts.append(layer_forward(layer, shape, acts[-1]))
+    return acts
+
+
+# ---- Quantization -----------------------------------------------------------------------
+def multiplier(m):
+    """m as mult * 2^-shift with mult in [2^30, 2^31)."""
+    frac, exp = math.frexp(m)
+    mult, shift = round(frac * (1 << 31)), 31 - exp
+    if mult == 1 << 31:
+        mult, shift = mult // 2, shift - 1
+    while shift > 62:
+        mult, shift = mult >> 1, shift - 1
+    if shift < 1:
+        sys.exit(f"requantization multiplier {m} out of range")
+    return mult, shift
+
+
+def quantize(net, calibration, in_scale, in_zp):
+    ranges = [[0.0, 0.0] for _ in net["layers"]]
+    for x in calibration:
+        for r, a in zip(ranges, forward(net, x)[1:]):
+            r[0], r[1] = min(r[0], min(a)), max(r[1], max(a))
+
+    layers, s_in, zp_in = [], in_scale, in_zp
+    for layer, shape, (lo, hi) in zip(net["layers"], shapes(net), ranges):
+        s_w = max(abs(v) for w in layer["w"] for v in w) / 127.0 or 1.0
+        w_q = [[max(-127, min(127, round(v / s_w))) for v in w] for w in layer["w"]]
+        bias = [round(b / (s_in * s_w)) - zp_in * sum(w) for b, w in zip(layer["b"], w_q)]
+        s_out = (hi - lo) / 255.0 or 1.0
+        zp_out = max(-128, min(127, round(-128 - lo / s_out)))
+        mult, shift = multiplier(s_in * s_w / s_out)
+        layers.append(dict(layer, shape=shape, w_q=w_q, bias_q=bias, mult=mult, shift=shift,
+                           zp=zp_out, scale=s_out))
+        s_in, zp_in = s_out, zp_out
+    return layers
+
+
+def run_int8(layers, q):
+    """The integer arithmetic of nn_run()."""
+    for L in layers:
+        _, ch, k, s, out_len = L["shape"]
+        lo = L["zp"] if L.get("relu") else -128
+        y = []
+        for t in range(out_len):
+            window = q[t * s * ch: t * s * ch + k * ch]
+            for w, b in zip(L["w_q"], L["bias_q"]):
+                acc = b + sum(wi * xi for wi, xi in zip(w, window))
+                v = ((acc * L["mult"] + (1 << (L["shift"] - 1))) >> L["shift"]) + L["zp"]
+                y.append(max(lo, min(127, v)))
+        q = y
+    return q
+
+
+def argmax(v):
+    return max(range(len(v)), key=lambda i: (v[i], -i))
+
+
+# ---- Training (dense nets, pure Python) ---------------------------------------------------
+def train_mlp(X, y, hidden, epochs, seed=0):
+    rng = random.Random(seed)
+    sizes = [len(X[0])] + hidden + [len(CLASSES)]
+    W = [[[rng.gauss(0.0, math.sqrt(2.0 / n_in)) for _ in range(n_in)] for _ in range(n_out)]
+         for n_in, n_out in zip(sizes, sizes[1:])]
+    B = [[0.0] * n for n in sizes[1:]]
+    rows = [w for Wi in W for w in Wi] + B      # Adam moments per parameter row
+    m1 = {id(p): [0.0] * len(p) for p in rows}
+    m2 = {id(p): [0.0] * len(p) for p in rows}
+    lr, b1, b2, step = 0.01, 0.9, 0.999, 0
+    order = list(range(len(X)))
+    batch = 32
+
+    for epoch in range(epochs):
+        rng.shuffle(order)
+        for start in range(0, len(order), batch):
+            gW = [[[0.0] * len(w) for w in Wi] for Wi in W]
+            gB = [[0.0] * len(b) for b in B]
+            for i in order[start:start + batch]:
+                acts = [X[i]]
+                for li, (Wi, Bi) in enumerate(zip(W, B)):
+                    z = [b + sum(wk * xk for wk, xk in zip(w, acts[-1])) for w, b in zip(Wi, Bi)]
+                    acts.append(z if li == len(W) - 1 else [max(v, 0.0) for v in z])
+                top = max(acts[-1])
+                e = [math.exp(v - top) for v in acts[-1]]
+                total = sum(e)
+                delta = [v / total - (1.0 if c == y[i] else 0.0) for c, v in enumerate(e)]
+                for li in range(len(W) - 1, -1, -1):
+                    a = acts[li]
+                    for o, d in enumerate(delta):
+                        if d == 0.0:
+                            continue
+                        gB[li][o] += d
+                        g = gW[li][o]
+                        for k, ak in enumerate(a):
+                            g[k] += d * ak
+                    if li:
+                        delta = [sum(W[li][o][k] * delta[o] for o in range(len(delta))) if a[k] > 0 else 0.0
+                                 for k in range(len(a))]
+            step += 1
+            c1, c2 = 1 - b1 ** step, 1 - b2 ** step
+            for p, g in [(w, gw) for Wi, gWi in zip(W, gW) for w, gw in zip(Wi, gWi)] + list(zip(B, gB)):
+                v1, v2 = m1[id(p)], m2[id(p)]
+                for k, gk in enumerate(g):
+                    v1[k] = b1 * v1[k] + (1 - b1) * gk
+                    v2[k] = b2 * v2[k] + (1 - b2) * gk * gk
+                    p[k] -= lr * (v1[k] / c1) / (math.sqrt(v2[k] / c2) + 1e-8)
+        if epoch == epochs // 2:
+            lr *= 0.3
+
+    layers = [{"op": "dense", "out_ch": len(Wi), "relu": li < len(W) - 1, "w": Wi, "b": Bi}
+              for li, (Wi, Bi) in enumerate(zip(W, B))]
+    return {"input": "features", "in_len": 1, "in_ch": len(X[0]), "layers": layers}
+
+
+def rules_class(s, df, gx, gy, gz):
+    for name, clauses in export_tree.RULES:
+        v = {"amag_std": s, "dom_freq": df, "gyro_std_mean": (gx + gy + gz) / 3.0}
+        ok = all({">": v[f] > t, ">=": v[f] >= t, "<": v[f] < t, "<=": v[f] <= t}[op]
+                 for f, op, t in clauses)
+        if ok:
+            return CLASSES.index(name)
+    return CLASSES.index("NONE")
+
+
+def rules_data(n, seed=1):
+    """Synthetic windows spread around the thresholds of classify_rules()."""
+    rng = random.Random(seed)
+    X, y = [], []
+    for _ in range(n):
+        s = 10.0 ** rng.uniform(-2.5, 0.0)
+        df = rng.uniform(0.0, 5.0) if rng.random() < 0.8 else rng.uniform(5.0, 10.0)
+        g = [10.0 ** rng.uniform(-0.5, 2.0) for _ in range(3)]
+        X.append([u / 255.0 for u in features_u8(s, df, *g)])
+        y.append(rules_class(s, df, *g))
+    return X, y
+
+
+def csv_data(paths):
+    X, y = [], []
+    F = export_tree.FEATURES
+    Xf, labels = export_tree.load_features(paths)
+    for row, label in zip(Xf, labels):
+        v = dict(zip(F, row))
+        X.append([u / 255.0 for u in features_u8(v["amag_std"], v["dom_freq"], v["gx_std"],
+                                                 v["gy_std"], v["gz_std"])])
+        y.append(CLASSES.index(label))
+    return X, y
+
+
+# ---- Header -------------------------------------------------------------------------------
+def c_array(ctype, name, values, per_line=16):
+    lines = [f"static const {ctype} {name}[{len(values)}] = {{"]
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return lines + ["};"]
+
+
+def export_header(net, layers, tests, path, source, note):
+    window = net["input"] == "window"
+    n_in = net["in_len"] * net["in_ch"]
+    sizes = [n_in] + [L["shape"][4] * L["out_ch"] for L in layers]
+    arena = max(a + b for a, b in zip(sizes, sizes[1:]))
+    macs = sum(L["shape"][4] * L["out_ch"] * L["shape"][2] * L["shape"][1] for L in layers)
+    if arena > 0xFFFF or len(layers) > 255:
+        sys.exit("model too large for nn_model_t")
+
+    desc = " -> ".join([f"[{net['in_len']}x{net['in_ch']}]"] + [
+        f"{L['op']} {L['out_ch']}" + (f" k{L['shape'][2]}/s{L['shape'][3]}" if L["op"] == "conv1d" else "")
+        + (" relu" if L.get("relu") else "") for L in layers])
+    in_scale, in_zp = (1.0 / 128.0, 0) if window else (1.0 / 255.0, -128)
+    out = [
+        f"// GENERATED by analysis/export_nn.py from {source}; do not edit.",
+        "#pragma once",
+        '#include "nn_int8.h"',
+        "",
+        f"// {desc}",
+        f"// {macs} MACs, {arena} B arena. {note}",
+        "// Input: " + ("[ax, ay, az, gx, gy, gz] / full scale per sample, nn_quantize_q7()"
+                        if window else "quantize_features_u8() - 128: " + ", ".join(FEATURES_U8)),
+        f"#define GESTURE_NN_INPUT       {'NN_INPUT_WINDOW' if window else 'NN_INPUT_FEATURES'}",
+        f"#define GESTURE_NN_IN_LEN      {net['in_len']}",
+        f"#define GESTURE_NN_IN_CH       {net['in_ch']}",
+        f"#define GESTURE_NN_ARENA_BYTES {arena}",
+        "",
+    ]
+    for i, L in enumerate(layers):
+        out += c_array("int8_t", f"kGestureNnW{i}", [v for w in L["w_q"] for v in w])
+        out += c_array("int32_t", f"kGestureNnB{i}", L["bias_q"], 8)
+    out.append("static const nn_layer_t kGestureNnLayers[] = {")
+    for i, L in enumerate(layers):
+        in_len, ch, k, s, out_len = L["shape"]
+        op = "NN_CONV1D" if L["op"] == "conv1d" else "NN_DENSE"
+        out.append(f"    {{ kGestureNnW{i}, kGestureNnB{i}, {L['mult']}, {L['shift']}, {L['zp']}, "
+                   f"{int(bool(L.get('relu')))}, {op}, {in_len}, {ch}, {k}, {s}, {out_len}, {L['out_ch']} }},"
+                   f"   // out scale {L['scale']:.6g}")
+    out += [
+        "};",
+        "static const nn_model_t kGestureNn = {",
+        f"    kGestureNnLayers, {len(layers)}, {n_in}, {sizes[-1]}, GESTURE_NN_ARENA_BYTES,",
+        f"    {in_scale:.9g}f, {in_zp}, {layers[-1]['scale']:.9g}f, {layers[-1]['zp']},",
+        "};",
+        "",
+        "// Inputs and outputs of the integer reference in export_nn.py.",
+        f"#define GESTURE_NN_N_TESTS {len(tests)}",
+        f"static const int8_t kGestureNnTestIn[GESTURE_NN_N_TESTS][{n_in}] = {{",
+    ]
+    out += ["    { " + ", ".join(str(v) for v in q) + " }," for q, _ in tests]
+    out += ["};", f"static const int8_t kGestureNnTestOut[GESTURE_NN_N_TESTS][{sizes[-1]}] = {{"]
+    out += ["    { " + ", ".join(str(v) for v in r) + " }," for _, r in tests]
+    out += ["};", ""]
+
+    text = "\n".join(out)
+    if path == "-":
+        sys.stdout.write(text)
+    else:
+        Path(path).write_text(text)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--rules", action="store_true", help="fit the MLP to classify_rules()")
+    src.add_argument("--train", nargs="+", metavar="CSV", help="fit the MLP on labelled session CSVs")
+    src.add_argument("--model", metavar="JSON", help="quantize a float network trained elsewhere")
+    ap.add_argument("--hidden", type=int, nargs="+", default=[16, 16], help="MLP hidden layer sizes")
+    ap.add_argument("--epochs", type=int, default=80)
+    ap.add_argument("--samples", type=int, default=4000, help="--rules: synthetic windows")
+    ap.add_argument("-o", "--output", default="-")
+    args = ap.parse_args()
+
+    if args.model:
+        net = json.loads(Path(args.model).read_text())
+        calibration = net.get("calibration") or sys.exit("--model: no calibration inputs")
+        X, y = calibration, None
+        source = Path(args.model).name
+    else:
+        X, y = rules_data(args.samples) if args.rules else csv_data(args.train)
+        if not X:
+            sys.exit("no labelled feature rows")
+        net = train_mlp(X, y, args.hidden, args.epochs)
+        source = ("classify_rules() on synthetic windows (--rules)" if args.rules
+                  else f"{len(args.train)} session logs (--train)")
+
+    window = net["input"] == "window"
+    if window:
+        qin = [[quantize_q7(v) for v in x] for x in X]
+        layers = quantize(net, X, 1.0 / 128.0, 0)
+    else:
+        qin = [[round(v * 255.0) - 128 for v in x] for x in X]
+        layers = quantize(net, X, 1.0 / 255.0, -128)
+
+    note = f"{len(X)} calibration inputs."
+    if y is not None:
+        # --rules scores on windows it was not fitted to, --train on its own data
+        Xe, ye = rules_data(args.samples, seed=2) if args.rules else (X, y)
+        f_ok = sum(argmax(forward(net, x)[-1]) == c for x, c in zip(Xe, ye))
+        q_ok = sum(argmax(run_int8(layers, [round(v * 255.0) - 128 for v in x])) == c for x, c in zip(Xe, ye))
+        what = "held-out" if args.rules else "training"
+        note = f"Accuracy on {len(Xe)} {what} windows: float {f_ok / len(Xe):.3f}, int8 {q_ok / len(Xe):.3f}."
+    print(note, file=sys.stderr)
+
+    tests = [(q, run_int8(layers, q)) for q in qin[:N_TESTS]]
+    export_header(net, layers, tests, args.output, source, note)
+
+
+if __name__ == "__main__":
+    main()
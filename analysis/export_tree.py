@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""Export a decision tree or forest as the flat node table of src/dtree.h.
+
+    python3 analysis/export_tree.py --rules -o project/src/gesture_model.h
+    python3 analysis/export_tree.py --train ../logs/*.csv --trees 8 --depth 6 \
+        -o project/src/gesture_model.h
+
+--rules rebuilds the hand-written cascade of classify_rules() as a tree; that
+is the table the firmware ships with, so classify() is unchanged until a
+trained model replaces it. --train fits scikit-learn on session CSVs (firmware
+CSV, or imu_log2csv output of a .bin) labelled by file name, the same way the
+notebook builds its confusion matrix, skipping idle windows that MOTION_GATE
+logged with NaN features. From the notebook, export_header() takes
+any fitted DecisionTreeClassifier or RandomForestClassifier.
+
+Only the standard library is needed for --rules.
+"""
+import argparse
+import csv
+import math
+import struct
+import sys
+from pathlib import Path
+
+# Same order as classifier_features() in project/src/classifier.c.
+FEATURES = ["amag_std", "dom_freq", "bp1", "bp2", "gx_std", "gy_std", "gz_std", "gyro_std_mean"]
+CLASSES = ["NONE", "SHAKE", "TILT", "CIRCLE"]   # G_* in classifier.h
+
+# classify_rules(), first match wins, NONE otherwise.
+RULES = [
+    ("SHAKE", [("amag_std", ">", 0.05), ("dom_freq", ">=", 3.0)]),
+    ("TILT", [("dom_freq", ">", 0.2), ("dom_freq", "<", 2.0), ("amag_std", ">", 0.01), ("amag_std", "<", 0.3)]),
+    ("CIRCLE", [("gyro_std_mean", ">", 10.0), ("dom_freq", ">=", 1.0), ("dom_freq", "<=", 3.0)]),
+]
+
+
+# ---- float32 helpers ----------------------------------------------------------
+def f32(x):
+    return struct.unpack("<f", struct.pack("<f", x))[0]
+
+
+def f32_bits(x):
+    return struct.unpack("<i", struct.pack("<f", x))[0]
+
+
+def f32_prev(x):
+    """Largest float32 below the float32 x."""
+    b = f32_bits(x)
+    if x > 0:
+        b -= 1
+    elif x == 0:
+        b = -0x7FFFFFFF   # 0x80000001: smallest negative subnormal
+    else:
+        b += 1
+    return struct.unpack("<f", struct.pack("<i", b))[0]
+
+
+def f32_floor(x):
+    """Largest float32 <= x, so that `v <= x` and `v <= f32_floor(x)` agree for float32 v."""
+    t = f32(x)
+    return f32_prev(t) if t > x else t
+
+
+def dt_key(x):
+    """dt_key() of dtree.h."""
+    b = f32_bits(x)
+    return -(b & 0x7FFFFFFF) if b < 0 else b
+
+
+# ---- Trees ----------------------------------------------------------------------
+# A tree is a list of nodes: ("split", feature, threshold, left, right) with
+# left taken for x <= threshold, or ("leaf", class).
+def rules_tree():
+    nodes = []
+
+    def add(node):
+        nodes.append(node)
+        return len(nodes) - 1
+
+    def build(rule, clause):
+        if rule == len(RULES):
+            return add(("leaf", CLASSES.index("NONE")))
+        name, clauses = RULES[rule]
+        if clause == len(clauses):
+            return add(("leaf", CLASSES.index(name)))
+        feature, op, value = clauses[clause]
+        v = f32(value)
+        # every comparison as `x > thr`, true on the right or on the left
+        thr, true_right = {">": (v, True), ">=": (f32_prev(v), True),
+                           "<": (f32_prev(v), False), "<=": (v, False)}[op]
+        idx = add(None)
+        hit, miss = build(rule, clause + 1), build(rule + 1, 0)
+        nodes[idx] = ("split", FEATURES.index(feature), thr, miss if true_right else hit,
+                      hit if true_right else miss)
+        return idx
+
+    build(0, 0)
+    return nodes
+
+
+def sklearn_trees(model):
+    """Trees of a fitted DecisionTreeClassifier or RandomForestClassifier.
+
+    Forests are voted by majority on the device, where scikit-learn averages
+    probabilities; the two can differ on near ties.
+    """
+    labels = [str(c).upper() for c in model.classes_]
+    trees = []
+    for est in getattr(model, "estimators_", [model]):
+        t = est.tree_
+        nodes = []
+        for i in range(t.node_count):
+            if t.children_left[i] < 0:
+                best = max(range(len(labels)), key=lambda k: t.value[i][0][k])
+                nodes.append(("leaf", CLASSES.index(labels[best])))
+            else:
+                nodes.append(("split", int(t.feature[i]), f32_floor(float(t.threshold[i])),
+                              int(t.children_left[i]), int(t.children_right[i])))
+        trees.append(nodes)
+    return trees
+
+
+def merge_subtrees(nodes):
+    """Shares identical subtrees and drops splits whose two sides agree.
+
+    The cascade repeats the later rules under every branch of the earlier ones,
+    and trained trees often split into two equal leaves. Nodes are numbered
+    root first again, as export_header() expects; children may now be shared.
+    """
+    merged, seen = [], {}
+
+    def visit(i):
+        n = nodes[i]
+        if n[0] == "split":
+            left, right = visit(n[3]), visit(n[4])
+            if left == right:
+                return left
+            n = ("split", n[1], n[2], left, right)
+        if n not in seen:
+            seen[n] = len(merged)
+            merged.append(n)
+        return seen[n]
+
+    visit(0)
+    # children come before their parents, so reversing puts the root at 0
+    last = len(merged) - 1
+    return [n if n[0] == "leaf" else ("split", n[1], n[2], last - n[3], last - n[4])
+            for n in reversed(merged)]
+
+
+def depth_of(nodes, i=0):
+    n = nodes[i]
+    return 0 if n[0] == "leaf" else 1 + max(depth_of(nodes, n[3]), depth_of(nodes, n[4]))
+
+
+def export_header(trees, path, source):
+    """Writes the gesture_model.h table for a list of trees, or for a fitted
+    scikit-learn classifier."""
+    if not isinstance(trees, list):
+        trees = sklearn_trees(trees)
+    trees = [merge_subtrees(t) for t in trees]
+    rows, roots = [], []
+    for nodes in trees:
+        base = len(rows)
+        roots.append(base)
+        for i, n in enumerate(nodes):
+            if n[0] == "leaf":
+                rows.append((0, 0, n[1], base + i, base + i, f"-> {CLASSES[n[1]]}"))
+            else:
+                _, f, thr, left, right = n
+                rows.append((dt_key(thr), f, 0, base + left, base + right, f"{FEATURES[f]} > {thr:.9g}"))
+    depth = max(depth_of(t) for t in trees)
+    if len(rows) > 0xFFFF or len(trees) > 255 or depth > 255:
+        sys.exit("model too large for dt_node_t / dt_model_t")
+
+    out = [
+        f"// GENERATED by analysis/export_tree.py from {source}; do not edit.",
+        "#pragma once",
+        '#include "dtree.h"',
+        "",
+        f"// {len(trees)} tree(s), depth {depth}, {len(rows)} nodes. Features, in",
+        "// classifier_features() order: " + ", ".join(FEATURES),
+        f"#define GESTURE_MODEL_N_FEATURES {len(FEATURES)}",
+        "",
+        "static const dt_node_t kGestureModelNodes[] = {",
+    ]
+    for i, (key, f, cls, left, right, note) in enumerate(rows):
+        out.append(f"    {{ {key:11d}, {f}, {cls}, {{ {left:4d}, {right:4d} }} }},   // {i:4d}: {note}")
+    out += [
+        "};",
+        "static const uint16_t kGestureModelRoots[] = { " + ", ".join(str(r) for r in roots) + " };",
+        "static const dt_model_t kGestureModel = {",
+        f"    kGestureModelNodes, kGestureModelRoots, {len(trees)}, {depth}, {len(FEATURES)}, {len(CLASSES)},",
+        "};",
+        "",
+    ]
+    text = "\n".join(out)
+    if path == "-":
+        sys.stdout.write(text)
+    else:
+        Path(path).write_text(text)
+
+
+# ---- Training -------------------------------------------------------------------
+def label_from_filename(path):
+    name = Path(path).stem.lower()
+    for c in ("shake", "tilt", "circle", "none"):
+        if c in name:
+            return c.upper()
+    return None
+
+
+def load_features(paths):
+    X, y = [], []
+    for p in paths:
+        label = label_from_filename(p)
+        if label is None:
+            print(f"{p}: no class in the file name, skipped", file=sys.stderr)
+            continue
+        with open(p, newline="") as fh:
+            for row in csv.DictReader(fh):
+                try:
+                    v = {k: f32(float(row[k])) for k in FEATURES[:-1]}
+                except (KeyError, TypeError, ValueError):
+                    continue
+                if any(math.isnan(x) for x in v.values()):
+                    continue   # idle window behind MOTION_GATE: stages skipped
+                # as classifier_features() computes it, in float32
+                v["gyro_std_mean"] = f32(f32(f32(v["gx_std"] + v["gy_std"]) + v["gz_std"]) / 3.0)
+                X.append([v[k] for k in FEATURES])
+                y.append(label)
+    return X, y
+
+
+def train(paths, n_trees, depth):
+    from sklearn.ensemble import RandomForestClassifier
+    from sklearn.tree import DecisionTreeClassifier
+
+    X, y = load_features(paths)
+    if not X:
+        sys.exit("no labelled feature rows")
+    if n_trees > 1:
+        model = RandomForestClassifier(n_estimators=n_trees, max_depth=depth, random_state=0)
+    else:
+        model = DecisionTreeClassifier(max_depth=depth, random_state=0)
+    model.fit(X, y)
+    print(f"{len(X)} windows, training accuracy {model.score(X, y):.3f}", file=sys.stderr)
+    return model
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--rules", action="store_true", help="the hand-written rules as a tree")
+    src.add_argument("--train", nargs="+", metavar="CSV", help="fit on labelled session CSVs")
+    ap.add_argument("--trees", type=int, default=1, help="forest size (1 = single tree)")
+    ap.add_argument("--depth", type=int, default=6)
+    ap.add_argument("-o", "--output", default="-")
+    args = ap.parse_args()
+
+    if args.rules:
+        export_header([rules_tree()], args.output, "the classify_rules() cascade (--rules)")
+    else:
+        model = train(args.train, args.trees, args.depth)
+        export_header(model, args.output,
+                      f"{len(args.train)} session logs (--trees {args.trees} --depth {args.depth})")
+
+
+if __name__ == "__main__":
+    main()
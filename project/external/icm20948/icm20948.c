@@ -1,5 +1,6 @@
 #include "icm20948.h"
 #include <string.h>
+#include "filters.h"
 
 #define I2C_PORT i2c1
 IMU_ST_SENSOR_DATA gstGyroOffset ={0,0,0};  
@@ -38,6 +39,13 @@ void I2C_WriteOneByte( char reg, char value)
 	i2c_write_blocking(I2C_PORT,I2C_ADD_ICM20948,buf,2,false);
 }
 
+// ---- Fast burst read over I2C (one transaction) ----
+static inline void icm20948ReadBurst(uint8_t start_reg, uint8_t *buf, size_t n) {
+    i2c_write_blocking(I2C_PORT, I2C_ADD_ICM20948, &start_reg, 1, true); // repeated START
+    i2c_read_blocking(I2C_PORT,  I2C_ADD_ICM20948, buf, n, false);       // STOP
+}
+
+
 /******************************************************************************
  * IMU module                                                                 *
  ******************************************************************************/
@@ -77,21 +85,14 @@ void imuDataAccGyrGet(IMU_ST_SENSOR_DATA *pstGyroRawData,
                     IMU_ST_SENSOR_DATA *pstAccelRawData)
 {
 
-  int16_t s16Gyro[3], s16Accel[3], s16Magn[3];
-
-  icm20948AccelFastRead(&s16Accel[0], &s16Accel[1], &s16Accel[2]);
-  icm20948GyroFastRead(&s16Gyro[0], &s16Gyro[1], &s16Gyro[2]);
+  IMU_ST_SENSOR_DATA stGyro, stAccel;
 
-  // icm20948AccelRead(&s16Accel[0], &s16Accel[1], &s16Accel[2]);
-  // icm20948GyroRead(&s16Gyro[0], &s16Gyro[1], &s16Gyro[2]);
-
-  pstGyroRawData->s16X = s16Gyro[0];
-  pstGyroRawData->s16Y = s16Gyro[1];
-  pstGyroRawData->s16Z = s16Gyro[2];
+  // one 12-byte burst: accel and gyro come from the same register snapshot.
+  // Raw like the FIFO and DMA paths; the firmware smooths all of them in one place.
+  icm20948AccelGyroBurstRead(&stAccel, &stGyro, NULL, NULL, 0);
 
-  pstAccelRawData->s16X = s16Accel[0];
-  pstAccelRawData->s16Y = s16Accel[1];
-  pstAccelRawData->s16Z  = s16Accel[2];
+  *pstAccelRawData = stAccel;
+  *pstGyroRawData = stGyro;
 
   return;
 }
@@ -261,6 +262,54 @@ void icm20948init(void)
   return;
 }
 
+static void icm20948WriteSampleDividers(uint32_t u32GyroDiv, uint32_t u32AccelDiv)
+{
+  I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_2);
+  I2C_WriteOneByte( REG_ADD_ODR_ALIGN_EN, REG_VAL_BIT_ODR_ALIGN_EN);
+  I2C_WriteOneByte( REG_ADD_GYRO_SMPLRT_DIV, (char)u32GyroDiv);
+  I2C_WriteOneByte( REG_ADD_ACCEL_SMPLRT_DIV_1, (char)(u32AccelDiv >> 8));
+  I2C_WriteOneByte( REG_ADD_ACCEL_SMPLRT_DIV_2, (char)(u32AccelDiv & 0xFF));
+  I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_0);
+}
+
+/* Output data rate of both sensors, as close to u16Hz as the dividers allow:
+ * gyro ODR = 1.1 kHz / (1 + div), accel ODR = 1.125 kHz / (1 + div).
+ * The two bases differ, so the rates only match at 25/j Hz (1 + gyro div =
+ * 44j, 1 + accel div = 45j). Anywhere else the accel gets the divider whose
+ * rate is nearest the gyro's, e.g. at 100 Hz gyro runs at 100 Hz and accel
+ * at 102.27 Hz. ODR_ALIGN_EN lines up their start times; it cannot make the
+ * rates equal. Returns the gyro sample period in ns and, if
+ * pu32AccelPeriodNs is not NULL, stores the accel one there. */
+uint32_t icm20948SetSampleRate(uint16_t u16Hz, uint32_t *pu32AccelPeriodNs)
+{
+  uint32_t u32GyroDiv, u32AccelDiv;
+
+  if (u16Hz == 0) u16Hz = 1;
+  u32GyroDiv = (1100u + u16Hz / 2) / u16Hz;
+  u32GyroDiv = (u32GyroDiv > 0) ? u32GyroDiv - 1 : 0;
+  if (u32GyroDiv > 0xFF) u32GyroDiv = 0xFF;
+  /* nearest to the achieved gyro rate: 1 + div = round(1125 * (1 + gyro div) / 1100) */
+  u32AccelDiv = (1125u * (1u + u32GyroDiv) + 550u) / 1100u - 1u;
+  if (u32AccelDiv > 0xFFF) u32AccelDiv = 0xFFF;
+
+  icm20948WriteSampleDividers(u32GyroDiv, u32AccelDiv);
+
+  if (pu32AccelPeriodNs)
+    *pu32AccelPeriodNs = (uint32_t)((1000000000ull * (1u + u32AccelDiv) + 562u) / 1125u);
+  return (uint32_t)((1000000000ull * (1u + u32GyroDiv) + 550u) / 1100u);
+}
+
+/* Raw-data-ready on INT1: active high, push-pull, 50 us pulse per new sample.
+ * Pulse mode (no latch) so a missed read can never leave the pin stuck high.
+ * Accel and gyro updates both pulse, and DATA_RDY_STATUS does not say which
+ * sensor it was, so one pulse per sample needs equal ODRs (25/j Hz). */
+void icm20948DataReadyIntEnable(bool bEnable)
+{
+  I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_0);
+  I2C_WriteOneByte( REG_ADD_INT_PIN_CFG, 0x00);
+  I2C_WriteOneByte( REG_ADD_INT_ENABLE_1, bEnable ? REG_VAL_BIT_RAW_DATA_0_RDY_EN : 0x00);
+}
+
 bool icm20948Check(void)
 {
     bool bRet = false;
@@ -335,40 +384,8 @@ void icm20948AccelRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
 }
 
 
-// ---- Fast burst read over I2C (one transaction) ----
-static inline void icm20948ReadBurst(uint8_t start_reg, uint8_t *buf, size_t n) {
-    i2c_write_blocking(I2C_PORT, I2C_ADD_ICM20948, &start_reg, 1, true); // repeated START
-    i2c_read_blocking(I2C_PORT,  I2C_ADD_ICM20948, buf, n, false);       // STOP
-}
-
-// ---- O(1) 8-sample moving average state ----
-typedef struct {
-    uint8_t idx;
-    int16_t buf[8];
-    int32_t sum;
-    bool    primed;
-} Avg8;
-
-static inline int16_t avg8_update(Avg8 *s, int16_t v) {
-    if (!s->primed) {
-        // Prime: fill with first value so the initial average is correct immediately
-        for (int i = 0; i < 8; ++i) s->buf[i] = v;
-        s->sum = (int32_t)v * 8;
-        s->idx = 0;
-        s->primed = true;
-        return v;
-    }
-    s->sum -= s->buf[s->idx];
-    s->buf[s->idx] = v;
-    s->sum += v;
-    s->idx = (s->idx + 1) & 7;   // modulo 8
-    return (int16_t)(s->sum >> 3);
-}
-
 void icm20948AccelFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
 {
-    static Avg8 s_acc_avg[3] = {0};
-
     uint8_t b[6];
     icm20948ReadBurst(REG_ADD_ACCEL_XOUT_H, b, 6);
 
@@ -376,7 +393,8 @@ void icm20948AccelFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
     int16_t rawY = (int16_t)((b[2] << 8) | b[3]);
     int16_t rawZ = (int16_t)((b[4] << 8) | b[5]);
 
-    // O(1) smoothing
+    // O(1) smoothing (filters.h); this reader's own state, nothing else feeds it
+    static avg8_t s_acc_avg[3];
     *ps16X = avg8_update(&s_acc_avg[0], rawX);
     *ps16Y = avg8_update(&s_acc_avg[1], rawY);
     *ps16Z = avg8_update(&s_acc_avg[2], rawZ);
@@ -385,8 +403,6 @@ void icm20948AccelFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
 
 void icm20948GyroFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
 {
-    static Avg8 s_gyro_avg[3] = {0};
-
     uint8_t b[6];
     icm20948ReadBurst(REG_ADD_GYRO_XOUT_H, b, 6);
 
@@ -394,6 +410,8 @@ void icm20948GyroFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
     int16_t rawY = (int16_t)((b[2] << 8) | b[3]);
     int16_t rawZ = (int16_t)((b[4] << 8) | b[5]);
 
+    // averaged in the raw domain (this reader's own state), offset removed after
+    static avg8_t s_gyro_avg[3];
     int16_t avgX = avg8_update(&s_gyro_avg[0], rawX);
     int16_t avgY = avg8_update(&s_gyro_avg[1], rawY);
     int16_t avgZ = avg8_update(&s_gyro_avg[2], rawZ);
@@ -405,6 +423,165 @@ void icm20948GyroFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
     return;
 }
 
+// ---- Combined accel + gyro (+ temp, + EXT_SENS_DATA) burst ----
+// 12 big-endian bytes in register order.
+static inline void icm20948DecodeAccelGyro(const uint8_t *b, IMU_ST_SENSOR_DATA *pstAccel,
+                                           IMU_ST_SENSOR_DATA *pstGyro)
+{
+    pstAccel->s16X = (int16_t)((b[0] << 8) | b[1]);
+    pstAccel->s16Y = (int16_t)((b[2] << 8) | b[3]);
+    pstAccel->s16Z = (int16_t)((b[4] << 8) | b[5]);
+    pstGyro->s16X  = (int16_t)((int32_t)(int16_t)((b[6]  << 8) | b[7])  - gstGyroOffset.s16X);
+    pstGyro->s16Y  = (int16_t)((int32_t)(int16_t)((b[8]  << 8) | b[9])  - gstGyroOffset.s16Y);
+    pstGyro->s16Z  = (int16_t)((int32_t)(int16_t)((b[10] << 8) | b[11]) - gstGyroOffset.s16Z);
+}
+
+// ACCEL_XOUT_H..GYRO_ZOUT_L, TEMP_OUT and EXT_SENS_DATA are contiguous in
+// bank 0, so one write-then-read covers any prefix of them. Values are raw
+// (no Avg8); gyro has the boot-time offset removed like the FastRead path.
+// ps16Temp / pu8Ext may be NULL; asking for EXT data also reads TEMP_OUT.
+void icm20948AccelGyroBurstRead(IMU_ST_SENSOR_DATA *pstAccel, IMU_ST_SENSOR_DATA *pstGyro,
+                                int16_t *ps16Temp, uint8_t *pu8Ext, uint8_t u8ExtLen)
+{
+    uint8_t b[ICM20948_BURST_AG_BYTES + 2 + ICM20948_EXT_SENS_MAX];
+    size_t n = ICM20948_BURST_AG_BYTES;
+
+    if (!pu8Ext) u8ExtLen = 0;
+    if (u8ExtLen > ICM20948_EXT_SENS_MAX) u8ExtLen = ICM20948_EXT_SENS_MAX;
+    if (ps16Temp || u8ExtLen) n += 2;
+    n += u8ExtLen;
+
+    icm20948ReadBurst(REG_ADD_ACCEL_XOUT_H, b, n);
+
+    icm20948DecodeAccelGyro(b, pstAccel, pstGyro);
+
+    if (ps16Temp) *ps16Temp = (int16_t)((b[12] << 8) | b[13]);
+    if (u8ExtLen) memcpy(pu8Ext, &b[14], u8ExtLen);
+}
+
+// Let the internal I2C master poll the AK09916 at the gyro ODR and mirror
+// ST1..ST2 into EXT_SENS_DATA_00..08, so the magnetometer rides along in
+// icm20948AccelGyroBurstRead(..., ICM20948_MAG_EXT_LEN) with no extra
+// transaction. Do not mix with icm20948MagRead(), which reuses SLV0.
+void icm20948MagContinuousEnable(void)
+{
+    uint8_t u8Temp;
+
+    I2C_WriteOneByte( REG_ADD_REG_BANK_SEL,  REG_VAL_REG_BANK_3);
+    I2C_WriteOneByte( REG_ADD_I2C_SLV0_ADDR, I2C_ADD_ICM20948_AK09916|I2C_ADD_ICM20948_AK09916_READ);
+    I2C_WriteOneByte( REG_ADD_I2C_SLV0_REG,  REG_ADD_MAG_ST2);    // ST1 (0x10)
+    I2C_WriteOneByte( REG_ADD_I2C_SLV0_CTRL, REG_VAL_BIT_SLV0_EN|ICM20948_MAG_EXT_LEN);
+
+    I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_0);
+    u8Temp = I2C_ReadOneByte(REG_ADD_USER_CTRL);
+    I2C_WriteOneByte( REG_ADD_USER_CTRL, u8Temp | REG_VAL_BIT_I2C_MST_EN);
+}
+
+// Decode the EXT_SENS_DATA block. Axes follow icm20948MagRead() (Y/Z flipped
+// into the accel frame). Returns false if no new sample or on overflow.
+bool icm20948MagParseExt(const uint8_t *pu8Ext, IMU_ST_SENSOR_DATA *pstMag)
+{
+    if ((pu8Ext[0] & 0x01) == 0) return false;    // ST1.DRDY
+    if (pu8Ext[8] & 0x08) return false;           // ST2.HOFL
+
+    pstMag->s16X =  (int16_t)((pu8Ext[2] << 8) | pu8Ext[1]);
+    pstMag->s16Y = (int16_t)-(int16_t)((pu8Ext[4] << 8) | pu8Ext[3]);
+    pstMag->s16Z = (int16_t)-(int16_t)((pu8Ext[6] << 8) | pu8Ext[5]);
+    return true;
+}
+
+// ---- Hardware FIFO (gyro, accel per drain) ----
+// The sensor queues a 6-byte gyro frame per sample at the gyro ODR; the host
+// drains many frames per I2C transaction instead of polling every sample.
+// Frames are raw (no Avg8 smoothing), gyro still has the boot-time offset
+// removed so biases match icm20948GyroFastRead().
+
+static inline void icm20948FifoReset(void)
+{
+    I2C_WriteOneByte( REG_ADD_FIFO_RST, 0x1F);
+    I2C_WriteOneByte( REG_ADD_FIFO_RST, 0x00);
+}
+
+// Enable a gyro-only FIFO at the gyro ODR nearest u16Hz (up to 1.1 kHz); the
+// accel runs at its nearest ODR and is read per drain. Each sensor writes its
+// own bytes at its own ODR, so with both in the FIFO the frames would only
+// stay aligned at equal ODRs (25/k Hz). Returns the frame period in ns.
+uint32_t icm20948FifoEnable(uint16_t u16Hz)
+{
+    uint8_t u8Temp;
+    const uint32_t u32PeriodNs = icm20948SetSampleRate(u16Hz, NULL);
+
+    I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_0);
+    I2C_WriteOneByte( REG_ADD_FIFO_EN_2, 0x00);
+    I2C_WriteOneByte( REG_ADD_FIFO_MODE, 0x00);        // stream: oldest overwritten
+    icm20948FifoReset();
+
+    u8Temp = I2C_ReadOneByte(REG_ADD_USER_CTRL);
+    I2C_WriteOneByte( REG_ADD_USER_CTRL, u8Temp | REG_VAL_BIT_FIFO_EN);
+    I2C_WriteOneByte( REG_ADD_FIFO_EN_2, REG_VAL_BIT_GYRO_X_FIFO_EN | REG_VAL_BIT_GYRO_Y_FIFO_EN |
+                                         REG_VAL_BIT_GYRO_Z_FIFO_EN);
+    return u32PeriodNs;
+}
+
+void icm20948FifoDisable(void)
+{
+    uint8_t u8Temp;
+
+    I2C_WriteOneByte( REG_ADD_REG_BANK_SEL, REG_VAL_REG_BANK_0);
+    I2C_WriteOneByte( REG_ADD_FIFO_EN_2, 0x00);
+    u8Temp = I2C_ReadOneByte(REG_ADD_USER_CTRL);
+    I2C_WriteOneByte( REG_ADD_USER_CTRL, u8Temp & ~REG_VAL_BIT_FIFO_EN);
+    icm20948FifoReset();
+}
+
+// Bytes currently queued (COUNTH must be read first; one burst does both).
+uint16_t icm20948FifoCount(void)
+{
+    uint8_t b[2];
+    icm20948ReadBurst(REG_ADD_FIFO_COUNTH, b, 2);
+    return (uint16_t)(((b[0] & 0x1F) << 8) | b[1]);
+}
+
+// Drain up to s32MaxFrames whole gyro frames in one burst and read the
+// current accel registers into *pstAccel: three transactions per drain. A
+// FIFO within a frame of full is taken as overflowed (stream mode overwrites
+// the oldest bytes and the frames lose alignment): it is reset and -1
+// returned, and the caller should re-anchor its timestamps. Otherwise
+// returns the number of frames read.
+int icm20948FifoRead(IMU_ST_SENSOR_DATA *pstGyro, int s32MaxFrames, IMU_ST_SENSOR_DATA *pstAccel)
+{
+    static uint8_t s_u8Buf[ICM20948_FIFO_SIZE];
+    uint8_t u8Accel[6];
+    const uint16_t u16Count = icm20948FifoCount();
+    int s32Frames, i;
+
+    if (u16Count > ICM20948_FIFO_SIZE - ICM20948_FIFO_FRAME_BYTES)
+    {
+        icm20948FifoReset();
+        return -1;
+    }
+
+    icm20948ReadBurst(REG_ADD_ACCEL_XOUT_H, u8Accel, sizeof u8Accel);
+    pstAccel->s16X = (int16_t)((u8Accel[0] << 8) | u8Accel[1]);
+    pstAccel->s16Y = (int16_t)((u8Accel[2] << 8) | u8Accel[3]);
+    pstAccel->s16Z = (int16_t)((u8Accel[4] << 8) | u8Accel[5]);
+
+    s32Frames = u16Count / ICM20948_FIFO_FRAME_BYTES;
+    if (s32Frames > s32MaxFrames) s32Frames = s32MaxFrames;
+    if (s32Frames <= 0) return 0;
+
+    icm20948ReadBurst(REG_ADD_FIFO_R_W, s_u8Buf, (size_t)s32Frames * ICM20948_FIFO_FRAME_BYTES);
+
+    for (i = 0; i < s32Frames; i++)
+    {
+        const uint8_t *b = &s_u8Buf[i * ICM20948_FIFO_FRAME_BYTES];
+        pstGyro[i].s16X = (int16_t)((int32_t)(int16_t)((b[0] << 8) | b[1]) - gstGyroOffset.s16X);
+        pstGyro[i].s16Y = (int16_t)((int32_t)(int16_t)((b[2] << 8) | b[3]) - gstGyroOffset.s16Y);
+        pstGyro[i].s16Z = (int16_t)((int32_t)(int16_t)((b[4] << 8) | b[5]) - gstGyroOffset.s16Z);
+    }
+    return s32Frames;
+}
+
 void icm20948MagRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z)
 {
     uint8_t counter = 20;
@@ -30,6 +30,25 @@
 #define REG_ADD_LP_CONFIG 0x05
 #define REG_ADD_PWR_MGMT_1 0x06
 #define REG_ADD_PWR_MGMT_2 0x07
+#define REG_ADD_INT_PIN_CFG 0x0F
+#define REG_VAL_BIT_INT1_ACTL 0x80       /* 1: active low */
+#define REG_VAL_BIT_INT1_OPEN 0x40       /* 1: open drain */
+#define REG_VAL_BIT_INT1_LATCH_EN 0x20   /* 0: 50 us pulse */
+#define REG_VAL_BIT_INT_ANYRD_2CLEAR 0x10
+#define REG_ADD_INT_ENABLE_1 0x11
+#define REG_VAL_BIT_RAW_DATA_0_RDY_EN 0x01
+#define REG_ADD_INT_STATUS_1 0x1A
+#define REG_ADD_INT_STATUS_2 0x1B
+#define REG_VAL_BIT_FIFO_OVERFLOW_INT 0x1F   /* bit[4:0] */
+#define REG_ADD_FIFO_EN_2 0x67
+#define REG_VAL_BIT_ACCEL_FIFO_EN 0x10
+#define REG_VAL_BIT_GYRO_Z_FIFO_EN 0x08
+#define REG_VAL_BIT_GYRO_Y_FIFO_EN 0x04
+#define REG_VAL_BIT_GYRO_X_FIFO_EN 0x02
+#define REG_ADD_FIFO_RST 0x68
+#define REG_ADD_FIFO_MODE 0x69
+#define REG_ADD_FIFO_COUNTH 0x70
+#define REG_ADD_FIFO_R_W 0x72
 #define REG_ADD_ACCEL_XOUT_H 0x2D
 #define REG_ADD_ACCEL_XOUT_L 0x2E
 #define REG_ADD_ACCEL_YOUT_H 0x2F
@@ -42,6 +61,8 @@
 #define REG_ADD_GYRO_YOUT_L 0x36
 #define REG_ADD_GYRO_ZOUT_H 0x37
 #define REG_ADD_GYRO_ZOUT_L 0x38
+#define REG_ADD_TEMP_OUT_H 0x39
+#define REG_ADD_TEMP_OUT_L 0x3A
 #define REG_ADD_EXT_SENS_DATA_00 0x3B
 #define REG_ADD_REG_BANK_SEL 0x7F
 #define REG_VAL_REG_BANK_0 0x00
@@ -61,7 +82,10 @@
 #define REG_VAL_BIT_GYRO_FS_1000DPS 0x04 /* bit[2:1] */
 #define REG_VAL_BIT_GYRO_FS_2000DPS 0x06 /* bit[2:1] */
 #define REG_VAL_BIT_GYRO_DLPF 0x01       /* bit[0]   */
-#define REG_ADD_ACCEL_SMPLRT_DIV_2 0x11
+#define REG_ADD_ODR_ALIGN_EN 0x09
+#define REG_VAL_BIT_ODR_ALIGN_EN 0x01    /* align ODR start times on the next SMPLRT_DIV write */
+#define REG_ADD_ACCEL_SMPLRT_DIV_1 0x10 /* bits [11:8] */
+#define REG_ADD_ACCEL_SMPLRT_DIV_2 0x11 /* bits [7:0]  */
 #define REG_ADD_ACCEL_CONFIG 0x14
 #define REG_VAL_BIT_ACCEL_DLPCFG_2 0x10 /* bit[5:3] */
 #define REG_VAL_BIT_ACCEL_DLPCFG_4 0x20 /* bit[5:3] */
@@ -105,6 +129,20 @@
 
 #define MAG_DATA_LEN    6
 
+/* Combined burst: ACCEL_XOUT_H..GYRO_ZOUT_L, then TEMP_OUT, then EXT_SENS_DATA */
+#define ICM20948_BURST_AG_BYTES   12
+#define ICM20948_EXT_SENS_MAX     24
+/* AK09916 block mirrored into EXT_SENS_DATA by icm20948MagContinuousEnable():
+ * ST1, HXL..HZH, TMPS, ST2 */
+#define ICM20948_MAG_EXT_LEN      9
+/* Die temperature in degC from TEMP_OUT (datasheet: 333.87 LSB/degC, 21 degC offset) */
+#define ICM20948_TEMP_C(raw)      ((float)(raw) / 333.87f + 21.0f)
+
+/* FIFO: gyro only, one frame = gyro XYZ, big endian, at the gyro ODR. The
+ * accel is read from its registers once per drain instead. */
+#define ICM20948_FIFO_SIZE        512
+#define ICM20948_FIFO_FRAME_BYTES 6
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -136,6 +174,9 @@ extern "C" {
 		int16_t s16AvgBuffer[8];
 	}ICM20948_ST_AVG_DATA;
 
+	/* Gyro zero-rate offset from imuInit(); exported for async (DMA) readers */
+	extern IMU_ST_SENSOR_DATA gstGyroOffset;
+
 	void imuInit(IMU_EN_SENSOR_TYPE *penMotionSensorType);
 	void imuDataAccGyrGet(IMU_ST_SENSOR_DATA *pstGyroRawData,
 						IMU_ST_SENSOR_DATA *pstAccelRawData); 
@@ -147,6 +188,16 @@ extern "C" {
 	void icm20948AccelRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z);
 	void icm20948GyroFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z);
 	void icm20948AccelFastRead(int16_t* ps16X, int16_t* ps16Y, int16_t* ps16Z);
+	uint32_t icm20948SetSampleRate(uint16_t u16Hz, uint32_t *pu32AccelPeriodNs);
+	void icm20948DataReadyIntEnable(bool bEnable);
+	void icm20948AccelGyroBurstRead(IMU_ST_SENSOR_DATA *pstAccel, IMU_ST_SENSOR_DATA *pstGyro,
+	                                int16_t *ps16Temp, uint8_t *pu8Ext, uint8_t u8ExtLen);
+	void icm20948MagContinuousEnable(void);
+	bool icm20948MagParseExt(const uint8_t *pu8Ext, IMU_ST_SENSOR_DATA *pstMag);
+	uint32_t icm20948FifoEnable(uint16_t u16Hz);
+	void icm20948FifoDisable(void);
+	uint16_t icm20948FifoCount(void);
+	int icm20948FifoRead(IMU_ST_SENSOR_DATA *pstGyro, int s32MaxFrames, IMU_ST_SENSOR_DATA *pstAccel);
 	char I2C_ReadOneByte(char reg);
 	void I2C_WriteOneByte(char reg, char val);
 
@@ -0,0 +1,162 @@
+// project/host/imu_async_sim.c
+//
+// Runs the icm_async state machine (src/icm_async.c) against the mock bus in
+// host/mock_i2c.c on a virtual clock, the same way main.c wires it to the
+// RP2040 DMA transport: the trigger starts a read, the completion callback
+// takes the sample. Every decoded sample is checked against the register
+// contents written for its trigger, and the loss counters against what the
+// scenario should produce. Exits non-zero on any mismatch.
+//
+//   ./build-host/imu_async_sim [--bus HZ] [-v]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "icm_async.h"
+#include "mock_i2c.h"
+
+typedef struct {
+    const char *name;
+    uint32_t rate_hz;
+    uint32_t n_triggers;
+    uint32_t nack_every;
+    uint32_t hang_every;
+} scenario_t;
+
+typedef struct {
+    icm_async_t async;
+    mock_i2c_t bus;
+    uint64_t period_us;
+    uint32_t taken;
+    uint32_t bad;
+} sim_t;
+
+static const int16_t kGyroOffset[3] = { 12, -7, 3 };
+static bool g_verbose = false;
+
+// -------------------- Register pattern ----------------------
+// Trigger k leaves a recognisable sample in ACCEL_XOUT_H..GYRO_ZOUT_L.
+static void expected_raw(uint32_t k, int16_t v[6]) {
+    v[0] = (int16_t)k;          v[1] = (int16_t)-(int32_t)k;  v[2] = (int16_t)(16384 - k);
+    v[3] = (int16_t)(k * 3u);   v[4] = (int16_t)(k ^ 0x5a5a); v[5] = (int16_t)(-1000 + (int32_t)k);
+}
+
+static void write_regs(mock_i2c_t *m, uint32_t k) {
+    int16_t v[6];
+    expected_raw(k, v);
+    uint8_t *r = &m->regs[ICM_ASYNC_REG_ACCEL_XOUT_H];
+    for (int i = 0; i < 6; i++) {
+        r[2 * i]     = (uint8_t)((uint16_t)v[i] >> 8);
+        r[2 * i + 1] = (uint8_t)v[i];
+    }
+}
+
+// -------------------- Completion ----------------------------
+// What imu_dma_done() in main.c does, plus checking the result.
+static void on_done(void *user, bool ok) {
+    sim_t *s = (sim_t *)user;
+    imu_sample_t out;
+    icm_async_on_complete(&s->async, ok);
+    if (!icm_async_take(&s->async, &out)) return;
+
+    const uint32_t k = (uint32_t)(out.t_us / s->period_us);
+    int16_t v[6];
+    expected_raw(k, v);
+    const int16_t got[6] = { out.ax, out.ay, out.az, out.gx, out.gy, out.gz };
+    for (int i = 0; i < 6; i++) {
+        const int16_t want = (int16_t)(i < 3 ? v[i] : v[i] - kGyroOffset[i - 3]);
+        if (got[i] != want || out.t_us != (uint64_t)k * s->period_us) {
+            if (g_verbose || s->bad == 0) {
+                fprintf(stderr, "  mismatch at trigger %u ch%d: got %d want %d (t=%llu)\n",
+                        (unsigned)k, i, got[i], want, (unsigned long long)out.t_us);
+            }
+            s->bad++;
+            break;
+        }
+    }
+    s->taken++;
+}
+
+// -------------------- Scenarios ------------------------------
+static bool run(const scenario_t *sc, uint32_t bus_hz) {
+    static sim_t s;
+    memset(&s, 0, sizeof s);
+    s.period_us = 1000000u / sc->rate_hz;
+
+    mock_i2c_init(&s.bus, bus_hz, on_done, &s);
+    s.bus.nack_every = sc->nack_every;
+    s.bus.hang_every = sc->hang_every;
+    const icm_async_transport_t tp = { mock_i2c_start_read, mock_i2c_abort, &s.bus };
+    icm_async_init(&s.async, &tp, kGyroOffset);
+
+    // abort a read that has not finished in twice its bus time
+    const uint32_t xfer_us = mock_i2c_xfer_us(&s.bus, ICM_ASYNC_BURST_BYTES);
+    const uint32_t timeout_us = 2u * xfer_us;
+    for (uint32_t k = 0; k < sc->n_triggers; k++) {
+        const uint64_t t = (uint64_t)k * s.period_us;
+        mock_i2c_advance(&s.bus, t);
+        write_regs(&s.bus, k);
+        icm_async_start(&s.async, t, timeout_us);
+    }
+    mock_i2c_advance(&s.bus, (uint64_t)sc->n_triggers * s.period_us + xfer_us);
+
+    // What the scenario should lose: the trigger after a hang is the one that
+    // times it out, so it still starts; a read longer than the period loses
+    // every trigger that arrives while it is in flight.
+    const icm_async_t *a = &s.async;
+    const uint32_t per_read = (uint32_t)((xfer_us + s.period_us - 1) / s.period_us);
+    bool ok = s.bad == 0 &&
+              a->started == a->completed + a->errors + a->timeouts + (icm_async_busy(a) ? 1u : 0u) &&
+              a->started + a->skipped == sc->n_triggers &&
+              s.taken == a->completed &&
+              s.bus.aborts == a->timeouts;
+    if (sc->hang_every == 0 && a->timeouts != 0) ok = false;
+    if (sc->nack_every == 0 && a->errors != 0) ok = false;
+    if (sc->nack_every == 0 && sc->hang_every == 0 &&
+        a->completed != (sc->n_triggers + per_read - 1) / per_read) ok = false;
+
+    const double bus_pct = 100.0 * (double)s.bus.busy_us / ((double)sc->n_triggers * (double)s.period_us);
+    printf("%-10s %5u Hz  xfer=%4u us  started=%5u done=%5u skipped=%5u err=%4u timeout=%4u  bus=%5.1f%%  %s\n",
+           sc->name, (unsigned)sc->rate_hz, (unsigned)xfer_us,
+           (unsigned)a->started, (unsigned)a->completed, (unsigned)a->skipped,
+           (unsigned)a->errors, (unsigned)a->timeouts, bus_pct, ok ? "OK" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t bus_hz = 400000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--bus") && i + 1 < argc) {
+            bus_hz = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-v")) {
+            g_verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--bus HZ] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (bus_hz < 10000) {
+        fprintf(stderr, "--bus must be at least 10000 Hz\n");
+        return 2;
+    }
+
+    const scenario_t scenarios[] = {
+        { "nominal",    100, 2000,  0,  0 },
+        { "1kHz",      1000, 5000,  0,  0 },
+        { "overrun",   4000, 8000,  0,  0 },
+        { "nack",       100, 2000, 37,  0 },
+        { "hang",       100, 2000,  0, 53 },
+        { "nack+hang", 1000, 5000, 11, 29 },
+    };
+
+    printf("ICM-20948 async burst read on a %u Hz mock bus (%d bytes)\n",
+           (unsigned)bus_hz, ICM_ASYNC_BURST_BYTES);
+    int failed = 0;
+    for (size_t i = 0; i < sizeof scenarios / sizeof scenarios[0]; i++) {
+        if (!run(&scenarios[i], bus_hz)) failed++;
+    }
+    if (failed) fprintf(stderr, "%d scenario(s) failed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,283 @@
+// project/host/imu_bench.c
+//
+// Sweep compute_features() over window sizes, sample rates and spectral
+// back-ends (plus the feat_stream engine) and report ns/window, cycles/sample,
+// peak stack and static RAM. Results go out as JSON so runs can be diffed
+// commit to commit; a readable table is printed to stderr.
+//
+//   ./imu_bench --json bench.json --tag $(git rev-parse --short HEAD)
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+#include "features.h"
+#include "feat_stream.h"
+#include "bench_objects.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// -------------------- Variants -------------------------------
+// One entry per features.c build in CMakeLists.txt (imu_features_variant).
+#define BENCH_VARIANTS(X) \
+    X(goertzel)           \
+    X(dft)                \
+    X(fft)
+
+typedef void (*features_fn)(const float*, const float*, const float*,
+                            const float*, const float*, const float*,
+                            int, float, feat_vec_t*);
+
+#define DECLARE_VARIANT(name)                                                  \
+    void compute_features_##name(const float*, const float*, const float*,     \
+                                 const float*, const float*, const float*,     \
+                                 int, float, feat_vec_t*);
+BENCH_VARIANTS(DECLARE_VARIANT)
+
+typedef struct {
+    const char *name;
+    features_fn fn;       // NULL: feat_stream engine
+    const char *obj;      // object file for static RAM accounting
+} variant_t;
+
+#define VARIANT_ENTRY(name) { #name, compute_features_##name, BENCH_OBJ_##name },
+static const variant_t kVariants[] = {
+    BENCH_VARIANTS(VARIANT_ENTRY)
+    { "feat_stream", NULL, NULL },
+};
+
+enum { BENCH_MAX_SAMPLES = 2048 };
+
+static const int kWinFull[]  = { 32, 64, 128, 256, 512, 1024, 2048 };
+static const int kFsFull[]   = { 50, 100, 200, 400, 1100, 2200 };
+static const int kWinQuick[] = { 64, 256, 1024 };
+static const int kFsQuick[]  = { 100, 1100 };
+
+// -------------------- Test signal ----------------------------
+static float g_sig[6][BENCH_MAX_SAMPLES];
+
+static void make_signal(float fs_hz) {
+    uint32_t lcg = 12345u;
+    for (int i = 0; i < BENCH_MAX_SAMPLES; i++) {
+        const float t = (float)i / fs_hz;
+        lcg = lcg * 1664525u + 1013904223u;
+        const float noise = ((float)(lcg >> 8) / 16777216.0f - 0.5f) * 0.02f;
+        g_sig[0][i] = 0.30f * sinf(2.0f * (float)M_PI * 2.5f * t) + noise;
+        g_sig[1][i] = 0.10f * sinf(2.0f * (float)M_PI * 6.0f * t) - noise;
+        g_sig[2][i] = 1.00f + 0.05f * cosf(2.0f * (float)M_PI * 1.0f * t);
+        g_sig[3][i] = 40.0f * sinf(2.0f * (float)M_PI * 1.5f * t) + 100.0f * noise;
+        g_sig[4][i] = 15.0f * cosf(2.0f * (float)M_PI * 0.7f * t);
+        g_sig[5][i] = 5.0f * noise;
+    }
+}
+
+// -------------------- One benchmark case ---------------------
+typedef struct {
+    const variant_t *v;
+    int n;
+    int hop;              // feat_stream only: samples pushed per window
+    float fs_hz;
+    feat_stream_t *stream;
+    int stream_pos;
+    feat_vec_t out;
+} bench_case_t;
+
+static void run_window(bench_case_t *c) {
+    if (c->v->fn) {
+        c->v->fn(g_sig[0], g_sig[1], g_sig[2], g_sig[3], g_sig[4], g_sig[5],
+                 c->n, c->fs_hz, &c->out);
+        return;
+    }
+    for (int h = 0; h < c->hop; h++) {
+        const int i = c->stream_pos;
+        feat_stream_push(c->stream, g_sig[0][i], g_sig[1][i], g_sig[2][i],
+                         g_sig[3][i], g_sig[4][i], g_sig[5][i]);
+        if (++c->stream_pos >= c->n) c->stream_pos = 0;
+    }
+    feat_stream_get(c->stream, &c->out);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t read_cycles(void) {
+#if BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// -------------------- Stack high-water mark ------------------
+// Runs the job on a thread whose (painted) stack we own and counts how many
+// bytes were overwritten. A no-op baseline removes thread start-up overhead.
+enum { BENCH_STACK_BYTES = 512 * 1024 };
+static uint8_t g_stack[BENCH_STACK_BYTES] __attribute__((aligned(64)));
+
+typedef struct { bench_case_t *c; } stack_job_t;
+
+static void *stack_thread(void *p) {
+    stack_job_t *job = (stack_job_t *)p;
+    if (job->c) run_window(job->c);
+    return NULL;
+}
+
+static long stack_used(bench_case_t *c) {
+    memset(g_stack, 0xA5, sizeof g_stack);
+
+    pthread_attr_t attr;
+    pthread_t th;
+    stack_job_t job = { c };
+    if (pthread_attr_init(&attr) != 0) return -1;
+    if (pthread_attr_setstack(&attr, g_stack, sizeof g_stack) != 0 ||
+        pthread_create(&th, &attr, stack_thread, &job) != 0) {
+        pthread_attr_destroy(&attr);
+        return -1;
+    }
+    pthread_join(th, NULL);
+    pthread_attr_destroy(&attr);
+
+    size_t i = 0;
+    while (i < sizeof g_stack && g_stack[i] == 0xA5) i++;
+    return (long)(sizeof g_stack - i);
+}
+
+// -------------------- Static RAM of a variant ----------------
+static long static_ram_bytes(const variant_t *v) {
+    if (!v->obj) return (long)sizeof(feat_stream_t);   // caller-owned state
+
+    char cmd[1024];
+    snprintf(cmd, sizeof cmd, "size -B \"%s\" 2>/dev/null", v->obj);
+    FILE *p = popen(cmd, "r");
+    if (!p) return -1;
+
+    char line[512];
+    long text = -1, data = -1, bss = -1;
+    if (fgets(line, sizeof line, p) && fgets(line, sizeof line, p)) {
+        if (sscanf(line, "%ld %ld %ld", &text, &data, &bss) != 3) data = bss = -1;
+    }
+    pclose(p);
+    return (data < 0 || bss < 0) ? -1 : data + bss;
+}
+
+// -------------------- main -----------------------------------
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [--json PATH] [--tag STR] [--quick] [--min-ms N]\n"
+            "  --json    write results to PATH instead of stdout\n"
+            "  --tag     free-form label stored in the JSON (e.g. commit hash)\n"
+            "  --quick   reduced sweep\n"
+            "  --min-ms  minimum timed duration per case (default 20)\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    const char *tag = "";
+    bool quick = false;
+    double min_ms = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json") && i + 1 < argc)        json_path = argv[++i];
+        else if (!strcmp(argv[i], "--tag") && i + 1 < argc)    tag = argv[++i];
+        else if (!strcmp(argv[i], "--min-ms") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--quick"))                  quick = true;
+        else { usage(argv[0]); return 2; }
+    }
+
+    const int *wins = quick ? kWinQuick : kWinFull;
+    const int *fss  = quick ? kFsQuick  : kFsFull;
+    const int n_wins = quick ? (int)(sizeof kWinQuick / sizeof kWinQuick[0]) : (int)(sizeof kWinFull / sizeof kWinFull[0]);
+    const int n_fss  = quick ? (int)(sizeof kFsQuick / sizeof kFsQuick[0])   : (int)(sizeof kFsFull / sizeof kFsFull[0]);
+
+    FILE *out = json_path ? fopen(json_path, "w") : stdout;
+    if (!out) { perror(json_path); return 1; }
+
+    static feat_stream_t stream;
+    const long stack_base = stack_used(NULL);
+    const uint64_t min_ns = (uint64_t)(min_ms * 1e6);
+
+    fprintf(out, "{\n  \"bench\": \"imu_features\",\n  \"tag\": \"%s\",\n", tag);
+    fprintf(out, "  \"compiler\": \"%s\",\n  \"tsc\": %s,\n  \"results\": [\n",
+            __VERSION__, BENCH_HAVE_TSC ? "true" : "false");
+    fprintf(stderr, "%-12s %5s %6s %12s %12s %10s %10s\n",
+            "method", "win", "fs_hz", "ns/window", "cyc/sample", "stack_B", "static_B");
+
+    bool first = true;
+    for (size_t vi = 0; vi < sizeof kVariants / sizeof kVariants[0]; vi++) {
+        const variant_t *v = &kVariants[vi];
+        const long static_b = static_ram_bytes(v);
+
+        for (int fi = 0; fi < n_fss; fi++) {
+            const float fs_hz = (float)fss[fi];
+            make_signal(fs_hz);
+
+            for (int wi = 0; wi < n_wins; wi++) {
+                bench_case_t c = { .v = v, .n = wins[wi], .fs_hz = fs_hz, .stream = &stream };
+                if (!v->fn) {
+                    // windows whose 0-10 Hz range needs more bins than the engine keeps
+                    if (c.n > FEAT_STREAM_MAX_SAMPLES || !feat_stream_init(&stream, c.n, fs_hz)) continue;
+                    c.hop = c.n / 2;   // 50% overlap, as in config.h
+                    for (int i = 0; i < c.n; i++) {
+                        feat_stream_push(&stream, g_sig[0][i], g_sig[1][i], g_sig[2][i],
+                                         g_sig[3][i], g_sig[4][i], g_sig[5][i]);
+                    }
+                }
+
+                run_window(&c);   // warm-up (twiddle/Hann caches)
+                long stack_b = stack_used(&c);
+                if (stack_b >= 0 && stack_base >= 0) stack_b -= stack_base;
+
+                uint64_t reps = 0;
+                const uint64_t cyc0 = read_cycles();
+                const uint64_t t0 = now_ns();
+                uint64_t elapsed = 0;
+                do {
+                    run_window(&c);
+                    reps++;
+                    elapsed = now_ns() - t0;
+                } while (elapsed < min_ns || reps < 3);
+                const uint64_t cyc = read_cycles() - cyc0;
+
+                // the engine pushes only the hop per window, the others read all n
+                const int new_samples = v->fn ? c.n : c.hop;
+                const double ns_win = (double)elapsed / (double)reps;
+                const double cyc_sample = BENCH_HAVE_TSC
+                    ? (double)cyc / (double)reps / (double)new_samples : -1.0;
+
+                fprintf(stderr, "%-12s %5d %6.0f %12.1f %12.2f %10ld %10ld\n",
+                        v->name, c.n, (double)fs_hz, ns_win, cyc_sample, stack_b, static_b);
+
+                fprintf(out, "%s    {\"method\": \"%s\", \"win\": %d, \"hop\": %d, \"fs_hz\": %.0f, "
+                             "\"reps\": %llu, \"ns_per_window\": %.1f, ",
+                        first ? "" : ",\n", v->name, c.n, new_samples, (double)fs_hz,
+                        (unsigned long long)reps, ns_win);
+                if (BENCH_HAVE_TSC) fprintf(out, "\"cycles_per_sample\": %.3f, ", cyc_sample);
+                else                fprintf(out, "\"cycles_per_sample\": null, ");
+                fprintf(out, "\"stack_bytes\": %ld, \"static_bytes\": %ld, \"dom_freq\": %.4f}",
+                        stack_b, static_b, (double)c.out.amag.dom_freq);
+                first = false;
+            }
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (json_path) fclose(out);
+    return 0;
+}
@@ -0,0 +1,290 @@
+// project/host/imu_decide_sim.c
+//
+// Detection latency and flicker of the decision layer (src/gesture_filter.c)
+// on a synthetic labelled session: random shake / tilt / circle segments of
+// 2-5 s with 1-3 s of rest in between. The same classify() output stream is
+// scored three ways:
+//   raw       the class of every full window, as the firmware logged it
+//   filtered  gesture_filter over the full windows only
+//   early     gesture_filter over full and partial windows (DECISION_EARLY)
+// Latency runs from the start of a segment to the first decision for its
+// class while it lasts; a segment that never gets one is missed. Switches
+// count decision changes per minute, agreement the share of time the
+// decision matches the true label.
+//
+// --fit first runs a second session (another seed) to measure the confusion
+// of classify() on full and partial windows, evaluates with those tables and
+// prints them in the form of gesture_filter.c's defaults.
+//
+//   ./build-host/imu_decide_sim [--minutes N] [--seed N] [--fit] [--fs HZ]
+//       [--win MS] [--hop MS] [--early MS] [--early-hop MS]
+//       [--p-stay P] [--enter P]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "config.h"
+#include "features.h"
+#include "classifier.h"
+#include "gesture_filter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum { MODE_RAW = 0, MODE_FILTERED, MODE_EARLY, N_MODES };
+static const char *const kModeName[N_MODES] = { "raw", "filtered", "early" };
+
+static uint32_t g_lcg;
+static float frand(void) {
+    g_lcg = g_lcg * 1664525u + 1013904223u;
+    return (float)(g_lcg >> 8) / 16777216.0f;
+}
+
+// -------------------- Session --------------------------------
+typedef struct {
+    int cls;
+    float t0, t1;           // [s]
+} segment_t;
+
+static int make_segments(segment_t *seg, int cap, float total_s) {
+    int n = 0;
+    float t = 0.0f;
+    while (n + 2 <= cap && t < total_s) {
+        const float rest = 1.0f + 2.0f * frand();
+        seg[n++] = (segment_t){ G_NONE, t, t + rest };
+        t += rest;
+        const float len = 2.0f + 3.0f * frand();
+        seg[n++] = (segment_t){ 1 + (int)(frand() * 3.0f) % 3, t, t + len };
+        t += len;
+    }
+    return n;
+}
+
+// One sample of gesture cls at time t [s] since the segment start: accel in
+// g with gravity removed (as main.c's calibration bias does), gyro in dps.
+// Each gesture moves the accel magnitude the way classify_rules() expects,
+// so a full window inside a segment is classified correctly.
+static void synth(int cls, float t, float v[6]) {
+    const float noise = (frand() - 0.5f) * 0.004f;
+    float ax = 0.0f, ay = 0.0f, az = 0.0f, gx = 0.0f, gy = 0.0f, gz = 0.0f;
+    if (cls == G_SHAKE) {           // 5 Hz along x
+        ax = 0.6f * sinf(2.0f * (float)M_PI * 5.0f * t);
+        gz = 40.0f * sinf(2.0f * (float)M_PI * 5.0f * t);
+    } else if (cls == G_TILT) {     // 0.7 Hz rocking about y: gravity swings in x/z
+        const float a = 0.5f * sinf(2.0f * (float)M_PI * 0.7f * t);
+        ax = sinf(a);
+        az = cosf(a) - 1.0f;
+        gy = 0.5f * 2.0f * (float)M_PI * 0.7f * cosf(2.0f * (float)M_PI * 0.7f * t) * 57.3f;
+    } else if (cls == G_CIRCLE) {   // 2.5 Hz loop in the x/y plane, off centre
+        ax = 0.3f * cosf(2.0f * (float)M_PI * 2.5f * t);
+        ay = 0.15f + 0.3f * sinf(2.0f * (float)M_PI * 2.5f * t);
+        gx = 30.0f * sinf(2.0f * (float)M_PI * 2.5f * t);
+        gy = 30.0f * cosf(2.0f * (float)M_PI * 2.5f * t);
+    }
+    v[0] = ax + noise; v[1] = ay - noise; v[2] = az + noise;
+    v[3] = gx + 200.0f * noise; v[4] = gy; v[5] = gz;
+}
+
+// -------------------- Scoring --------------------------------
+typedef struct {
+    int decision;
+    int switches;
+    double agree_s;
+    double lat_sum;
+    int detected, missed;
+    float lat[512];
+    bool seg_hit;
+} score_t;
+
+static int cmp_float(const void *a, const void *b) {
+    const float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void set_decision(score_t *s, int cls, float t, const segment_t *seg) {
+    if (cls != s->decision) s->switches++;
+    s->decision = cls;
+    if (!s->seg_hit && cls == seg->cls && seg->cls != G_NONE) {
+        s->seg_hit = true;
+        if (s->detected < (int)(sizeof s->lat / sizeof s->lat[0])) s->lat[s->detected] = t - seg->t0;
+        s->lat_sum += t - seg->t0;
+        s->detected++;
+    }
+}
+
+typedef struct {
+    float fs_hz;
+    int win, hop, early_n, early_hop;
+    float minutes;
+} sim_cfg_t;
+
+typedef struct {
+    score_t score[N_MODES];
+    uint32_t full_counts[GF_N_CLASSES][GF_N_CLASSES];    // [gesture][class]
+    uint32_t early_counts[GF_N_CLASSES][GF_N_CLASSES];
+    int n_full, n_early, n_seg;
+    float total_s;
+} sim_result_t;
+
+// One session: every full and partial window is classified once and fed to
+// the scorers and filters that use it.
+static bool run_session(const sim_cfg_t *sc, uint32_t seed, const gesture_filter_cfg_t *fcfg,
+                        sim_result_t *res) {
+    static gesture_early_t early;
+    static segment_t seg[4096];
+    if (!gesture_early_init(&early, sc->early_n, sc->early_hop, sc->hop)) return false;
+    gesture_filter_t filt[N_MODES];
+    for (int m = 0; m < N_MODES; m++) gesture_filter_init(&filt[m], fcfg);
+    memset(res, 0, sizeof(*res));
+
+    g_lcg = seed;
+    const int n_seg = make_segments(seg, 4096, sc->minutes * 60.0f);
+    const float total_s = seg[n_seg - 1].t1;
+    const size_t n = (size_t)(total_s * sc->fs_hz);
+    const int win = sc->win;
+    // each sample stored twice, win apart, like the firmware's float rings:
+    // the full window and the partial one at its tail are read in place
+    float *ring = calloc((size_t)win * 12, sizeof(float));
+    if (!ring) return false;
+
+    score_t *s = res->score;
+    int k = 0, ring_index = 0, ring_filled = 0, hop_accum = 0;
+    for (size_t i = 0; i < n; i++) {
+        const float t = (float)i / sc->fs_hz;
+        while (k + 1 < n_seg && t >= seg[k].t1) {
+            k++;
+            for (int m = 0; m < N_MODES; m++) {
+                if (seg[k - 1].cls != G_NONE && !s[m].seg_hit) s[m].missed++;
+                s[m].seg_hit = false;
+            }
+        }
+        float v[6];
+        synth(seg[k].cls, t - seg[k].t0, v);
+
+        for (int c = 0; c < 6; c++) ring[c * 2 * win + ring_index] = ring[c * 2 * win + ring_index + win] = v[c];
+        if (++ring_index >= win) ring_index = 0;
+        if (ring_filled < win) ring_filled++;
+        hop_accum++;
+
+        if (gesture_early_step(&early)) {
+            const float *e0 = &ring[ring_index + win - sc->early_n];
+            feat_vec_t f;
+            compute_features(e0, e0 + 2 * win, e0 + 4 * win, e0 + 6 * win, e0 + 8 * win, e0 + 10 * win,
+                             sc->early_n, sc->fs_hz, &f);
+            const int cls = classify(&f);
+            res->early_counts[seg[k].cls][cls]++;
+            res->n_early++;
+            if (gesture_filter_update(&filt[MODE_EARLY], cls, true)) {
+                set_decision(&s[MODE_EARLY], filt[MODE_EARLY].decision, t, &seg[k]);
+            }
+        }
+
+        if (ring_filled >= win && hop_accum >= sc->hop) {
+            hop_accum = 0;
+            gesture_early_full(&early);
+            const float *w0 = &ring[ring_index];
+            feat_vec_t f;
+            compute_features(w0, w0 + 2 * win, w0 + 4 * win, w0 + 6 * win, w0 + 8 * win, w0 + 10 * win,
+                             win, sc->fs_hz, &f);
+            const int cls = classify(&f);
+            res->full_counts[seg[k].cls][cls]++;
+            res->n_full++;
+            set_decision(&s[MODE_RAW], cls, t, &seg[k]);
+            for (int m = MODE_FILTERED; m <= MODE_EARLY; m++) {
+                if (gesture_filter_update(&filt[m], cls, false)) set_decision(&s[m], filt[m].decision, t, &seg[k]);
+            }
+        }
+
+        for (int m = 0; m < N_MODES; m++) {
+            if (s[m].decision == seg[k].cls) s[m].agree_s += 1.0 / sc->fs_hz;
+        }
+    }
+    for (int m = 0; m < N_MODES; m++) {
+        if (seg[k].cls != G_NONE && !s[m].seg_hit) s[m].missed++;
+    }
+    res->n_seg = n_seg;
+    res->total_s = total_s;
+    free(ring);
+    return true;
+}
+
+static void print_table(const char *name, const float t[GF_N_CLASSES][GF_N_CLASSES]) {
+    printf("static const float %s[GF_N_CLASSES][GF_N_CLASSES] = {\n", name);
+    for (int g = 0; g < GF_N_CLASSES; g++) {
+        printf("    {");
+        for (int c = 0; c < GF_N_CLASSES; c++) printf(" %.3ff%s", (double)t[g][c], c + 1 < GF_N_CLASSES ? "," : "");
+        printf(" },   // %s\n", gesture_name(g));
+    }
+    printf("};\n");
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--minutes N] [--seed N] [--fit] [--fs HZ] [--win MS] [--hop MS]\n"
+                    "          [--early MS] [--early-hop MS] [--p-stay P] [--enter P]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    float fs_hz = (float)SAMPLE_HZ, minutes = 10.0f, p_stay = -1.0f, enter = -1.0f;
+    int win_ms = WIN_MS, hop_ms = HOP_MS, early_ms = WIN_MS / 2, early_hop_ms = HOP_MS / 2;
+    uint32_t seed = 1u;
+    bool fit = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--minutes") && i + 1 < argc)        minutes = strtof(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)      seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--fit"))                       fit = true;
+        else if (!strcmp(argv[i], "--fs") && i + 1 < argc)        fs_hz = strtof(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--win") && i + 1 < argc)       win_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--hop") && i + 1 < argc)       hop_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--early") && i + 1 < argc)     early_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--early-hop") && i + 1 < argc) early_hop_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--p-stay") && i + 1 < argc)    p_stay = strtof(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--enter") && i + 1 < argc)     enter = strtof(argv[++i], NULL);
+        else { usage(argv[0]); return 2; }
+    }
+
+    const sim_cfg_t sc = {
+        fs_hz,
+        (int)(fs_hz * (float)win_ms / 1000.0f), (int)(fs_hz * (float)hop_ms / 1000.0f),
+        (int)(fs_hz * (float)early_ms / 1000.0f), (int)(fs_hz * (float)early_hop_ms / 1000.0f),
+        minutes > 0.1f ? minutes : 0.1f,
+    };
+    gesture_filter_cfg_t cfg;
+    gesture_filter_default_cfg(&cfg);
+    if (p_stay > 0.0f) cfg.p_stay = p_stay;
+    if (enter > 0.0f) cfg.enter = enter;
+
+    static sim_result_t res;
+    if (sc.win < 2 || sc.hop < 1 || sc.early_hop < 1 || sc.early_n < 2 || sc.early_n > sc.win) {
+        fprintf(stderr, "invalid window/hop: win=%d hop=%d partial=%d/%d samples\n",
+                sc.win, sc.hop, sc.early_n, sc.early_hop);
+        return 2;
+    }
+    if (fit) {
+        run_session(&sc, seed + 1000u, &cfg, &res);
+        gesture_filter_confusion(cfg.full, (const uint32_t (*)[GF_N_CLASSES])res.full_counts);
+        gesture_filter_confusion(cfg.early, (const uint32_t (*)[GF_N_CLASSES])res.early_counts);
+        print_table("kFullConfusion", (const float (*)[GF_N_CLASSES])cfg.full);
+        print_table("kEarlyConfusion", (const float (*)[GF_N_CLASSES])cfg.early);
+    }
+    run_session(&sc, seed, &cfg, &res);
+
+    printf("%.1f min synthetic session, %d segments, fs %.0f Hz, window %d/%d, partial %d/%d samples\n",
+           (double)res.total_s / 60.0, res.n_seg, (double)fs_hz, sc.win, sc.hop, sc.early_n, sc.early_hop);
+    printf("p_stay %.2f enter %.2f%s; %d full + %d partial windows\n", (double)cfg.p_stay,
+           (double)cfg.enter, fit ? ", fitted confusion" : "", res.n_full, res.n_early);
+    printf("%-9s %9s %9s %9s %7s %12s %9s\n", "mode", "lat mean", "lat p50", "lat p90", "missed", "switch/min", "agree");
+    for (int m = 0; m < N_MODES; m++) {
+        score_t *s = &res.score[m];
+        const int nl = s->detected < 512 ? s->detected : 512;
+        qsort(s->lat, (size_t)nl, sizeof(float), cmp_float);
+        printf("%-9s %8.2fs %8.2fs %8.2fs %7d %12.1f %8.1f%%\n", kModeName[m],
+               s->detected ? s->lat_sum / s->detected : 0.0,
+               nl ? (double)s->lat[nl / 2] : 0.0, nl ? (double)s->lat[(nl * 9) / 10] : 0.0,
+               s->missed, s->switches / ((double)res.total_s / 60.0), 100.0 * s->agree_s / (double)res.total_s);
+    }
+    return 0;
+}
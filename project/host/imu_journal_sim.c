@@ -0,0 +1,172 @@
+// project/host/imu_journal_sim.c
+//
+// Runs src/sd_writer.cpp with SD_JOURNAL framing on the real FatFs over the
+// RAM disk in host/mock_sd.c, cuts power mid-session and recovers the log
+// the way boot does (sd_writer_recover). A power cut is a snapshot of the
+// disk: the writer is then closed and the snapshot put back, so only what
+// had reached the card survives. Each scenario checks that recovery keeps
+// every block that was on the card, within SD_JOURNAL_SCAN_BLOCKS, and that
+// the recovered stream is a prefix of what was appended. With the service
+// loop keeping up, it also checks that no more is lost than the timed sync
+// allows: SD_SYNC_MS of records, or the byte budget plus both buffers when
+// that much arrives within SD_SYNC_MS. Exits non-zero on any mismatch.
+//
+//   ./build-host/imu_journal_sim [-v]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ff.h"
+#include "log_journal.h"
+#include "mock_sd.h"
+#include "sd_writer.h"
+
+#define PATH           "0:/session.bin"
+#define PREALLOC_BYTES (1024u * 1024u)
+#define RECORD_BYTES   32u
+
+typedef struct {
+    const char *name;
+    bool raw;
+    uint32_t async_polls;      // 0: blocking writes only
+    uint32_t rate_hz;          // records per second
+    uint32_t service_every;    // sd_writer_service() every N records, 0 = never
+    uint32_t n_records;        // appended before the cut
+} scenario_t;
+
+static const scenario_t kScenarios[] = {
+    { "fatfs, serviced",            false, 0,  100,   1, 2000 },
+    { "fatfs, slow",                false, 0,   20,   1, 1234 },
+    { "fatfs, never serviced",      false, 0, 1000,   0, 4000 },
+    { "raw, serviced",              true,  0,  100,   1, 2000 },
+    { "raw, slow",                  true,  0,   20,   1, 1234 },
+    { "raw, never serviced",        true,  0, 1000,   0, 4000 },
+    { "raw async, serviced",        true,  3, 1000,   1, 4000 },
+    { "raw async, slow",            true,  3,   20,   1, 1234 },
+    { "raw async, service lagging", true,  3, 1000, 200, 4000 },
+};
+
+static FATFS s_fs;
+static sd_writer_t s_writer;
+static uint8_t s_snapshot[(size_t)MOCK_SD_SECTORS * 512u];
+static uint8_t s_stream[PREALLOC_BYTES];
+
+static uint8_t stream_byte(uint32_t i) {
+    return (uint8_t)((i * 131u) ^ (i >> 9));
+}
+
+static bool format_and_mount(void) {
+    static uint8_t work[FF_MAX_SS * 4];
+    const MKFS_PARM opt = { FM_ANY | FM_SFD, 0, 0, 0, 0 };
+    return f_mkfs("0:", &opt, work, sizeof work) == FR_OK && f_mount(&s_fs, "0:", 1) == FR_OK;
+}
+
+// Reads the blocks of the recovered file back as one stream.
+static bool read_stream(uint32_t blocks, uint32_t *len) {
+    FIL f;
+    if (f_open(&f, PATH, FA_READ) != FR_OK) return false;
+    uint8_t sector[512];
+    UINT br = 0;
+    uint32_t session = 0;
+    bool ok = f_read(&f, sector, sizeof sector, &br) == FR_OK && br == sizeof sector &&
+              log_journal_parse_header(sector, &session) &&
+              f_size(&f) == (FSIZE_t)(LOG_JOURNAL_FIRST_BLOCK + blocks) * 512u &&
+              f_lseek(&f, LOG_JOURNAL_FIRST_BLOCK * 512u) == FR_OK;
+    *len = 0;
+    for (uint32_t b = 0; ok && b < blocks; b++) {
+        ok = f_read(&f, sector, sizeof sector, &br) == FR_OK && br == sizeof sector;
+        const int n = ok ? log_journal_check(sector, session, b) : -1;
+        ok = n >= 0 && *len + (uint32_t)n <= sizeof s_stream;
+        if (ok) {
+            memcpy(&s_stream[*len], sector, (size_t)n);
+            *len += (uint32_t)n;
+        }
+    }
+    f_close(&f);
+    return ok;
+}
+
+static bool run(const scenario_t *s, bool verbose) {
+    mock_sd_init(s->async_polls, 0x1234567u);
+    if (!g_mock_sd.disk || !format_and_mount()) {
+        printf("%-28s  FAIL: no volume\n", s->name);
+        return false;
+    }
+    sd_writer_t *w = &s_writer;
+    FRESULT fr = sd_writer_open(w, PATH, PREALLOC_BYTES, s->raw, true);
+    if (fr != FR_OK || (w->raw_sd != NULL) != s->raw) {
+        printf("%-28s  FAIL: open (fr=%d)\n", s->name, (int)fr);
+        return false;
+    }
+
+    uint32_t appended = 0;
+    for (uint32_t i = 0; fr == FR_OK && i < s->n_records; i++) {
+        uint8_t rec[RECORD_BYTES];
+        for (uint32_t k = 0; k < RECORD_BYTES; k++) rec[k] = stream_byte(appended + k);
+        fr = sd_writer_append(w, rec, sizeof rec);
+        appended += RECORD_BYTES;
+        mock_sd_advance(1000000u / s->rate_hz);
+        if (fr == FR_OK && s->service_every && i % s->service_every == 0) fr = sd_writer_service(w, NULL);
+    }
+    if (fr != FR_OK) {
+        printf("%-28s  FAIL: write (fr=%d)\n", s->name, (int)fr);
+        return false;
+    }
+
+    // power cut
+    const uint32_t on_card = w->stats.bytes / 512u - LOG_JOURNAL_FIRST_BLOCK;
+    const sd_writer_stats_t st = w->stats;
+    memcpy(s_snapshot, g_mock_sd.disk, sizeof s_snapshot);
+    sd_writer_close(w);
+    memcpy(g_mock_sd.disk, s_snapshot, sizeof s_snapshot);
+
+    // boot
+    sd_writer_recovery_t r;
+    uint32_t len = 0;
+    bool ok = f_mount(&s_fs, "0:", 1) == FR_OK && sd_writer_recover(PATH, &r) == FR_OK &&
+              read_stream(r.blocks, &len);
+    const bool found = ok;
+    ok = ok && r.journaled && r.state == LOG_JOURNAL_OPEN && r.scanned <= SD_JOURNAL_SCAN_BLOCKS &&
+         r.blocks >= on_card && len <= appended && g_mock_sd.violations == 0;
+    for (uint32_t i = 0; ok && i < len; i++) ok = s_stream[i] == stream_byte(i);
+    if (s->service_every == 1) {
+        // below the byte budget per SD_SYNC_MS, every sync is a timed one
+        const uint32_t timed = ((uint32_t)SD_SYNC_MS * s->rate_hz / 1000u + 1u) * RECORD_BYTES;
+        const uint32_t budget = SD_SYNC_BYTES + 2u * SD_BUF_BYTES;
+        ok = ok && appended - len <= (timed < SD_SYNC_BYTES ? timed : budget);
+    }
+
+    printf("%-28s  on card %4u  checkpoint %4u  scanned %3u  recovered %4u  lost %6u B  %s\n",
+           s->name, on_card, r.checkpoint, r.scanned, found ? r.blocks : 0u,
+           found ? appended - len : appended, ok ? "ok" : "FAIL");
+    if (verbose) {
+        printf("    flushes %u (inline %u, async %u)  syncs %u  tail writes %u  sector writes %u  violations %u\n",
+               st.flushes, st.inline_flushes, st.async_flushes, st.syncs, st.tail_writes,
+               g_mock_sd.sectors_written, g_mock_sd.violations);
+    }
+    f_unmount("0:");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    printf("journal: %u B buffers, sync every %u B / %u ms, scan bound %u blocks\n",
+           SD_BUF_BYTES, SD_SYNC_BYTES, SD_SYNC_MS, SD_JOURNAL_SCAN_BLOCKS);
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof kScenarios / sizeof kScenarios[0]; i++) {
+        if (!run(&kScenarios[i], verbose)) failed++;
+    }
+    if (failed) printf("%d scenario(s) FAILED\n", failed);
+    return failed ? 1 : 0;
+}
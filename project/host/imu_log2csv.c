@@ -0,0 +1,307 @@
+// project/host/imu_log2csv.c
+//
+// Converts a LOG_BINARY session (logs/session_*.bin) back into the CSV the
+// firmware writes with LOG_BINARY=0, column for column, so the analysis
+// notebook reads either. Decoding is driven by the schema stored in the file
+// header, not by imu_log_record_t, and is byte-order independent. The same
+// goes for the per-sample raw logs (LOG_RAW_SD, logs/raw_*.bin), which are
+// unpacked with src/raw_codec.c when written with RAW_LOG_COMPRESS. Journaled
+// logs (SD_JOURNAL) are unwrapped first; one the firmware has not recovered
+// yet is cut at its last valid block here as well.
+//
+//   ./build-host/imu_log2csv logs/session_123.bin > session_123.csv
+//   ./build-host/imu_log2csv logs/raw_123.bin > raw_123.csv
+//   ./build-host/imu_log2csv --info logs/session_123.bin
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "imu_log_format.h"
+#include "log_journal.h"
+#include "raw_codec.h"
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static unsigned type_size(uint8_t t) {
+    switch (t) {
+    case IMU_LOG_U8:  case IMU_LOG_I8:  return 1;
+    case IMU_LOG_U16: case IMU_LOG_I16: return 2;
+    case IMU_LOG_U32: case IMU_LOG_I32: case IMU_LOG_F32: return 4;
+    default: return 0;
+    }
+}
+
+static void print_field(FILE *out, const imu_log_field_t *f, const uint8_t *rec) {
+    const uint8_t *p = rec + f->offset;
+    switch (f->type) {
+    case IMU_LOG_U8:  fprintf(out, "%u", (unsigned)p[0]); break;
+    case IMU_LOG_I8:  fprintf(out, "%d", (int)(int8_t)p[0]); break;
+    case IMU_LOG_U16: fprintf(out, "%u", (unsigned)rd16(p)); break;
+    case IMU_LOG_I16: fprintf(out, "%d", (int)(int16_t)rd16(p)); break;
+    case IMU_LOG_U32: fprintf(out, "%lu", (unsigned long)rd32(p)); break;
+    case IMU_LOG_I32: fprintf(out, "%ld", (long)(int32_t)rd32(p)); break;
+    case IMU_LOG_F32: {
+        const uint32_t u = rd32(p);
+        float v;
+        memcpy(&v, &u, sizeof v);
+        fprintf(out, "%.*f", (int)f->decimals, v);
+        break;
+    }
+    }
+}
+
+// Parses and validates the header; fields are copied into *h.
+static bool read_header(FILE *in, const char *path, imu_log_header_t *h) {
+    uint8_t raw[IMU_LOG_HEADER_BYTES];
+    if (fread(raw, 1, IMU_LOG_SCHEMA_OFFSET, in) != IMU_LOG_SCHEMA_OFFSET || memcmp(raw, IMU_LOG_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not an IMU binary log\n", path);
+        return false;
+    }
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, raw, 4);
+    h->version      = rd16(raw + 4);
+    h->header_bytes = rd16(raw + 6);
+    h->record_bytes = rd16(raw + 8);
+    h->n_fields     = rd16(raw + 10);
+    h->sample_hz    = rd32(raw + 12);
+    h->win_ms       = rd32(raw + 16);
+    h->hop_ms       = rd32(raw + 20);
+    h->codec        = rd32(raw + 24);   // reserved (0) before version 2
+
+    if (h->version > IMU_LOG_VERSION) {
+        fprintf(stderr, "%s: log version %u is newer than this tool (%u)\n",
+                path, (unsigned)h->version, (unsigned)IMU_LOG_VERSION);
+        return false;
+    }
+    const size_t schema_end = IMU_LOG_SCHEMA_OFFSET + (size_t)h->n_fields * sizeof(imu_log_field_t);
+    if (h->codec > IMU_LOG_CODEC_DELTA_VARINT ||
+        (h->codec == IMU_LOG_CODEC_DELTA_VARINT && h->record_bytes != sizeof(imu_raw_record_t))) {
+        fprintf(stderr, "%s: unknown codec %u\n", path, (unsigned)h->codec);
+        return false;
+    }
+    if (h->n_fields == 0 || h->n_fields > IMU_LOG_MAX_FIELDS ||
+        h->header_bytes < schema_end || h->header_bytes > sizeof raw || h->record_bytes == 0) {
+        fprintf(stderr, "%s: corrupt header\n", path);
+        return false;
+    }
+    if (fread(raw + IMU_LOG_SCHEMA_OFFSET, 1, h->header_bytes - IMU_LOG_SCHEMA_OFFSET, in) !=
+        (size_t)(h->header_bytes - IMU_LOG_SCHEMA_OFFSET)) {
+        fprintf(stderr, "%s: truncated header\n", path);
+        return false;
+    }
+    for (unsigned i = 0; i < h->n_fields; i++) {
+        imu_log_field_t *f = &h->field[i];
+        memcpy(f, raw + IMU_LOG_SCHEMA_OFFSET + i * sizeof(*f), sizeof(*f));
+        f->name[IMU_LOG_NAME_LEN - 1] = '\0';
+        if (type_size(f->type) == 0 || f->offset + type_size(f->type) > h->record_bytes) {
+            fprintf(stderr, "%s: bad schema entry %u\n", path, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Source of records: straight from the file, or unpacked sector by sector.
+typedef struct {
+    FILE *in;
+    const char *path;
+    const imu_log_header_t *h;
+    imu_raw_record_t packed[RAW_CODEC_MAX_SAMPLES];
+    int n_packed, i_packed;
+    size_t sectors;           // codec sectors read
+} record_reader_t;
+
+// Next record into rec (h->record_bytes). false at the end of the data; a
+// truncated record or a sector that does not decode is reported and ends it.
+static bool next_record(record_reader_t *r, uint8_t *rec) {
+    if (r->h->codec == IMU_LOG_CODEC_NONE) {
+        const size_t got = fread(rec, 1, r->h->record_bytes, r->in);
+        if (got != 0 && got != r->h->record_bytes) {
+            fprintf(stderr, "%s: ignoring truncated last record (%zu of %u bytes)\n",
+                    r->path, got, (unsigned)r->h->record_bytes);
+        }
+        return got == r->h->record_bytes;
+    }
+    while (r->i_packed == r->n_packed) {
+        uint8_t sector[RAW_CODEC_SECTOR_BYTES];
+        const size_t got = fread(sector, 1, sizeof sector, r->in);
+        if (got == 0) return false;
+        if (got != sizeof sector) {
+            fprintf(stderr, "%s: ignoring truncated last sector (%zu bytes)\n", r->path, got);
+            return false;
+        }
+        r->n_packed = raw_codec_decode(sector, r->packed);
+        r->i_packed = 0;
+        if (r->n_packed <= 0) {
+            // zero sector: end of a closed log; garbage: stale tail of an unclosed one
+            if (r->n_packed < 0) {
+                fprintf(stderr, "%s: sector %zu does not decode, ignoring the rest (unclosed log?)\n",
+                        r->path, r->sectors);
+            }
+            r->n_packed = 0;
+            return false;
+        }
+        r->sectors++;
+    }
+    memcpy(rec, &r->packed[r->i_packed++], sizeof(imu_raw_record_t));   // host is little-endian too
+    return true;
+}
+
+static const char *journal_state(uint32_t state) {
+    switch (state) {
+    case LOG_JOURNAL_CLOSED:    return "closed";
+    case LOG_JOURNAL_RECOVERED: return "recovered";
+    default:                    return "not closed";
+    }
+}
+
+// Copies the payload of the valid blocks, i.e. the plain log, into a
+// temporary file. Unlike the firmware this checks every block from the first,
+// so it does not depend on the checkpoints beyond the final block count.
+static FILE *unwrap_journal(FILE *in, const char *path, bool info) {
+    uint8_t block[LOG_JOURNAL_BLOCK_BYTES];
+    uint8_t slot[2][LOG_JOURNAL_BLOCK_BYTES];
+    uint32_t session;
+    if (fread(block, 1, sizeof block, in) != sizeof block || !log_journal_parse_header(block, &session) ||
+        fread(slot, 1, sizeof slot, in) != sizeof slot) {
+        fprintf(stderr, "%s: corrupt journal header\n", path);
+        return NULL;
+    }
+    log_journal_checkpoint_t cp;
+    log_journal_newest_checkpoint(slot[0], slot[1], session, &cp);
+    const bool final = cp.state != LOG_JOURNAL_OPEN;
+
+    FILE *out = tmpfile();
+    if (!out) {
+        perror("tmpfile");
+        return NULL;
+    }
+    uint32_t blocks = 0;
+    unsigned long long payload = 0;
+    while (!(final && blocks == cp.blocks) && fread(block, 1, sizeof block, in) == sizeof block) {
+        const int len = log_journal_check(block, session, blocks);
+        if (len < 0) break;
+        fwrite(block, 1, (size_t)len, out);
+        blocks++;
+        payload += (unsigned)len;
+        if (len < LOG_JOURNAL_PAYLOAD) break;   // short block: end of a closed log
+    }
+
+    if (final && blocks != cp.blocks) {
+        fprintf(stderr, "%s: only %lu of %lu journal blocks are valid\n", path,
+                (unsigned long)blocks, (unsigned long)cp.blocks);
+    } else if (!final) {
+        fprintf(stderr, "%s: log was not closed, using its %lu valid blocks\n", path, (unsigned long)blocks);
+    }
+    if (info) {
+        printf("journal: session %08lx, %s, %lu blocks, %llu bytes of log, checkpoint %lu blocks\n",
+               (unsigned long)session, journal_state(cp.state), (unsigned long)blocks, payload,
+               (unsigned long)cp.blocks);
+    }
+    rewind(out);
+    return out;
+}
+
+int main(int argc, char **argv) {
+    bool info = false;
+    const char *path = NULL;
+    bool usage = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--info")) info = true;
+        else if (!path) path = argv[i];
+        else usage = true;
+    }
+    if (!path || usage) {
+        fprintf(stderr, "usage: %s [--info] session.bin > session.csv\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    char magic[4];
+    if (fread(magic, 1, sizeof magic, in) == sizeof magic && !memcmp(magic, LOG_JOURNAL_MAGIC, 4)) {
+        rewind(in);
+        FILE *plain = unwrap_journal(in, path, info);
+        fclose(in);
+        if (!plain) return 1;
+        in = plain;
+    } else {
+        rewind(in);
+    }
+    imu_log_header_t h;
+    if (!read_header(in, path, &h)) {
+        fclose(in);
+        return 1;
+    }
+
+    if (info) {
+        printf("version %u, %u Hz, win %u ms, hop %u ms, %u-byte records, codec %u, %u fields:\n",
+               (unsigned)h.version, (unsigned)h.sample_hz, (unsigned)h.win_ms, (unsigned)h.hop_ms,
+               (unsigned)h.record_bytes, (unsigned)h.codec, (unsigned)h.n_fields);
+        for (unsigned i = 0; i < h.n_fields; i++) {
+            printf("  %-12s type=%u offset=%u decimals=%u\n", h.field[i].name,
+                   (unsigned)h.field[i].type, (unsigned)h.field[i].offset, (unsigned)h.field[i].decimals);
+        }
+    } else {
+        for (unsigned i = 0; i < h.n_fields; i++) {
+            printf(i ? ",%s" : "%s", h.field[i].name);
+        }
+        putchar('\n');
+    }
+
+    // A log cut off by power loss keeps its preallocated size; the tail is
+    // stale card data, recognised by the timestamp no longer increasing
+    // (t_ms, or t_us of a raw log, compared modulo 2^32 since it wraps).
+    int t_field = -1;
+    for (unsigned i = 0; i < h.n_fields; i++) {
+        if ((!strcmp(h.field[i].name, "t_ms") || !strcmp(h.field[i].name, "t_us")) &&
+            h.field[i].type == IMU_LOG_U32) t_field = (int)i;
+    }
+    uint32_t last_t = 0;
+
+    uint8_t *rec = malloc(h.record_bytes);
+    if (!rec) {
+        fclose(in);
+        return 1;
+    }
+    record_reader_t reader = { .in = in, .path = path, .h = &h };
+    size_t n_rec = 0;
+    while (next_record(&reader, rec)) {
+        if (t_field >= 0) {
+            const uint32_t t = rd32(rec + h.field[t_field].offset);
+            if (n_rec > 0 && (int32_t)(t - last_t) <= 0) {
+                fprintf(stderr, "%s: %s goes back after record %zu, ignoring the rest (unclosed log?)\n",
+                        path, h.field[t_field].name, n_rec);
+                break;
+            }
+            last_t = t;
+        }
+        n_rec++;
+        if (info) continue;
+        for (unsigned i = 0; i < h.n_fields; i++) {
+            if (i) putchar(',');
+            print_field(stdout, &h.field[i], rec);
+        }
+        putchar('\n');
+    }
+    if (info && h.codec == IMU_LOG_CODEC_DELTA_VARINT) {
+        const size_t packed = reader.sectors * RAW_CODEC_SECTOR_BYTES;
+        printf("%zu records in %zu delta/varint sectors: %.2f bytes/record, ratio %.2f\n",
+               n_rec, reader.sectors, n_rec ? (double)packed / (double)n_rec : 0.0,
+               packed ? (double)(n_rec * h.record_bytes) / (double)packed : 0.0);
+    } else if (info) {
+        printf("%zu records\n", n_rec);
+    }
+
+    free(rec);
+    fclose(in);
+    return 0;
+}
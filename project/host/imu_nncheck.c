@@ -0,0 +1,284 @@
+// project/host/imu_nncheck.c
+//
+// Checks the int8 runtime (src/nn_int8.c) bit for bit and times it:
+//   - src/gesture_nn.h on the inputs whose outputs export_nn.py computed with
+//     its own integer model,
+//   - random dense / conv stacks against the straightforward reference below
+//     (separate buffers, int64 accumulation, requantization by division),
+//     with guard bytes around the arena,
+//   - nn_quantize_q7() against quantize_bits() of lab_algorithms,
+// then reports ns and cycles (x86 TSC) per inference for the shipped model
+// and a raw-window 1D-CNN, and how often the shipped model agrees with
+// classify_rules() on synthetic windows. Exits non-zero on any mismatch.
+//
+//   ./build-host/imu_nncheck [--models N] [--iters N]
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NNCHECK_HAVE_TSC 1
+#else
+#define NNCHECK_HAVE_TSC 0
+#endif
+
+#include "nn_int8.h"
+#include "gesture_nn.h"
+#include "classifier.h"
+
+enum { MAX_LAYERS = 4, MAX_ACT = 1024, GUARD = 64 };
+
+static uint32_t g_lcg = 12345u;
+static uint32_t rnd(void) { g_lcg = g_lcg * 1664525u + 1013904223u; return g_lcg >> 8; }
+static int rnd_in(int lo, int hi) { return lo + (int)(rnd() % (uint32_t)(hi - lo + 1)); }
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t read_cycles(void) {
+#if NNCHECK_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// -------------------- Reference ------------------------------
+static int8_t ref_requantize(int32_t acc, const nn_layer_t *l) {
+    const int64_t num = (int64_t)acc * l->mult + ((int64_t)1 << (l->shift - 1));
+    const int64_t den = (int64_t)1 << l->shift;
+    int64_t q = num / den;
+    if (num % den != 0 && num < 0) q--;    // floor
+    int64_t v = q + l->out_zp;
+    if (l->relu && v < l->out_zp) v = l->out_zp;
+    return (int8_t)(v < -128 ? -128 : v > 127 ? 127 : v);
+}
+
+static void ref_run(const nn_model_t *m, const int8_t *input, int8_t *output) {
+    static int8_t act[MAX_LAYERS + 1][MAX_ACT];
+    memcpy(act[0], input, m->n_in);
+    for (unsigned i = 0; i < m->n_layers; i++) {
+        const nn_layer_t *l = &m->layers[i];
+        for (int t = 0; t < l->out_len; t++) {
+            for (int o = 0; o < l->out_ch; o++) {
+                int64_t acc = l->bias[o];
+                for (int k = 0; k < l->kernel; k++) {
+                    for (int c = 0; c < l->in_ch; c++) {
+                        const int x = act[i][(t * l->stride + k) * l->in_ch + c];
+                        acc += (int64_t)l->w[(o * l->kernel + k) * l->in_ch + c] * x;
+                    }
+                }
+                act[i + 1][t * l->out_ch + o] = ref_requantize((int32_t)acc, l);
+            }
+        }
+    }
+    const nn_layer_t *last = &m->layers[m->n_layers - 1];
+    memcpy(output, act[m->n_layers], (size_t)last->out_len * last->out_ch);
+}
+
+// -------------------- Random models --------------------------
+typedef struct {
+    nn_layer_t layers[MAX_LAYERS];
+    int8_t w[MAX_LAYERS][64 * 16 * 16];   // longest dense layer
+    int32_t bias[MAX_LAYERS][64];
+    nn_model_t model;
+} rand_model_t;
+
+static void random_model(rand_model_t *r) {
+    int len = rnd_in(1, 64), ch = rnd_in(1, 8);
+    const int n_layers = rnd_in(1, MAX_LAYERS);
+    int arena = 0, n_in = len * ch;
+    for (int i = 0; i < n_layers; i++) {
+        nn_layer_t *l = &r->layers[i];
+        const bool dense = (i == n_layers - 1) || len == 1 || rnd() % 3 == 0;
+        l->op = dense ? NN_DENSE : NN_CONV1D;
+        l->in_len = (uint16_t)len;
+        l->in_ch = (uint16_t)ch;
+        l->kernel = (uint16_t)(dense ? len : rnd_in(1, len < 7 ? len : 7));
+        l->stride = (uint16_t)(dense ? 1 : rnd_in(1, 3));
+        l->out_len = (uint16_t)((len - l->kernel) / l->stride + 1);
+        l->out_ch = (uint16_t)rnd_in(1, 16);
+        for (int k = 0; k < l->out_ch * l->kernel * l->in_ch; k++) r->w[i][k] = (int8_t)rnd_in(-127, 127);
+        for (int o = 0; o < l->out_ch; o++) r->bias[i][o] = rnd_in(-(1 << 20), 1 << 20);
+        l->w = r->w[i];
+        l->bias = r->bias[i];
+        l->mult = (int32_t)((1u << 30) + rnd() % (1u << 30));
+        l->shift = (uint8_t)rnd_in(8, 40);   // small shifts leave results past int32
+        l->out_zp = (int8_t)rnd_in(-128, 127);
+        l->relu = (uint8_t)(rnd() & 1u);
+        const int out = l->out_len * l->out_ch;
+        if (len * ch + out > arena) arena = len * ch + out;
+        len = l->out_len;
+        ch = l->out_ch;
+    }
+    r->model = (nn_model_t){ r->layers, (uint8_t)n_layers, (uint16_t)n_in, (uint16_t)(len * ch),
+                             (uint16_t)arena, 1.0f, 0, 1.0f, 0 };
+}
+
+// Runs nn_run() inside guard bytes and compares with ref_run().
+static bool check_model(const nn_model_t *m, const int8_t *input, const int8_t *want) {
+    static int8_t buf[GUARD + MAX_ACT * 2 + GUARD];
+    int8_t ref[MAX_ACT];
+    memset(buf, 0x5A, sizeof buf);
+    int8_t *arena = buf + GUARD;
+    memcpy(nn_input(m, arena), input, m->n_in);
+    const int8_t *out = nn_run(m, arena);
+    if (!want) {
+        ref_run(m, input, ref);
+        want = ref;
+    }
+    bool ok = memcmp(out, want, m->n_out) == 0;
+    for (int i = 0; i < GUARD; i++) {
+        ok = ok && buf[i] == 0x5A && arena[m->arena_bytes + i] == 0x5A;
+    }
+    return ok;
+}
+
+// -------------------- quantize_bits --------------------------
+// lab_algorithms/quantization.c, bits = 8.
+static int8_t quantize_bits_q7(float x) {
+    const float hi = 127.0f / 128.0f;
+    const float s = (x < -1.0f) ? -1.0f : (x > hi) ? hi : x;
+    int32_t q = (int32_t)lrintf(s * 128.0f);
+    if (q > 127) q = 127;
+    if (q < -128) q = -128;
+    return (int8_t)q;
+}
+
+// -------------------- Timing ---------------------------------
+static void time_model(const char *name, const nn_model_t *m, int iters) {
+    static int8_t arena[MAX_ACT * 2];
+    int8_t *in = nn_input(m, arena);
+    volatile int sink = 0;
+    uint64_t best_ns = UINT64_MAX, best_cyc = UINT64_MAX;
+    for (int rep = 0; rep < 5; rep++) {
+        const uint64_t t0 = now_ns(), c0 = read_cycles();
+        for (int i = 0; i < iters; i++) {
+            in[i % m->n_in] = (int8_t)i;
+            sink += nn_run(m, arena)[0];
+        }
+        const uint64_t ns = now_ns() - t0, cyc = read_cycles() - c0;
+        if (ns < best_ns) best_ns = ns;
+        if (cyc < best_cyc) best_cyc = cyc;
+    }
+    (void)sink;
+    printf("%-12s %6u MACs  arena %4u B  %8.1f ns/inference", name, (unsigned)nn_macs(m),
+           (unsigned)m->arena_bytes, (double)best_ns / iters);
+    if (NNCHECK_HAVE_TSC) printf("  %8.0f cycles/inference", (double)best_cyc / iters);
+    printf("\n");
+}
+
+// 100 samples x 6 channels -> conv 8 k5/s2 -> conv 16 k5/s2 -> dense 4.
+static void window_cnn(rand_model_t *r) {
+    static const struct { uint8_t op; uint16_t kernel, stride, out_ch; } kShape[] = {
+        { NN_CONV1D, 5, 2, 8 }, { NN_CONV1D, 5, 2, 16 }, { NN_DENSE, 0, 1, 4 },
+    };
+    int len = 100, ch = 6, arena = 0;
+    for (int i = 0; i < 3; i++) {
+        nn_layer_t *l = &r->layers[i];
+        *l = (nn_layer_t){ r->w[i], r->bias[i], 1518500250, 40, -128, 1, kShape[i].op,
+                           (uint16_t)len, (uint16_t)ch, kShape[i].kernel ? kShape[i].kernel : (uint16_t)len,
+                           kShape[i].stride, 0, kShape[i].out_ch };
+        l->out_len = (uint16_t)((len - l->kernel) / l->stride + 1);
+        for (int k = 0; k < l->out_ch * l->kernel * l->in_ch; k++) r->w[i][k] = (int8_t)rnd_in(-127, 127);
+        for (int o = 0; o < l->out_ch; o++) r->bias[i][o] = rnd_in(-1000, 1000);
+        if (len * ch + l->out_len * l->out_ch > arena) arena = len * ch + l->out_len * l->out_ch;
+        len = l->out_len;
+        ch = l->out_ch;
+    }
+    r->layers[2].relu = 0;
+    r->model = (nn_model_t){ r->layers, 3, 600, (uint16_t)(len * ch), (uint16_t)arena,
+                             1.0f / 128.0f, 0, 1.0f, 0 };
+}
+
+int main(int argc, char **argv) {
+    int n_models = 2000, iters = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--models") && i + 1 < argc) {
+            n_models = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--iters") && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--models N] [--iters N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iters < 1) iters = 1;
+    int failed = 0;
+
+    // ---- gesture_nn.h against export_nn.py ----
+    int bad = 0;
+    for (int t = 0; t < GESTURE_NN_N_TESTS; t++) {
+        if (!check_model(&kGestureNn, kGestureNnTestIn[t], kGestureNnTestOut[t])) bad++;
+    }
+    printf("gesture_nn.h  %d/%d reference outputs exact  %s\n",
+           GESTURE_NN_N_TESTS - bad, GESTURE_NN_N_TESTS, bad ? "FAIL" : "OK");
+    failed += bad != 0;
+
+    // ---- random models against ref_run() ----
+    static rand_model_t r;
+    int8_t input[MAX_ACT];
+    bad = 0;
+    for (int i = 0; i < n_models; i++) {
+        random_model(&r);
+        for (int rep = 0; rep < 4; rep++) {
+            for (int k = 0; k < r.model.n_in; k++) input[k] = (int8_t)rnd_in(-128, 127);
+            if (!check_model(&r.model, input, NULL)) {
+                if (bad++ < 5) fprintf(stderr, "  random model %d: mismatch\n", i);
+            }
+        }
+    }
+    printf("random models %d x 4 inputs, %d mismatch(es)  %s\n", n_models, bad, bad ? "FAIL" : "OK");
+    failed += bad != 0;
+
+    // ---- nn_quantize_q7() against quantize_bits() ----
+    bad = 0;
+    for (int i = 0; i < 200000; i++) {
+        const float x = (i < 8) ? (float[]){ -2.0f, -1.0f, -0.00390625f, 0.0f, 0.99f, 0.99609375f, 1.0f, 3.0f }[i]
+                                : ((float)rnd() / 16777216.0f - 0.5f) * 2.5f;
+        int8_t q;
+        nn_quantize_q7(&x, 1, 1.0f, &q, 1);
+        if (q != quantize_bits_q7(x)) bad++;
+    }
+    printf("nn_quantize_q7 vs quantize_bits, %d mismatch(es)  %s\n", bad, bad ? "FAIL" : "OK");
+    failed += bad != 0;
+
+#if GESTURE_NN_INPUT == NN_INPUT_FEATURES
+    // ---- agreement with classify_rules() ----
+    int agree = 0, n_windows = 20000;
+    static int8_t arena[GESTURE_NN_ARENA_BYTES];
+    for (int i = 0; i < n_windows; i++) {
+        feat_vec_t f;
+        memset(&f, 0, sizeof f);
+        f.amag.std = powf(10.0f, -2.5f + 2.5f * (float)rnd() / 16777216.0f);
+        f.amag.dom_freq = 5.0f * (float)rnd() / 16777216.0f;
+        f.gx_std = powf(10.0f, -0.5f + 2.5f * (float)rnd() / 16777216.0f);
+        f.gy_std = powf(10.0f, -0.5f + 2.5f * (float)rnd() / 16777216.0f);
+        f.gz_std = powf(10.0f, -0.5f + 2.5f * (float)rnd() / 16777216.0f);
+        uint8_t u8[8];
+        int n = 0;
+        quantize_features_u8(&f, u8, &n);
+        int8_t *in = nn_input(&kGestureNn, arena);
+        for (int k = 0; k < n; k++) in[k] = (int8_t)(u8[k] - 128);
+        agree += nn_argmax(nn_run(&kGestureNn, arena), kGestureNn.n_out) == classify_rules(&f);
+    }
+    printf("gesture_nn.h agrees with classify_rules() on %.1f%% of %d synthetic windows\n",
+           100.0 * agree / n_windows, n_windows);
+#endif
+
+    // ---- timing ----
+    time_model("gesture_nn", &kGestureNn, iters);
+    window_cnn(&r);
+    time_model("window_cnn", &r.model, iters / 10 + 1);
+
+    if (failed) fprintf(stderr, "%d check(s) failed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,229 @@
+// project/host/imu_qreport.c
+//
+// Accuracy and speed of the integer pipeline (compute_features_q15) against
+// the float reference. Both paths see the same raw int16 samples: either a
+// recorded CSV converted back to counts with ACCEL_SCALE_G/GYRO_SCALE_DPS, or
+// a synthetic session with still/shake/tilt/circle segments.
+//
+// The reference is the firmware float path (compute_features, default
+// Goertzel back-end). The Q15 spectrum evaluates the same bins, so the
+// differences are quantization error only.
+//
+// Host timings only show the cost on a CPU with an FPU, where the float path
+// is faster. On the Cortex-M0+ every float op is a soft-float call; measure
+// there with the firmware's lat_ms column (USE_FIXED_POINT=1 vs 0).
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "config.h"
+#include "features.h"
+#include "features_q15.h"
+#include "classifier.h"
+#include "session_csv.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum { N_FEAT = 10 };
+static const char *kFeatNames[N_FEAT] = {
+    "amag_mean", "amag_std", "amag_rms", "energy", "dom_freq",
+    "bp1", "bp2", "gx_std", "gy_std", "gz_std",
+};
+
+typedef struct {
+    double abs_sum[N_FEAT], abs_max[N_FEAT], ref_sum[N_FEAT];
+    size_t dom_match, cls_match, n;
+} err_acc_t;
+
+// -------------------- Helpers -------------------------------
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int16_t to_counts(float v, float scale) {
+    long q = lrintf(v / scale);
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (int16_t)q;
+}
+
+static void feat_to_array(const feat_vec_t *f, double *v) {
+    v[0] = f->amag.mean;  v[1] = f->amag.std; v[2] = f->amag.rms; v[3] = f->amag.energy;
+    v[4] = f->amag.dom_freq; v[5] = f->amag.bp1; v[6] = f->amag.bp2;
+    v[7] = f->gx_std; v[8] = f->gy_std; v[9] = f->gz_std;
+}
+
+static void err_add(err_acc_t *e, const feat_vec_t *ref, const feat_vec_t *q) {
+    double r[N_FEAT], t[N_FEAT];
+    feat_to_array(ref, r);
+    feat_to_array(q, t);
+    for (int i = 0; i < N_FEAT; i++) {
+        const double d = fabs(r[i] - t[i]);
+        e->abs_sum[i] += d;
+        e->ref_sum[i] += fabs(r[i]);
+        if (d > e->abs_max[i]) e->abs_max[i] = d;
+    }
+    if (ref->amag.dom_freq == q->amag.dom_freq) e->dom_match++;
+    if (classify(ref) == classify(q)) e->cls_match++;
+    e->n++;
+}
+
+// Synthetic raw session: 3 s segments of still / shake / tilt / circle, with
+// per-axis sensor offsets. The bias is what main.c's calibration would find
+// at rest (offset + 1 g on z), so gravity is removed the same way.
+static size_t make_synthetic(float fs_hz, int16_t *raw[6], size_t cap, int16_t bias[6]) {
+    const int16_t offset[6] = { 120, -85, 40, 12, -30, 7 };
+    for (int c = 0; c < 6; c++) bias[c] = offset[c];
+    bias[2] = (int16_t)(bias[2] + lrintf(1.0f / ACCEL_SCALE_G));
+
+    uint32_t lcg = 2024u;
+    const size_t n = cap;
+    for (size_t i = 0; i < n; i++) {
+        const float t = (float)i / fs_hz;
+        const int seg = (int)(t / 3.0f) % 4;
+        lcg = lcg * 1664525u + 1013904223u;
+        const float noise = ((float)(lcg >> 8) / 16777216.0f - 0.5f) * 0.004f;
+
+        float ax = 0.0f, ay = 0.0f, az = 1.0f, gx = 0.0f, gy = 0.0f, gz = 0.0f;
+        if (seg == 1) {            // shake: 5 Hz along x
+            ax = 0.6f * sinf(2.0f * (float)M_PI * 5.0f * t);
+            gz = 40.0f * sinf(2.0f * (float)M_PI * 5.0f * t);
+        } else if (seg == 2) {     // tilt: slow 0.7 Hz rocking about y
+            const float a = 0.5f * sinf(2.0f * (float)M_PI * 0.7f * t);
+            ax = sinf(a); az = cosf(a);
+            gy = 0.5f * 2.0f * (float)M_PI * 0.7f * cosf(2.0f * (float)M_PI * 0.7f * t) * 57.3f;
+        } else if (seg == 3) {     // circle: 1.5 Hz in the x/y plane
+            ax = 0.3f * cosf(2.0f * (float)M_PI * 1.5f * t);
+            ay = 0.3f * sinf(2.0f * (float)M_PI * 1.5f * t);
+            gx = 30.0f * sinf(2.0f * (float)M_PI * 1.5f * t);
+            gy = 30.0f * cosf(2.0f * (float)M_PI * 1.5f * t);
+        }
+        const float v[6] = { ax + noise, ay - noise, az + noise, gx + 200.0f * noise, gy, gz };
+        for (int c = 0; c < 6; c++) {
+            const float sc = (c < 3) ? ACCEL_SCALE_G : GYRO_SCALE_DPS;
+            raw[c][i] = (int16_t)(to_counts(v[c], sc) + offset[c]);
+        }
+    }
+    return n;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [--fs HZ] [--win MS] [--hop MS] [log.csv]\n"
+            "  without a CSV a 60 s synthetic session is generated\n",
+            argv0);
+}
+
+// -------------------- main ----------------------------------
+int main(int argc, char **argv) {
+    float fs_hz = (float)SAMPLE_HZ;
+    int win_ms = WIN_MS;
+    int hop_ms = HOP_MS;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--fs") && i + 1 < argc)       fs_hz = strtof(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--win") && i + 1 < argc) win_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--hop") && i + 1 < argc) hop_ms = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !path)                path = argv[i];
+        else { usage(argv[0]); return 2; }
+    }
+
+    const int win = (int)(fs_hz * (float)win_ms / 1000.0f);
+    const int hop = (int)(fs_hz * (float)hop_ms / 1000.0f);
+    if (win < 2 || win > 2048 || hop < 1) {
+        fprintf(stderr, "invalid window/hop: win=%d hop=%d samples\n", win, hop);
+        return 2;
+    }
+
+    // ---- raw int16 input ----
+    int16_t *raw[6];
+    int16_t bias[6] = {0};
+    size_t n = 0;
+    if (path) {
+        sample_buf_t rec = {0};
+        if (!session_csv_load(path, &rec)) return 1;
+        n = rec.n;
+        for (int c = 0; c < 6; c++) raw[c] = malloc((n ? n : 1) * sizeof(int16_t));
+        for (size_t i = 0; i < n; i++) {
+            const sample_t *s = &rec.v[i];
+            raw[0][i] = to_counts(s->ax, ACCEL_SCALE_G);
+            raw[1][i] = to_counts(s->ay, ACCEL_SCALE_G);
+            raw[2][i] = to_counts(s->az, ACCEL_SCALE_G);
+            raw[3][i] = to_counts(s->gx, GYRO_SCALE_DPS);
+            raw[4][i] = to_counts(s->gy, GYRO_SCALE_DPS);
+            raw[5][i] = to_counts(s->gz, GYRO_SCALE_DPS);
+        }
+        session_csv_free(&rec);
+    } else {
+        n = (size_t)(60.0f * fs_hz);
+        for (int c = 0; c < 6; c++) raw[c] = malloc(n * sizeof(int16_t));
+        make_synthetic(fs_hz, raw, n, bias);
+    }
+    if (n < (size_t)win) {
+        fprintf(stderr, "need at least one window (%d samples), got %zu\n", win, n);
+        return 1;
+    }
+
+    const featq_cfg_t cfg = {
+        .accel_bias = { bias[0], bias[1], bias[2] },
+        .gyro_bias  = { bias[3], bias[4], bias[5] },
+        .accel_scale = ACCEL_SCALE_G,
+        .gyro_scale  = GYRO_SCALE_DPS,
+    };
+
+    // float inputs see exactly the same quantized, bias-corrected values
+    float *fwin = malloc((size_t)win * 6 * sizeof(float));
+    err_acc_t e_ref = {0};
+    uint64_t ns_ref = 0, ns_q = 0;
+
+    for (size_t start = 0; start + (size_t)win <= n; start += (size_t)hop) {
+        for (int c = 0; c < 6; c++) {
+            const float sc = (c < 3) ? ACCEL_SCALE_G : GYRO_SCALE_DPS;
+            for (int i = 0; i < win; i++) {
+                fwin[c * win + i] = (float)((int32_t)raw[c][start + (size_t)i] - bias[c]) * sc;
+            }
+        }
+        const float *f[6];
+        const int16_t *q[6];
+        for (int c = 0; c < 6; c++) { f[c] = &fwin[c * win]; q[c] = &raw[c][start]; }
+
+        feat_vec_t fr, fq;
+        uint64_t t0 = now_ns();
+        compute_features(f[0], f[1], f[2], f[3], f[4], f[5], win, fs_hz, &fr);
+        uint64_t t1 = now_ns();
+        compute_features_q15(q[0], q[1], q[2], q[3], q[4], q[5], win, fs_hz, &cfg, &fq);
+        uint64_t t2 = now_ns();
+        ns_ref += t1 - t0; ns_q += t2 - t1;
+
+        err_add(&e_ref, &fr, &fq);
+    }
+
+    // -------------------- report --------------------
+    printf("qreport: %s, %zu windows, win=%d hop=%d fs=%.1f Hz\n",
+           path ? path : "synthetic", e_ref.n, win, hop, (double)fs_hz);
+    printf("%-10s | %11s %11s %10s   (vs compute_features)\n", "feature", "mean_abs", "max_abs", "rel_err%");
+    for (int i = 0; i < N_FEAT; i++) {
+        const err_acc_t *a = &e_ref;
+        printf("%-10s | %11.3g %11.3g %10.4f\n", kFeatNames[i],
+               a->abs_sum[i] / (double)a->n, a->abs_max[i],
+               a->ref_sum[i] > 0.0 ? 100.0 * a->abs_sum[i] / a->ref_sum[i] : 0.0);
+    }
+    printf("dom_freq identical : %6.2f%%\n", 100.0 * (double)e_ref.dom_match / (double)e_ref.n);
+    printf("class agreement    : %6.2f%%\n", 100.0 * (double)e_ref.cls_match / (double)e_ref.n);
+    printf("host ns/window     : float %.0f, q15 %.0f (host FPU; not the RP2040 ratio)\n",
+           (double)ns_ref / (double)e_ref.n, (double)ns_q / (double)e_ref.n);
+
+    free(fwin);
+    for (int c = 0; c < 6; c++) free(raw[c]);
+    return 0;
+}
@@ -0,0 +1,240 @@
+// project/host/imu_replay.c
+//
+// Feed a recorded session through the firmware feature/classifier path on the
+// host and report per-window latency and throughput.
+//
+// Input: the t_ms,ax,ay,az,gx,gy,gz rows of a LOG_RAW capture (e.g. from
+// tools/log_pico.sh). Only seven-column rows are read, so the per-window
+// feature rows of the same log, headers and GESTURE:/WARN: lines are skipped.
+// Output: one CSV_HEADER row per window on stdout (same layout as the firmware
+// printf), summary on stderr. lat_ms is all the engine's work for the window:
+// with --stream that includes the feat_stream pushes of the samples since the
+// previous window. --gate runs
+// the staged path of MOTION_GATE and reports how often each stage ran; --fx
+// appends the extended features of src/feat_ext.h selected by a mask.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "features.h"
+#include "feat_stream.h"
+#include "feat_ext.h"
+#include "classifier.h"
+#include "session_csv.h"
+
+// -------------------- Helpers -------------------------------
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [--fs HZ] [--win MS] [--hop MS] [--stream] [--gate] [--fx MASK] [--quiet] <log.csv>\n"
+            "  --fs      sample rate of the recording (default SAMPLE_HZ=%d)\n"
+            "  --win     window length in ms (default WIN_MS=%d)\n"
+            "  --hop     hop length in ms (default HOP_MS=%d)\n"
+            "  --stream  use the incremental feat_stream engine instead of compute_features\n"
+            "  --gate    skip the spectrum and classifier for idle windows (MOTION_GATE)\n"
+            "  --fx      append the FX_* feature groups in MASK (e.g. 0x1f: all)\n"
+            "  --quiet   only print the summary\n",
+            argv0, SAMPLE_HZ, WIN_MS, HOP_MS);
+}
+
+// -------------------- main ----------------------------------
+int main(int argc, char **argv) {
+    float fs_hz = (float)SAMPLE_HZ;
+    int win_ms = WIN_MS;
+    int hop_ms = HOP_MS;
+    bool use_stream = false;
+    bool use_gate = false;
+    uint32_t fx_mask = 0;
+    bool quiet = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--fs") && i + 1 < argc)       fs_hz = strtof(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--win") && i + 1 < argc) win_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--hop") && i + 1 < argc) hop_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--stream"))              use_stream = true;
+        else if (!strcmp(argv[i], "--gate"))                use_gate = true;
+        else if (!strcmp(argv[i], "--fx") && i + 1 < argc)  fx_mask = (uint32_t)strtoul(argv[++i], NULL, 0) & FX_ALL;
+        else if (!strcmp(argv[i], "--quiet"))               quiet = true;
+        else if (argv[i][0] != '-' && !path)                path = argv[i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (!path) { usage(argv[0]); return 2; }
+
+    const int win = (int)(fs_hz * (float)win_ms / 1000.0f);
+    const int hop = (int)(fs_hz * (float)hop_ms / 1000.0f);
+    if (win < 2 || hop < 1 || (use_stream && win > FEAT_STREAM_MAX_SAMPLES) ||
+        (fx_mask && win > FX_MAX_SAMPLES)) {
+        fprintf(stderr, "invalid window/hop: win=%d hop=%d samples\n", win, hop);
+        return 2;
+    }
+
+    sample_buf_t rec = {0};
+    if (!session_csv_load(path, &rec)) return 1;
+    if (rec.n < (size_t)win) {
+        fprintf(stderr, "%s: %zu samples, need at least one window (%d)\n", path, rec.n, win);
+        session_csv_free(&rec);
+        return 1;
+    }
+
+    // six rings mirrored like main.c's: each sample stored twice, win apart,
+    // so the window is contiguous from ring_index and read in place
+    float *ring = calloc((size_t)win * 12, sizeof(float));
+    uint64_t *lat_ns = malloc((rec.n / (size_t)hop + 1) * sizeof(uint64_t));
+    static feat_stream_t stream;
+    if (!ring || !lat_ns) { fprintf(stderr, "out of memory\n"); return 1; }
+    if (use_stream && !feat_stream_init(&stream, win, fs_hz)) {
+        fprintf(stderr, "--stream: %d samples at %.0f Hz need more than %d DFT bins\n",
+                win, (double)fs_hz, FEAT_STREAM_MAX_BINS);
+        return 2;
+    }
+
+    static fx_window_t fx_win;
+    static float fx_buf[FX_WINDOW_FLOATS(FX_MAX_SAMPLES)];
+    fx_window_init(&fx_win, win, fx_buf);
+    const int n_fx = fx_count(fx_mask);
+    uint64_t fx_ns = 0;
+
+    if (!quiet) {
+        printf(CSV_HEADER);
+        for (int k = 0; k < n_fx; k++) printf(",%s", fx_name(fx_mask, k));
+        printf("\n");
+    }
+
+    size_t n_win = 0;
+    int ring_index = 0, ring_filled = 0, hop_accum = 0;
+    uint64_t push_ns = 0, push_total_ns = 0;   // --stream: pushes since the last window, all pushes
+    int cls_count[4] = {0};
+    const feat_gate_t gate_cfg = { FEAT_GATE_AMAG_STD, FEAT_GATE_GYRO_STD_DPS };
+    const feat_gate_t *gate = use_gate ? &gate_cfg : NULL;
+    feat_stage_counts_t stages = {0};
+    const uint64_t t_begin = now_ns();
+
+    for (size_t i = 0; i < rec.n; i++) {
+        const sample_t *s = &rec.v[i];
+        hop_accum++;
+
+        feat_vec_t feat;
+        uint64_t t0;
+        bool moving;
+        if (fx_mask) fx_window_push(&fx_win, s->ax, s->ay, s->az, s->gx, s->gy, s->gz);
+        if (use_stream) {
+            const uint64_t tp = now_ns();
+            feat_stream_push(&stream, s->ax, s->ay, s->az, s->gx, s->gy, s->gz);
+            const uint64_t dp = now_ns() - tp;
+            push_ns += dp;
+            push_total_ns += dp;
+            if (!feat_stream_ready(&stream)) push_ns = 0;   // filling: no window pays for it
+            if (!feat_stream_ready(&stream) || hop_accum < hop) continue;
+
+            t0 = now_ns() - push_ns;
+            push_ns = 0;
+            moving = feat_stream_get_gated(&stream, gate, &stages, &feat);
+        } else {
+            const float x[6] = { s->ax, s->ay, s->az, s->gx, s->gy, s->gz };
+            for (int c = 0; c < 6; c++) ring[c * 2 * win + ring_index] = ring[c * 2 * win + ring_index + win] = x[c];
+            if (++ring_index >= win) ring_index = 0;
+            if (ring_filled < win) ring_filled++;
+            if (ring_filled < win || hop_accum < hop) continue;
+
+            // ring_index is the oldest sample = start of the logical window
+            const float *w0 = &ring[ring_index];
+            t0 = now_ns();
+            moving = compute_features_gated(w0, w0 + 2 * win, w0 + 4 * win, w0 + 6 * win, w0 + 8 * win,
+                                            w0 + 10 * win, win, fs_hz, gate, &stages, &feat);
+        }
+        hop_accum = 0;
+
+        const int cls = moving ? classify(&feat) : G_NONE;
+        const uint64_t dt = now_ns() - t0;
+        lat_ns[n_win++] = dt;
+        if (cls >= 0 && cls < 4) cls_count[cls]++;
+
+        if (!quiet) {
+            printf("%lu,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%d,%.3f,%d",
+                   (unsigned long)s->t_ms,
+                   s->ax, s->ay, s->az, s->gx, s->gy, s->gz,
+                   feat.amag.mean, feat.amag.std, feat.amag.rms, feat.amag.energy,
+                   feat.amag.dom_freq, feat.amag.bp1, feat.amag.bp2,
+                   feat.gx_std, feat.gy_std, feat.gz_std,
+                   feat.d_pitch_std, feat.d_roll_std,
+                   cls, (double)dt / 1e6, 0);
+        }
+        if (fx_mask) {
+            float fx[FX_MAX_OUTPUTS];
+            const uint64_t t_fx = now_ns();
+            fx_compute(fx_mask, fx_window_channel(&fx_win, 0), fx_window_channel(&fx_win, 1),
+                       fx_window_channel(&fx_win, 2), fx_window_channel(&fx_win, 3),
+                       fx_window_channel(&fx_win, 4), fx_window_channel(&fx_win, 5), win, fs_hz, fx);
+            fx_ns += now_ns() - t_fx;
+            if (!quiet) {
+                for (int k = 0; k < n_fx; k++) printf(",%.5f", fx[k]);
+                printf("\n");
+            }
+        } else if (!quiet) {
+            printf("\n");
+        }
+    }
+
+    const double total_s = (double)(now_ns() - t_begin) / 1e9;
+
+    // -------------------- summary --------------------
+    qsort(lat_ns, n_win, sizeof(lat_ns[0]), cmp_u64);
+    double lat_sum = 0.0;
+    for (size_t i = 0; i < n_win; i++) lat_sum += (double)lat_ns[i];
+
+    const double rec_s = rec.n > 1 ? (double)(rec.v[rec.n - 1].t_ms - rec.v[0].t_ms) / 1000.0 : 0.0;
+    fprintf(stderr, "replay: %s\n", path);
+    fprintf(stderr, "  engine      : %s\n", use_stream ? "feat_stream" : "compute_features");
+    fprintf(stderr, "  samples     : %zu (%.1f s recorded, fs=%.1f Hz, est. %.1f Hz from t_ms)\n",
+            rec.n, rec_s, fs_hz, rec_s > 0.0 ? (double)(rec.n - 1) / rec_s : 0.0);
+    fprintf(stderr, "  window/hop  : %d/%d samples\n", win, hop);
+    fprintf(stderr, "  windows     : %zu  (NONE=%d SHAKE=%d TILT=%d CIRCLE=%d)\n",
+            n_win, cls_count[G_NONE], cls_count[G_SHAKE], cls_count[G_TILT], cls_count[G_CIRCLE]);
+    if (use_gate) {
+        fprintf(stderr, "  stages      : gyro_range=%lu gyro_std=%lu spectral=%lu (%.1f%% idle)\n",
+                (unsigned long)stages.gyro_range, (unsigned long)stages.gyro_std,
+                (unsigned long)stages.spectral,
+                stages.windows ? 100.0 * (stages.windows - stages.spectral) / stages.windows : 0.0);
+    }
+    if (n_win > 0) {
+        fprintf(stderr, "  latency us  : mean=%.2f p50=%.2f p95=%.2f p99=%.2f max=%.2f\n",
+                lat_sum / (double)n_win / 1e3,
+                (double)lat_ns[n_win / 2] / 1e3,
+                (double)lat_ns[(n_win * 95) / 100] / 1e3,
+                (double)lat_ns[(n_win * 99) / 100] / 1e3,
+                (double)lat_ns[n_win - 1] / 1e3);
+    }
+    if (use_stream) {
+        fprintf(stderr, "  push        : %.1f ns/sample (in the latency above)\n",
+                (double)push_total_ns / (double)rec.n);
+    }
+    if (fx_mask && n_win > 0) {
+        fprintf(stderr, "  fx          : mask 0x%02lx, %d outputs, mean %.2f us/window\n",
+                (unsigned long)fx_mask, n_fx, (double)fx_ns / (double)n_win / 1e3);
+    }
+    fprintf(stderr, "  throughput  : %.0f windows/s, %.0f samples/s (%.1fx real time)\n",
+            total_s > 0.0 ? (double)n_win / total_s : 0.0,
+            total_s > 0.0 ? (double)rec.n / total_s : 0.0,
+            total_s > 0.0 && rec_s > 0.0 ? rec_s / total_s : 0.0);
+
+    free(lat_ns);
+    free(ring);
+    session_csv_free(&rec);
+    return 0;
+}
@@ -0,0 +1,47 @@
+// project/host/mock_i2c.c
+#include <string.h>
+#include "mock_i2c.h"
+
+void mock_i2c_init(mock_i2c_t *m, uint32_t bus_hz, mock_i2c_done_fn on_done, void *user) {
+    memset(m, 0, sizeof(*m));
+    m->bus_hz = bus_hz;
+    m->on_done = on_done;
+    m->user = user;
+}
+
+uint32_t mock_i2c_xfer_us(const mock_i2c_t *m, size_t n) {
+    // addr+W, reg, addr+R, n data bytes at 9 clocks each, plus S/Sr/P
+    const uint64_t bits = (uint64_t)(3 + n) * 9u + 3u;
+    return (uint32_t)((bits * 1000000u + m->bus_hz - 1) / m->bus_hz);
+}
+
+void mock_i2c_advance(mock_i2c_t *m, uint64_t now_us) {
+    m->now_us = now_us;
+    if (!m->pending || m->pending_hang || now_us < m->done_us) return;
+
+    m->pending = false;
+    if (m->pending_ok) memcpy(m->dst, m->snap, m->n);
+    if (m->on_done) m->on_done(m->user, m->pending_ok);
+}
+
+bool mock_i2c_start_read(void *ctx, uint8_t reg, uint8_t *buf, size_t n) {
+    mock_i2c_t *m = (mock_i2c_t *)ctx;
+    if (m->pending || n == 0 || n > sizeof m->snap || (size_t)reg + n > sizeof m->regs) return false;
+
+    m->transfers++;
+    m->pending = true;
+    m->pending_ok = !(m->nack_every && m->transfers % m->nack_every == 0);
+    m->pending_hang = m->hang_every && m->transfers % m->hang_every == 0;
+    m->done_us = m->now_us + mock_i2c_xfer_us(m, n);
+    m->busy_us += mock_i2c_xfer_us(m, n);
+    memcpy(m->snap, &m->regs[reg], n);
+    m->dst = buf;
+    m->n = n;
+    return true;
+}
+
+void mock_i2c_abort(void *ctx) {
+    mock_i2c_t *m = (mock_i2c_t *)ctx;
+    m->pending = false;
+    m->aborts++;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Host stand-in for src/i2c_dma.c: an ICM-20948 register file behind a bus
+// with realistic transfer time on a virtual clock. start_read() snapshots the
+// registers and schedules the completion; mock_i2c_advance() fires it once
+// the clock passes the end of the transfer, the way the DMA IRQ would.
+//
+// Faults can be injected per transfer: a NACK completes with ok=false, a hang
+// never completes and has to be aborted.
+
+typedef void (*mock_i2c_done_fn)(void *user, bool ok);
+
+typedef struct {
+    uint8_t regs[128];         // bank-0 registers
+    uint32_t bus_hz;
+    uint64_t now_us;           // virtual clock
+
+    bool pending;
+    bool pending_ok;
+    bool pending_hang;
+    uint64_t done_us;
+    uint8_t snap[32];
+    uint8_t *dst;
+    size_t n;
+
+    uint32_t nack_every;       // fail every Nth transfer (0 = never)
+    uint32_t hang_every;       // hang every Nth transfer (0 = never)
+
+    uint32_t transfers;
+    uint32_t aborts;
+    uint64_t busy_us;          // bus time of all transfers started
+
+    mock_i2c_done_fn on_done;
+    void *user;
+} mock_i2c_t;
+
+void mock_i2c_init(mock_i2c_t *m, uint32_t bus_hz, mock_i2c_done_fn on_done, void *user);
+
+// Bus time of "write reg, repeated-start read n bytes" incl. address bytes.
+uint32_t mock_i2c_xfer_us(const mock_i2c_t *m, size_t n);
+
+// Moves the clock to now_us and fires a completion that is due by then.
+void mock_i2c_advance(mock_i2c_t *m, uint64_t now_us);
+
+// icm_async_transport_t callbacks (ctx = mock_i2c_t*).
+bool mock_i2c_start_read(void *ctx, uint8_t reg, uint8_t *buf, size_t n);
+void mock_i2c_abort(void *ctx);
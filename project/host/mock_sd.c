@@ -0,0 +1,161 @@
+// project/host/mock_sd.c
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio.h"
+#include "mock_sd.h"
+
+#define SECTOR 512u
+
+mock_sd_t g_mock_sd;
+static sd_card_t s_card;
+
+static bool mock_sd_range_ok(uint64_t lba, uint32_t n) {
+    return n && lba + n <= MOCK_SD_SECTORS;
+}
+
+static bool mock_sd_busy(void) {
+    if (!g_mock_sd.async_left) return false;
+    g_mock_sd.violations++;
+    return true;
+}
+
+static void mock_sd_store(const uint8_t *src, uint64_t lba, uint32_t n) {
+    memcpy(&g_mock_sd.disk[lba * SECTOR], src, (size_t)n * SECTOR);
+    g_mock_sd.sectors_written += n;
+}
+
+// ---- sd_card_t block ops (raw mode) ----
+
+static block_dev_err_t card_write_blocks(sd_card_t *sd, const uint8_t *buf, uint32_t lba, uint32_t n) {
+    (void)sd;
+    if (mock_sd_busy()) return SD_BLOCK_DEVICE_ERROR_WRITE;
+    if (!mock_sd_range_ok(lba, n)) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    mock_sd_store(buf, lba, n);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static block_dev_err_t card_read_blocks(sd_card_t *sd, uint8_t *buf, uint32_t lba, uint32_t n) {
+    (void)sd;
+    if (mock_sd_busy()) return SD_BLOCK_DEVICE_ERROR_WRITE;
+    if (!mock_sd_range_ok(lba, n)) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    memcpy(buf, &g_mock_sd.disk[(uint64_t)lba * SECTOR], (size_t)n * SECTOR);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static block_dev_err_t card_sync(sd_card_t *sd) {
+    (void)sd;
+    return mock_sd_busy() ? SD_BLOCK_DEVICE_ERROR_WRITE : SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static block_dev_err_t card_write_blocks_start(sd_card_t *sd, const uint8_t *buf, uint32_t lba, uint32_t n) {
+    (void)sd;
+    if (mock_sd_busy()) return SD_BLOCK_DEVICE_ERROR_WRITE;
+    if (!mock_sd_range_ok(lba, n)) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    g_mock_sd.async_buf = buf;
+    g_mock_sd.async_lba = lba;
+    g_mock_sd.async_cnt = n;
+    g_mock_sd.async_left = g_mock_sd.async_polls;
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static block_dev_err_t card_write_blocks_poll(sd_card_t *sd) {
+    (void)sd;
+    if (!g_mock_sd.async_left) return SD_BLOCK_DEVICE_ERROR_NONE;
+    if (--g_mock_sd.async_left) return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+    mock_sd_store(g_mock_sd.async_buf, g_mock_sd.async_lba, g_mock_sd.async_cnt);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+block_dev_err_t sd_write_blocks_complete(sd_card_t *sd) {
+    block_dev_err_t rc;
+    while ((rc = card_write_blocks_poll(sd)) == SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK) {
+    }
+    return rc;
+}
+
+sd_card_t *sd_get_by_num(size_t num) {
+    return num == 0 ? &s_card : NULL;
+}
+
+void mock_sd_init(uint32_t async_polls, uint32_t seed) {
+    uint8_t *disk = g_mock_sd.disk;
+    if (!disk) disk = (uint8_t *)malloc((size_t)MOCK_SD_SECTORS * SECTOR);
+    memset(&g_mock_sd, 0, sizeof(g_mock_sd));
+    g_mock_sd.disk = disk;
+    if (disk) memset(disk, 0, (size_t)MOCK_SD_SECTORS * SECTOR);
+    g_mock_sd.async_polls = async_polls;
+    g_mock_sd.rand_state = seed ? seed : 1u;
+
+    s_card.write_blocks = card_write_blocks;
+    s_card.read_blocks = card_read_blocks;
+    s_card.sync = card_sync;
+    s_card.write_blocks_start = async_polls ? card_write_blocks_start : NULL;
+    s_card.write_blocks_poll = async_polls ? card_write_blocks_poll : NULL;
+}
+
+void mock_sd_advance(uint64_t us) {
+    g_mock_sd.now_us += us;
+}
+
+uint64_t time_us_64(void) {
+    return g_mock_sd.now_us;
+}
+
+uint32_t get_rand_32(void) {
+    uint32_t x = g_mock_sd.rand_state;   // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_mock_sd.rand_state = x;
+    return x;
+}
+
+// ---- FatFs diskio (drive 0 only) ----
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return (pdrv == 0 && g_mock_sd.disk) ? 0 : STA_NOINIT;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return disk_initialize(pdrv);
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0) return RES_PARERR;
+    if (mock_sd_busy()) return RES_ERROR;
+    if (!mock_sd_range_ok(sector, count)) return RES_PARERR;
+    memcpy(buff, &g_mock_sd.disk[sector * SECTOR], (size_t)count * SECTOR);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0) return RES_PARERR;
+    if (mock_sd_busy()) return RES_ERROR;
+    if (!mock_sd_range_ok(sector, count)) return RES_PARERR;
+    mock_sd_store(buff, sector, count);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    if (pdrv != 0) return RES_PARERR;
+    switch (cmd) {
+    case CTRL_SYNC:
+        return mock_sd_busy() ? RES_ERROR : RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = MOCK_SD_SECTORS;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = SECTOR;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+    return ((DWORD)(2024 - 1980) << 25) | (1u << 21) | (1u << 16);
+}
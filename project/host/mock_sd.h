@@ -0,0 +1,68 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host stand-in for the SD card under src/sd_writer.cpp: a RAM disk that the
+// real FatFs (sd_card_driver/ff15) reaches through diskio, and that raw mode
+// reaches through an sd_card_t with the driver's block ops, on a virtual
+// clock. Sectors land on the disk when a write completes; an async write
+// completes after async_polls polls and holds the card until then, so any
+// other access in between is counted as a violation.
+//
+// The host/stub headers (pico/time.h, pico/rand.h, sd_card.h, hw_config.h)
+// all resolve to this file.
+
+#define MOCK_SD_SECTORS (64u * 1024u)   // 32 MB
+
+typedef enum {
+    SD_BLOCK_DEVICE_ERROR_NONE = 0,
+    SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK = 1 << 0,
+    SD_BLOCK_DEVICE_ERROR_PARAMETER = 1 << 2,
+    SD_BLOCK_DEVICE_ERROR_WRITE = 1 << 10,
+} block_dev_err_t;
+
+typedef struct sd_card_t sd_card_t;
+struct sd_card_t {
+    block_dev_err_t (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
+                                    uint32_t ulSectorNumber, uint32_t blockCnt);
+    block_dev_err_t (*read_blocks)(sd_card_t *sd_card_p, uint8_t *buffer,
+                                   uint32_t ulSectorNumber, uint32_t ulSectorCount);
+    block_dev_err_t (*sync)(sd_card_t *sd_card_p);
+    block_dev_err_t (*write_blocks_start)(sd_card_t *sd_card_p, const uint8_t *buffer,
+                                          uint32_t ulSectorNumber, uint32_t blockCnt);
+    block_dev_err_t (*write_blocks_poll)(sd_card_t *sd_card_p);
+};
+
+typedef struct {
+    uint8_t *disk;             // MOCK_SD_SECTORS * 512 bytes
+    uint64_t now_us;           // virtual clock
+    uint32_t rand_state;
+    uint32_t async_polls;      // polls until an async write completes (0 = no async)
+
+    const uint8_t *async_buf;  // write in flight
+    uint32_t async_lba, async_cnt, async_left;
+
+    uint32_t sectors_written;
+    uint32_t violations;       // card accessed while an async write held it
+} mock_sd_t;
+
+extern mock_sd_t g_mock_sd;
+
+// Allocates (first call) and zeroes the disk, and resets the counters.
+void mock_sd_init(uint32_t async_polls, uint32_t seed);
+void mock_sd_advance(uint64_t us);
+
+// ---- Pico SDK / driver entry points sd_writer.cpp calls ----
+uint64_t time_us_64(void);
+uint32_t get_rand_32(void);
+sd_card_t *sd_get_by_num(size_t num);
+block_dev_err_t sd_write_blocks_complete(sd_card_t *sd_card_p);
+
+#ifdef __cplusplus
+}
+#endif
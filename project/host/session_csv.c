@@ -0,0 +1,42 @@
+// project/host/session_csv.c
+#include <stdio.h>
+#include <stdlib.h>
+#include "session_csv.h"
+
+bool session_csv_load(const char *path, sample_buf_t *out) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return false; }
+
+    char line[1024];
+    while (fgets(line, sizeof line, f)) {
+        // data rows start with a digit; headers and GESTURE:/WARN: lines do not
+        if (line[0] < '0' || line[0] > '9') continue;
+        // raw rows have exactly seven columns; per-window CSV_HEADER rows
+        // (22) start with t_ms,ax..gz too but are not samples
+        int commas = 0;
+        for (const char *c = line; *c; c++) commas += (*c == ',');
+        if (commas != 6) continue;
+
+        sample_t s;
+        unsigned long t;
+        if (sscanf(line, "%lu,%f,%f,%f,%f,%f,%f",
+                   &t, &s.ax, &s.ay, &s.az, &s.gx, &s.gy, &s.gz) != 7) continue;
+        s.t_ms = (uint32_t)t;
+
+        if (out->n == out->cap) {
+            out->cap = out->cap ? out->cap * 2 : 4096;
+            sample_t *nv = realloc(out->v, out->cap * sizeof(*nv));
+            if (!nv) { fclose(f); return false; }
+            out->v = nv;
+        }
+        out->v[out->n++] = s;
+    }
+    fclose(f);
+    return true;
+}
+
+void session_csv_free(sample_buf_t *buf) {
+    free(buf->v);
+    buf->v = NULL;
+    buf->n = buf->cap = 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// One recorded sample: a t_ms,ax,ay,az,gx,gy,gz row of a LOG_RAW capture.
+typedef struct {
+    uint32_t t_ms;
+    float ax, ay, az, gx, gy, gz;
+} sample_t;
+
+typedef struct {
+    sample_t *v;
+    size_t n, cap;
+} sample_buf_t;
+
+// Appends every raw sample row of `path` to `out`: rows of exactly seven
+// columns. Everything else is skipped, including the per-window CSV_HEADER
+// rows of the same capture (LOG_FEATURES), headers, and GESTURE:/WARN: lines.
+// Returns false on I/O or allocation failure.
+bool session_csv_load(const char *path, sample_buf_t *out);
+void session_csv_free(sample_buf_t *buf);
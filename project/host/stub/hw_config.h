@@ -0,0 +1,3 @@
+#pragma once
+// Host stand-in for the driver's hw_config.h: one card, drive 0.
+#include "mock_sd.h"
@@ -0,0 +1,3 @@
+#pragma once
+// Host stand-in for the Pico SDK header: a seeded generator in host/mock_sd.c.
+#include "mock_sd.h"
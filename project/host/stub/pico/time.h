@@ -0,0 +1,3 @@
+#pragma once
+// Host stand-in for the Pico SDK header: the virtual clock of host/mock_sd.c.
+#include "mock_sd.h"
@@ -0,0 +1,4 @@
+#pragma once
+// Host stand-in for the driver's sd_card.h: the card is a RAM disk in
+// host/mock_sd.c.
+#include "mock_sd.h"
@@ -5,16 +5,62 @@
 #define WIN_MS        1000      // window length [ms]
 #define HOP_MS        500       // hop length [ms]
 
+// IMU scaling (ICM-20948 at +/-2 g, +/-1000 dps)
+#define ACCEL_SCALE_G   (1.0f / 16384.0f)   // g per LSB
+#define GYRO_SCALE_DPS  (1.0f / 32.8f)      // dps per LSB
+
 // Print/Log toggles
 #define LOG_RAW       0         // 1: print per-sample raw CSV
+#define LOG_RAW_SD    0         // 1: every sample (int16 counts + us timestamp) to logs/raw_*.bin on SD
 #define LOG_FEATURES  1         // 1: print per-window feature CSV
 #define PRINT_DEBUG   0         // 1: print "GESTURE: ..." friendly lines
 #define PRINT_WARN    0         // 1: print WARN lines (e.g., drift)
+#define LOG_BINARY    1         // SD log: 1 = binary records (.bin, host/imu_log2csv), 0 = CSV lines
+#define SD_BUF_BYTES  2048      // SD writer: two RAM buffers of this size (multiple of 512)
+#define SD_SYNC_MS    1000      // SD writer: f_sync at most this long after the last one...
+#define SD_SYNC_BYTES 16384     // ...or once this many bytes are unsynced
+#define SD_PREALLOC_BYTES (8u * 1024u * 1024u)  // contiguous f_expand reservation per session log
+#define SD_RAW_STREAM 0         // 1: write the reservation through the block driver (CMD25), FAT/dir only at close
+#define SD_ASYNC_WRITE 1        // raw stream: start each buffer write and poll it while the consumer keeps working
+#define SD_JOURNAL    1         // binary logs: per-block seq + CRC, checkpoint per sync; unclosed logs repaired at boot
+#define SD_BENCH      0         // 1: benchmark the SD write path at boot (SDBENCH lines) before logging starts
+#define SD_BENCH_BYTES (1024u * 1024u)  // bytes written per benchmark run
+#define RAW_LOG_RING_LEN 1024   // LOG_RAW_SD: RAM ring of 16-byte records (power of two), ~1 s at 1 kHz
+#define RAW_LOG_PREALLOC_BYTES (32u * 1024u * 1024u)  // LOG_RAW_SD reservation, ~35 min at 1 kHz (uncompressed)
+#define RAW_LOG_COMPRESS 1      // LOG_RAW_SD: delta/zigzag/varint packing per sector (src/raw_codec.c), ~2x smaller
 
 // Feature switches
 #define USE_GYRO      1         // include gyro-based features
 #define USE_FFT       1         // compute FFT-derived features
 #define USE_QUANT     0         // quantize final feature vector (u8) for logging
+#define USE_STREAM_FEATS 1      // 1: incremental engine (feat_stream.c), 0: recompute each window (FFT back-end is faster, see README); lat_ms includes the pushes
+#define USE_FIXED_POINT  0      // 1: integer/Q15 pipeline on raw int16 samples (features_q15.c); experimental, device cost unmeasured
+#define MOTION_GATE      1      // 1: spectrum + classifier only past the amag/gyro std gate, idle windows are NONE
+#define FEATURE_EXT      0      // 1: extended features (src/feat_ext.h) as an FX: line per window
+#define FEATURE_EXT_MASK FX_ALL // FX_* groups computed at boot; g_fx_mask can change them at run time
+#define NN_BENCH         0      // 1: check src/gesture_nn.h bit for bit and time it at boot (NN: line)
+
+// Decision layer (gesture_filter.c): held decision + confidence over classify()
+#define DECISION_FILTER  1      // 1: HMM/hysteresis over the window classes, DECISION: line on each change
+#define DECISION_EARLY   1      // 1: also classify partial windows between the hops for earlier decisions
+#define EARLY_WIN_MS     500    // partial window length [ms]
+#define EARLY_HOP_MS     250    // partial window hop [ms]
+
+// Sample trigger
+#define SAMPLE_TRIGGER_SLEEP 0  // sleep_until() pacing in the core0 loop
+#define SAMPLE_TRIGGER_TIMER 1  // repeating hardware alarm; I2C read in the alarm IRQ
+#define SAMPLE_TRIGGER_DRDY  2  // ICM-20948 INT1 raw-data-ready; I2C read in the GPIO IRQ (SAMPLE_HZ 25 or 5)
+#define SAMPLE_TRIGGER_FIFO  3  // ICM-20948 gyro FIFO drained in bursts, accel read per drain (SAMPLE_HZ divides 1100)
+#define SAMPLE_TRIGGER    SAMPLE_TRIGGER_TIMER
+#define IMU_INT_GPIO      8     // ICM-20948 INT1 -> Pico GPIO (SAMPLE_TRIGGER_DRDY only)
+#define FIFO_ACCEL_HZ     50    // min FIFO drains (= accel reads) per second; sooner if the FIFO is half full (SAMPLE_TRIGGER_FIFO only)
+#define USE_I2C_DMA       0     // 1: TIMER/DRDY IRQ only starts a DMA burst read; the DMA IRQ pushes the sample
+#define I2C_DMA_TIMEOUT_US 2000 // a read still in flight this long is aborted at the next trigger
+
+// Dual-core pipeline
+#define USE_DUAL_CORE     1     // 1: core0 samples, core1 runs features/classifier/SD logging
+#define SAMPLE_RING_LEN   256   // core0 -> core1 sample queue (power of two), ~2.5 s at 100 Hz
+#define CORE1_STACK_BYTES 8192  // core1 stack (f_mkfs needs a 4 KB work buffer)
 
 // CSV header (matches firmware printf order)
 #define CSV_HEADER \
@@ -0,0 +1,43 @@
+#include <string.h>
+#include "bin_logger.h"
+
+static_assert(SD_SECTOR_BYTES % sizeof(imu_log_record_t) == 0, "records must fill a sector exactly");
+static_assert(IMU_LOG_HEADER_BYTES == SD_SECTOR_BYTES, "header must occupy exactly one sector");
+
+extern "C" {
+
+FRESULT bin_open(bin_logger_t* lg, const char* abs_path, const imu_log_header_t* header) {
+  if (!lg || !header) return FR_INVALID_OBJECT;
+  memset(lg, 0, sizeof(*lg));
+
+  FRESULT fr = sd_writer_open(&lg->w, abs_path, SD_PREALLOC_BYTES, SD_RAW_STREAM, SD_JOURNAL);
+  if (fr != FR_OK) return fr;
+
+  uint8_t sector[IMU_LOG_HEADER_BYTES] = {0};   // rest of the sector stays zero
+  memcpy(sector, header, sizeof(*header));
+  fr = sd_writer_append(&lg->w, sector, sizeof sector);
+  if (fr != FR_OK) { sd_writer_close(&lg->w); return fr; }
+
+  lg->open = true;
+  return FR_OK;
+}
+
+FRESULT bin_append(bin_logger_t* lg, const imu_log_record_t* rec) {
+  if (!lg || !lg->open) return FR_INVALID_OBJECT;
+  FRESULT fr = sd_writer_append(&lg->w, rec, sizeof(*rec));
+  if (fr == FR_OK) lg->records_written++;
+  return fr;
+}
+
+FRESULT bin_service(bin_logger_t* lg, bool* did_work) {
+  if (!lg || !lg->open) return FR_INVALID_OBJECT;
+  return sd_writer_service(&lg->w, did_work);
+}
+
+FRESULT bin_close(bin_logger_t* lg) {
+  if (!lg || !lg->open) return FR_INVALID_OBJECT;
+  lg->open = false;
+  return sd_writer_close(&lg->w);
+}
+
+} // extern "C"
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+#include "imu_log_format.h"
+#include "sd_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary counterpart of csv_logger_t. The header fills one sector of the
+// stream and records tile the sd_writer buffers exactly, so every write is
+// whole sectors and no record straddles a buffer. With SD_JOURNAL the stream
+// is cut into 500-byte block payloads (log_journal.h) instead, so the header
+// and records do straddle sectors; imu_log2csv unwraps them.
+typedef struct {
+  sd_writer_t w;
+  bool open;
+  unsigned records_written;
+} bin_logger_t;
+
+FRESULT bin_open(bin_logger_t* lg, const char* abs_path, const imu_log_header_t* header);
+FRESULT bin_append(bin_logger_t* lg, const imu_log_record_t* rec);
+// Background flush/sync; call when there is nothing else to do.
+FRESULT bin_service(bin_logger_t* lg, bool* did_work);
+FRESULT bin_close(bin_logger_t* lg);
+
+#ifdef __cplusplus
+}
+#endif
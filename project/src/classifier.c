@@ -1,6 +1,27 @@
 #include <math.h>
 #include "classifier.h"
 
+#ifndef CLASSIFIER_TREE
+#define CLASSIFIER_TREE 1
+#endif
+
+#ifndef CLASSIFIER_NN
+#define CLASSIFIER_NN 0
+#endif
+
+#if CLASSIFIER_TREE
+#include "dtree.h"
+#include "gesture_model.h"
+_Static_assert(GESTURE_MODEL_N_FEATURES == CLS_N_FEATURES, "gesture_model.h was generated for other features");
+#endif
+
+#if CLASSIFIER_NN
+#include "nn_int8.h"
+#include "gesture_nn.h"
+_Static_assert(GESTURE_NN_INPUT == NN_INPUT_FEATURES && GESTURE_NN_IN_CH == 5,
+               "classify() feeds gesture_nn.h the quantize_features_u8() vector");
+#endif
+
 const char* gesture_name(int cls) {
     switch (cls) {
         case G_SHAKE: return "SHAKE";
@@ -11,8 +32,8 @@ const char* gesture_name(int cls) {
     }
 }
 
-// Simple rule-based thresholds
-int classify(const feat_vec_t* f) {
+// Simple rule-based thresholds (export_tree.py --rules builds the same as a tree)
+int classify_rules(const feat_vec_t* f) {
     float s = f->amag.std;
     float df = f->amag.dom_freq;
     float gsum = (f->gx_std + f->gy_std + f->gz_std) / 3.0f;
@@ -28,3 +49,45 @@ int classify(const feat_vec_t* f) {
 
     return G_NONE;
 }
+
+// NaN (a feature that did not compute) has no place in dt_key()'s order.
+// As 0 it classifies the same as in classify_rules(), where every comparison
+// with NaN is false.
+void classifier_features(const feat_vec_t* f, float x[CLS_N_FEATURES]) {
+    x[CLS_F_AMAG_STD] = f->amag.std;
+    x[CLS_F_DOM_FREQ] = f->amag.dom_freq;
+    x[CLS_F_BP1] = f->amag.bp1;
+    x[CLS_F_BP2] = f->amag.bp2;
+    x[CLS_F_GX_STD] = f->gx_std;
+    x[CLS_F_GY_STD] = f->gy_std;
+    x[CLS_F_GZ_STD] = f->gz_std;
+    x[CLS_F_GYRO_STD_MEAN] = (f->gx_std + f->gy_std + f->gz_std) / 3.0f;
+    for (int i = 0; i < CLS_N_FEATURES; i++) {
+        if (isnan(x[i])) x[i] = 0.0f;
+    }
+}
+
+#if CLASSIFIER_NN
+// quantize_features_u8() as int8 (scale 1/255, zero point -128).
+int classify_nn(const feat_vec_t* f) {
+    static int8_t arena[GESTURE_NN_ARENA_BYTES];
+    uint8_t u8[GESTURE_NN_IN_CH];
+    int n = 0;
+    quantize_features_u8(f, u8, &n);
+    int8_t* in = nn_input(&kGestureNn, arena);
+    for (int i = 0; i < n; i++) in[i] = (int8_t)(u8[i] - 128);
+    return nn_argmax(nn_run(&kGestureNn, arena), kGestureNn.n_out);
+}
+#endif
+
+int classify(const feat_vec_t* f) {
+#if CLASSIFIER_NN
+    return classify_nn(f);
+#elif CLASSIFIER_TREE
+    float x[CLS_N_FEATURES];
+    classifier_features(f, x);
+    return dt_predict(&kGestureModel, x);
+#else
+    return classify_rules(f);
+#endif
+}
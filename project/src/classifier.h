@@ -12,7 +12,27 @@ enum {
     G_CIRCLE = 3
 };
 
+// Model input, in the order analysis/export_tree.py trains on (CSV names).
+enum {
+    CLS_F_AMAG_STD = 0,
+    CLS_F_DOM_FREQ,
+    CLS_F_BP1,
+    CLS_F_BP2,
+    CLS_F_GX_STD,
+    CLS_F_GY_STD,
+    CLS_F_GZ_STD,
+    CLS_F_GYRO_STD_MEAN,
+    CLS_N_FEATURES
+};
+
+// CLASSIFIER_TREE=1 (default): classify() evaluates the generated table in
+// src/gesture_model.h with dtree.c. 0: the hand-written classify_rules().
+// CLASSIFIER_NN=1 takes precedence: the int8 network of src/gesture_nn.h
+// (nn_int8.c) over quantize_features_u8().
 int classify(const feat_vec_t* f);
+int classify_rules(const feat_vec_t* f);
+int classify_nn(const feat_vec_t* f);   // CLASSIFIER_NN builds only
+void classifier_features(const feat_vec_t* f, float x[CLS_N_FEATURES]);
 const char* gesture_name(int cls);
 
 #ifdef __cplusplus
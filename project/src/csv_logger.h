@@ -2,23 +2,24 @@
 
 #include <stdbool.h>
 #include "ff.h"
+#include "sd_writer.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct {
-  FIL file;
+  sd_writer_t w;
   bool open;
   unsigned lines_written;
-  unsigned flush_interval;
 } csv_logger_t;
 
 FRESULT csv_open(csv_logger_t* lg, const char* abs_path, const char* header);
 FRESULT csv_append(csv_logger_t* lg, const char* line);
+// Background flush/sync; call when there is nothing else to do.
+FRESULT csv_service(csv_logger_t* lg, bool* did_work);
 FRESULT csv_close(csv_logger_t* lg);
 
 #ifdef __cplusplus
 }
 #endif
-
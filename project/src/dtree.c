@@ -0,0 +1,22 @@
+// project/src/dtree.c
+#include "dtree.h"
+
+int dt_predict(const dt_model_t *m, const float *x) {
+    int32_t key[DT_MAX_FEATURES];
+    for (unsigned i = 0; i < m->n_features; i++) key[i] = dt_key(x[i]);
+
+    uint8_t votes[DT_MAX_CLASSES] = {0};
+    for (unsigned t = 0; t < m->n_trees; t++) {
+        const dt_node_t *n = &m->nodes[m->roots[t]];
+        for (unsigned d = 0; d < m->depth; d++) {
+            n = &m->nodes[n->child[key[n->feature] > n->thr]];
+        }
+        votes[n->cls]++;
+    }
+
+    int best = 0;
+    for (int c = 1; c < m->n_classes; c++) {
+        if (votes[c] > votes[best]) best = c;
+    }
+    return best;
+}
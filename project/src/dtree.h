@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decision tree / forest evaluator for tables generated by
+// analysis/export_tree.py (e.g. src/gesture_model.h).
+//
+// All trees share one flat node array. An inner node sends x to
+// child[key(x[feature]) > thr]; thr is the threshold already converted with
+// dt_key(), so the walk compares integers only (no soft-float call on the
+// M0+). A leaf carries its class and points both children back at itself, so
+// every walk runs exactly `depth` steps with no data-dependent branch: the
+// cost per classification is the same for every input. A forest takes the
+// majority vote of its trees; ties go to the lower class.
+
+#define DT_MAX_FEATURES 16
+#define DT_MAX_CLASSES  8
+
+typedef struct {
+    int32_t thr;            // dt_key(threshold): right if dt_key(x) > thr
+    uint8_t feature;
+    uint8_t cls;            // leaf: predicted class
+    uint16_t child[2];      // [0] x <= threshold, [1] x > threshold
+} dt_node_t;
+
+typedef struct {
+    const dt_node_t *nodes;
+    const uint16_t *roots;  // first node of each tree
+    uint8_t n_trees;
+    uint8_t depth;          // longest root-to-leaf path, in splits
+    uint8_t n_features;
+    uint8_t n_classes;
+} dt_model_t;
+
+// Maps a float to an int32 with the same order (-0 and +0 compare equal;
+// NaN is not meant to reach it).
+static inline int32_t dt_key(float x) {
+    union { float f; int32_t i; } u = { x };
+    return (u.i < 0) ? -(u.i & 0x7FFFFFFF) : u.i;   // sign-magnitude to two's complement
+}
+
+// x holds m->n_features values. Returns the predicted class.
+int dt_predict(const dt_model_t *m, const float *x);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,265 @@
+// project/src/feat_ext.c
+#include <math.h>
+#include <string.h>
+#include "feat_ext.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ===================== shared intermediates =====================
+
+enum {
+    FXI_DEMEAN   = 1u << 0,   // mean, demeaned copy and sum of squares per accel axis
+    FXI_WINDOWED = 1u << 1,   // demeaned axes x Hann (needs FXI_DEMEAN)
+    FXI_ANGLE    = 1u << 2,   // pitch/roll/yaw integrated from gy/gx/gz
+};
+
+typedef struct {
+    const float* raw[6];
+    int n;
+    float fs_hz;
+    uint32_t built;                         // FXI_* done for this window
+    float mean[3];
+    float sumsq[3];
+    float demean[3][FX_MAX_SAMPLES];
+    float windowed[3][FX_MAX_SAMPLES];
+    float angle[3][FX_MAX_SAMPLES];         // since the window start [deg]
+} fx_ctx_t;
+
+static fx_ctx_t g_ctx;
+
+static const float* hann(int n) {
+    static int cached_n = 0;
+    static float w[FX_MAX_SAMPLES];
+    if (cached_n != n) {
+        for (int i = 0; i < n; i++) {
+            w[i] = (n > 1) ? 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)i / (float)n)) : 1.0f;
+        }
+        cached_n = n;
+    }
+    return w;
+}
+
+static void fx_build(fx_ctx_t* c, uint32_t need) {
+    const int n = c->n;
+    if (need & FXI_WINDOWED) need |= FXI_DEMEAN;
+    need &= ~c->built;
+
+    if (need & FXI_DEMEAN) {
+        for (int a = 0; a < 3; a++) {
+            const float* x = c->raw[a];
+            float s = 0.0f;
+            for (int i = 0; i < n; i++) s += x[i];
+            const float m = s / (float)n;
+            float sq = 0.0f;
+            for (int i = 0; i < n; i++) {
+                const float d = x[i] - m;
+                c->demean[a][i] = d;
+                sq += d * d;
+            }
+            c->mean[a] = m;
+            c->sumsq[a] = sq;
+        }
+    }
+    if (need & FXI_WINDOWED) {
+        const float* w = hann(n);
+        for (int a = 0; a < 3; a++) {
+            for (int i = 0; i < n; i++) c->windowed[a][i] = c->demean[a][i] * w[i];
+        }
+    }
+    if (need & FXI_ANGLE) {
+        static const int kRate[3] = { 4, 3, 5 };   // pitch <- gy, roll <- gx, yaw <- gz
+        const float dt = 1.0f / c->fs_hz;
+        for (int a = 0; a < 3; a++) {
+            const float* g = c->raw[kRate[a]];
+            float angle = 0.0f;
+            for (int i = 0; i < n; i++) {
+                angle += g[i] * dt;
+                c->angle[a][i] = angle;
+            }
+        }
+    }
+    c->built |= need;
+}
+
+// ===================== feature groups =====================
+
+// Goertzel over bins 1..10 Hz of each windowed axis, with the band edges of
+// spectral_features_capped() in features.c.
+static void fx_axis_spectrum(const fx_ctx_t* c, float* out) {
+    const int n = c->n;
+    const float df = c->fs_hz / (float)n;
+    int kmax = (int)floorf(10.0f / df);
+    if (kmax > n / 2) kmax = n / 2;
+
+    for (int a = 0; a < 3; a++) {
+        const float* x = c->windowed[a];
+        float best_mag2 = 0.0f, best_freq = 0.0f, bp1 = 0.0f, bp2 = 0.0f;
+        for (int k = 1; k <= kmax; k++) {
+            const float omega = 2.0f * (float)M_PI * (float)k / (float)n;
+            const float cosw = cosf(omega), sinw = sinf(omega);
+            const float coeff = 2.0f * cosw;
+            float s1 = 0.0f, s2 = 0.0f;
+            for (int i = 0; i < n; i++) {
+                const float s0 = x[i] + coeff * s1 - s2;
+                s2 = s1;
+                s1 = s0;
+            }
+            const float re = s1 - s2 * cosw, im = s2 * sinw;
+            const float mag2 = re * re + im * im;
+            const float freq = df * (float)k;
+            if (mag2 > best_mag2) { best_mag2 = mag2; best_freq = freq; }
+            if (freq >= 0.5f && freq < 3.0f) bp1 += mag2;
+            else if (freq >= 3.0f && freq <= 10.0f) bp2 += mag2;
+        }
+        out[3 * a + 0] = best_freq;
+        out[3 * a + 1] = bp1;
+        out[3 * a + 2] = bp2;
+    }
+}
+
+static void fx_correlation(const fx_ctx_t* c, float* out) {
+    static const int kPair[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    for (int p = 0; p < 3; p++) {
+        const float* x = c->demean[kPair[p][0]];
+        const float* y = c->demean[kPair[p][1]];
+        float sxy = 0.0f;
+        for (int i = 0; i < c->n; i++) sxy += x[i] * y[i];
+        const float den = sqrtf(c->sumsq[kPair[p][0]] * c->sumsq[kPair[p][1]]);
+        out[p] = den > 0.0f ? sxy / den : 0.0f;
+    }
+}
+
+static void fx_zcr(const fx_ctx_t* c, float* out) {
+    for (int a = 0; a < 3; a++) {
+        const float* x = c->demean[a];
+        int crossings = 0;
+        for (int i = 1; i < c->n; i++) {
+            if ((x[i] < 0.0f) != (x[i - 1] < 0.0f)) crossings++;
+        }
+        out[a] = c->n > 1 ? (float)crossings * c->fs_hz / (float)(c->n - 1) : 0.0f;
+    }
+}
+
+static void fx_jerk(const fx_ctx_t* c, float* out) {
+    const float *ax = c->raw[0], *ay = c->raw[1], *az = c->raw[2];
+    float sq = 0.0f, peak2 = 0.0f;
+    for (int i = 1; i < c->n; i++) {
+        const float dx = ax[i] - ax[i - 1], dy = ay[i] - ay[i - 1], dz = az[i] - az[i - 1];
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        sq += d2;
+        if (d2 > peak2) peak2 = d2;
+    }
+    out[0] = c->n > 1 ? sqrtf(sq / (float)(c->n - 1)) * c->fs_hz : 0.0f;
+    out[1] = sqrtf(peak2) * c->fs_hz;
+}
+
+static void fx_orientation(const fx_ctx_t* c, float* out) {
+    for (int a = 0; a < 3; a++) {
+        const float* x = c->angle[a];
+        float lo = 0.0f, hi = 0.0f;   // the window starts at 0
+        for (int i = 0; i < c->n; i++) {
+            if (x[i] < lo) lo = x[i];
+            if (x[i] > hi) hi = x[i];
+        }
+        out[a] = x[c->n - 1];
+        out[3 + a] = hi - lo;
+    }
+}
+
+// ===================== registry =====================
+
+typedef struct {
+    uint32_t bit;
+    uint32_t needs;                 // FXI_* intermediates
+    int n_out;
+    const char* const* names;
+    void (*fn)(const fx_ctx_t* c, float* out);
+} fx_group_t;
+
+static const char* const kSpectrumNames[] = {
+    "ax_dom_freq", "ax_bp1", "ax_bp2", "ay_dom_freq", "ay_bp1", "ay_bp2",
+    "az_dom_freq", "az_bp1", "az_bp2",
+};
+static const char* const kCorrelationNames[] = { "r_xy", "r_xz", "r_yz" };
+static const char* const kZcrNames[] = { "ax_zcr", "ay_zcr", "az_zcr" };
+static const char* const kJerkNames[] = { "jerk_rms", "jerk_peak" };
+static const char* const kOrientationNames[] = {
+    "d_pitch", "d_roll", "d_yaw", "pitch_range", "roll_range", "yaw_range",
+};
+
+static const fx_group_t kGroups[] = {
+    { FX_AXIS_SPECTRUM, FXI_WINDOWED, 9, kSpectrumNames,    fx_axis_spectrum },
+    { FX_CORRELATION,   FXI_DEMEAN,   3, kCorrelationNames, fx_correlation },
+    { FX_ZCR,           FXI_DEMEAN,   3, kZcrNames,         fx_zcr },
+    { FX_JERK,          0,            2, kJerkNames,        fx_jerk },
+    { FX_ORIENTATION,   FXI_ANGLE,    6, kOrientationNames, fx_orientation },
+};
+enum { FX_N_GROUPS = (int)(sizeof(kGroups) / sizeof(kGroups[0])) };
+
+int fx_count(uint32_t mask) {
+    int n = 0;
+    for (int g = 0; g < FX_N_GROUPS; g++) {
+        if (mask & kGroups[g].bit) n += kGroups[g].n_out;
+    }
+    return n;
+}
+
+const char* fx_name(uint32_t mask, int i) {
+    if (i < 0) return NULL;
+    for (int g = 0; g < FX_N_GROUPS; g++) {
+        if (!(mask & kGroups[g].bit)) continue;
+        if (i < kGroups[g].n_out) return kGroups[g].names[i];
+        i -= kGroups[g].n_out;
+    }
+    return NULL;
+}
+
+int fx_compute(uint32_t mask,
+               const float* ax, const float* ay, const float* az,
+               const float* gx, const float* gy, const float* gz,
+               int n, float fs_hz, float* out)
+{
+    if (n < 1 || fs_hz <= 0.0f) return 0;
+    if (n > FX_MAX_SAMPLES) n = FX_MAX_SAMPLES;
+
+    fx_ctx_t* c = &g_ctx;
+    const float* raw[6] = { ax, ay, az, gx, gy, gz };
+    memcpy(c->raw, raw, sizeof(raw));
+    c->n = n;
+    c->fs_hz = fs_hz;
+    c->built = 0;
+
+    int k = 0;
+    for (int g = 0; g < FX_N_GROUPS; g++) {
+        const fx_group_t* grp = &kGroups[g];
+        if (!(mask & grp->bit)) continue;
+        fx_build(c, grp->needs);
+        grp->fn(c, &out[k]);
+        k += grp->n_out;
+    }
+    return k;
+}
+
+// ===================== window source =====================
+
+bool fx_window_init(fx_window_t* w, int n, float* storage) {
+    memset(w, 0, sizeof(*w));
+    if (n < 1 || n > FX_MAX_SAMPLES || !storage) return false;
+    w->n = n;
+    memset(storage, 0, (size_t)FX_WINDOW_FLOATS(n) * sizeof(float));
+    for (int c = 0; c < 6; c++) w->ring[c] = &storage[c * 2 * n];
+    return true;
+}
+
+void fx_window_push(fx_window_t* w, float ax, float ay, float az,
+                    float gx, float gy, float gz) {
+    const float v[6] = { ax, ay, az, gx, gy, gz };
+    for (int c = 0; c < 6; c++) {
+        w->ring[c][w->head] = v[c];
+        w->ring[c][w->head + w->n] = v[c];
+    }
+    if (++w->head >= w->n) w->head = 0;
+    if (w->filled < w->n) w->filled++;
+}
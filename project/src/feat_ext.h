@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Extended window features beyond feat_vec_t, chosen per call with a bitmask.
+// Each feature group is one row of a registry in feat_ext.c: its outputs,
+// their column names, and the intermediate buffers it reads. The buffers
+// (per-axis means and demeaned copies, Hann-windowed axes, integrated angles)
+// are built at most once per window, for whichever enabled groups need them,
+// so enabling more groups adds only their own loops. To add a group, add a bit
+// here and a row plus its function to the registry.
+//
+// Outputs are written in bit order, each group's in the order of its names.
+
+#ifndef FX_MAX_SAMPLES
+#define FX_MAX_SAMPLES 256      // longest window; 10 KB of intermediates
+#endif
+
+enum {
+    FX_AXIS_SPECTRUM = 1u << 0,   // ax/ay/az: dominant freq [Hz], bp1, bp2 (as amag)
+    FX_CORRELATION   = 1u << 1,   // Pearson r of ax-ay, ax-az, ay-az
+    FX_ZCR           = 1u << 2,   // zero crossings of demeaned ax/ay/az [1/s]
+    FX_JERK          = 1u << 3,   // rms and peak |da/dt| of the accel vector [g/s]
+    FX_ORIENTATION   = 1u << 4,   // pitch/roll/yaw from gy/gx/gz: net delta and range [deg]
+    FX_ALL           = (1u << 5) - 1u
+};
+
+#define FX_MAX_OUTPUTS 23
+
+// Number of outputs for mask (unknown bits are ignored).
+int fx_count(uint32_t mask);
+// Column name of output i for mask, NULL if out of range.
+const char* fx_name(uint32_t mask, int i);
+// Features of one window (g, dps) into out[0 .. fx_count(mask)). n is clamped
+// to FX_MAX_SAMPLES. Returns the number written.
+int fx_compute(uint32_t mask,
+               const float* ax, const float* ay, const float* az,
+               const float* gx, const float* gy, const float* gz,
+               int n, float fs_hz, float* out);
+
+// Window source for pipelines that do not keep float windows (feat_stream,
+// Q15): the last n samples, each stored twice n apart so they are contiguous.
+// The caller provides FX_WINDOW_FLOATS(n) floats, so it costs the window it
+// is used with rather than FX_MAX_SAMPLES.
+#define FX_WINDOW_FLOATS(n) (6 * 2 * (n))
+
+typedef struct {
+    int n;
+    int head, filled;
+    float* ring[6];             // 2 * n floats each, in the caller's storage
+} fx_window_t;
+
+// Returns false if n is out of range.
+bool fx_window_init(fx_window_t* w, int n, float* storage);
+void fx_window_push(fx_window_t* w, float ax, float ay, float az,
+                    float gx, float gy, float gz);
+static inline bool fx_window_ready(const fx_window_t* w) { return w->filled >= w->n; }
+// Oldest of the last n samples of channel c (ax, ay, az, gx, gy, gz).
+static inline const float* fx_window_channel(const fx_window_t* w, int c) {
+    return &w->ring[c][w->head];
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,198 @@
+// project/src/feat_stream.c
+#include <math.h>
+#include <string.h>
+#include "feat_stream.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ===================== init =====================
+
+bool feat_stream_init(feat_stream_t* s, int n, float fs_hz) {
+    memset(s, 0, sizeof(*s));
+    if (n < 2 || n > FEAT_STREAM_MAX_SAMPLES || fs_hz <= 0.0f) return false;
+
+    s->n = n;
+    s->fs_hz = fs_hz;
+
+    for (int i = 0; i < n; i++) {
+        const double a = 2.0 * M_PI * (double)i / (double)n;
+        s->cos_tab[i] = (float)cos(a);
+        s->sin_tab[i] = (float)sin(a);
+    }
+
+    // same bin range as spectral_features_capped(): 1..floor(10 Hz / df).
+    // Too many bins is an error, not a cap: a shorter range would drop the
+    // upper part of bp2 and disagree with compute_features().
+    const float df = fs_hz / (float)n;
+    int kmax = (int)floorf(10.0f / df);
+    if (kmax > n / 2) kmax = n / 2;
+    if (kmax < 1) kmax = 0;
+    if (kmax + 1 > FEAT_STREAM_MAX_BINS) {
+        s->n = 0;
+        return false;
+    }
+    s->kmax = kmax;
+    s->nbins = kmax > 0 ? kmax + 1 : 0;
+    return true;
+}
+
+// ===================== per-sample update =====================
+
+void feat_stream_push(feat_stream_t* s,
+                      float ax, float ay, float az,
+                      float gx, float gy, float gz)
+{
+    const int n = s->n;
+    const float x_new[FS_NUM_CH] = { sqrtf(ax * ax + ay * ay + az * az), gx, gy, gz };
+
+    // 1) running sums: add newest, drop oldest (ring starts zeroed)
+    for (int c = 0; c < FS_NUM_CH; c++) {
+        const double xn = (double)x_new[c];
+        const double xo = (double)s->ring[c][s->head];
+        s->sum[c]   += xn - xo;
+        s->sumsq[c] += xn * xn - xo * xo;
+        s->sh_sum[c]   += xn;
+        s->sh_sumsq[c] += xn * xn;
+    }
+
+    // 2) sliding DFT on amag: X_k <- (X_k + x_new - x_old) * e^{+j2*pi*k/n}
+    const float x = x_new[FS_CH_AMAG];
+    const float d = x - s->ring[FS_CH_AMAG][s->head];
+    for (int i = 0; i < s->nbins; i++) {
+        const int k = (i + 1) % n;
+        const float c = s->cos_tab[k];
+        const float sn = s->sin_tab[k];
+        const float a = s->re[i] + d;
+        const float b = s->im[i];
+        s->re[i] = a * c - b * sn;
+        s->im[i] = a * sn + b * c;
+
+        // shadow block: plain DFT term x * e^{-j2*pi*k*m/n}
+        int p = s->sh_phase[i];
+        s->sh_re[i] += x * s->cos_tab[p];
+        s->sh_im[i] -= x * s->sin_tab[p];
+        p += k;
+        if (p >= n) p -= n;
+        s->sh_phase[i] = p;
+    }
+
+    for (int c = 0; c < FS_NUM_CH; c++) s->ring[c][s->head] = x_new[c];
+    if (++s->head >= n) s->head = 0;
+    if (s->filled < n) s->filled++;
+
+    // 3) every n samples the shadow block covers exactly the live window:
+    //    swap it in so round-off never accumulates past one window
+    if (++s->block_pos >= n) {
+        s->block_pos = 0;
+        for (int i = 0; i < s->nbins; i++) {
+            s->re[i] = s->sh_re[i];
+            s->im[i] = s->sh_im[i];
+            s->sh_re[i] = 0.0f;
+            s->sh_im[i] = 0.0f;
+            s->sh_phase[i] = 0;
+        }
+        for (int c = 0; c < FS_NUM_CH; c++) {
+            s->sum[c] = s->sh_sum[c];
+            s->sumsq[c] = s->sh_sumsq[c];
+            s->sh_sum[c] = 0.0;
+            s->sh_sumsq[c] = 0.0;
+        }
+    }
+}
+
+// ===================== query =====================
+
+static void stream_stats(const feat_stream_t* s, int c,
+                         float* mean, float* std, float* rms, float* energy)
+{
+    const double n = (double)s->n;
+    const float m = (float)(s->sum[c] / n);
+    float v = (float)(s->sumsq[c] / n) - m * m;
+    if (v < 0) v = 0.0f;
+
+    *mean   = m;
+    *std    = sqrtf(v);
+    *rms    = sqrtf((float)(s->sumsq[c] / n));
+    *energy = (float)s->sumsq[c];
+}
+
+// Std of the angle integrated from one gyro ring over the window (see
+// features.c). O(n), but only adds: the running sums cannot give it.
+static float stream_angle_std(const feat_stream_t* s, int c) {
+    double a = 0.0, sum = 0.0, sq = 0.0;
+    int i = s->head;                       // oldest sample
+    for (int k = 0; k < s->n; k++) {
+        a   += (double)s->ring[c][i];
+        sum += a;
+        sq  += a * a;
+        if (++i >= s->n) i = 0;
+    }
+    const double m = sum / (double)s->n;
+    double v = sq / (double)s->n - m * m;
+    if (v < 0.0) v = 0.0;
+    return (float)sqrt(v) / s->fs_hz;
+}
+
+void feat_stream_get(const feat_stream_t* s, feat_vec_t* out) {
+    feat_stream_get_gated(s, NULL, NULL, out);
+}
+
+// gate == NULL: every stage runs.
+bool feat_stream_get_gated(const feat_stream_t* s, const feat_gate_t* gate,
+                           feat_stage_counts_t* counts, feat_vec_t* out)
+{
+    feat_stage_counts_t unused;
+    if (!counts) counts = &unused;
+    memset(out, 0, sizeof(*out));
+    if (s->n <= 0) return false;
+
+    // 1) time-domain stats
+    stream_stats(s, FS_CH_AMAG, &out->amag.mean, &out->amag.std, &out->amag.rms, &out->amag.energy);
+    counts->windows++;
+
+    // 2) gyro stability (std only)
+    float m, sd, r, e;
+    stream_stats(s, FS_CH_GX, &m, &sd, &r, &e); out->gx_std = sd;
+    stream_stats(s, FS_CH_GY, &m, &sd, &r, &e); out->gy_std = sd;
+    stream_stats(s, FS_CH_GZ, &m, &sd, &r, &e); out->gz_std = sd;
+    counts->gyro_std++;
+
+    if (gate && !feat_gate_motion(gate, out)) {
+        feat_gate_idle(out, true);
+        return false;
+    }
+
+    // 3) orientation deltas: pitch/roll integrated from gy/gx over the window
+    out->d_pitch_std = stream_angle_std(s, FS_CH_GY);
+    out->d_roll_std  = stream_angle_std(s, FS_CH_GX);
+
+    // 4) spectrum: demeaning only zeroes X_0, and a (periodic) Hann window is
+    //    the 3-tap kernel Xw_k = 0.5 X_k - 0.25 (X_{k-1} + X_{k+1})
+    const float df = s->fs_hz / (float)s->n;
+    double bp1_acc = 0.0;
+    double bp2_acc = 0.0;
+    float best_mag2 = 0.0f;
+    float best_freq = 0.0f;
+
+    for (int k = 1; k <= s->kmax; k++) {
+        const float lo_re = (k > 1) ? s->re[k - 2] : 0.0f;
+        const float lo_im = (k > 1) ? s->im[k - 2] : 0.0f;
+        const float wr = 0.5f * s->re[k - 1] - 0.25f * (lo_re + s->re[k]);
+        const float wi = 0.5f * s->im[k - 1] - 0.25f * (lo_im + s->im[k]);
+        const float mag2 = wr * wr + wi * wi;
+
+        const float freq = df * (float)k;
+        if (mag2 > best_mag2) { best_mag2 = mag2; best_freq = freq; }
+        if (freq >= 0.5f && freq < 3.0f) bp1_acc += (double)mag2;
+        else if (freq >= 3.0f && freq <= 10.0f) bp2_acc += (double)mag2;
+    }
+
+    if (best_mag2 <= 0.0f) best_freq = 0.0f;
+    out->amag.dom_freq = best_freq;
+    out->amag.bp1 = (float)bp1_acc;
+    out->amag.bp2 = (float)bp2_acc;
+    counts->spectral++;
+    return true;
+}
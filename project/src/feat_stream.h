@@ -0,0 +1,70 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "features.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming counterpart of compute_features(): push one sample at a time and
+// query the feature vector of the most recent window whenever needed.
+// Time-domain stats use running sums; the 0–10 Hz spectrum uses sliding-DFT
+// bins, so each push costs O(K) and each query O(K) instead of O(N·K); only
+// the orientation deltas walk the gyro rings (additions, O(N)).
+
+#ifndef FEAT_STREAM_MAX_SAMPLES
+#define FEAT_STREAM_MAX_SAMPLES 512   // longest supported window
+#endif
+#ifndef FEAT_STREAM_MAX_BINS
+#define FEAT_STREAM_MAX_BINS    64    // DFT bins kept (1..kmax+1); kmax = 10 Hz * n / fs
+#endif
+// Bins a window of n samples at fs Hz needs (integer form of the init check).
+#define FEAT_STREAM_BINS(n, fs) ((10 * (n)) / (fs) + 1)
+
+enum { FS_CH_AMAG = 0, FS_CH_GX, FS_CH_GY, FS_CH_GZ, FS_NUM_CH };
+
+typedef struct {
+    int   n;            // window length [samples]
+    float fs_hz;
+    int   kmax;         // highest bin used for features (<= 10 Hz)
+    int   nbins;        // bins maintained = kmax + 1 (Hann needs k+1)
+
+    int   head;         // next write position in the rings
+    int   filled;       // samples seen, saturates at n
+    int   block_pos;    // position inside the current re-sync block
+
+    float ring[FS_NUM_CH][FEAT_STREAM_MAX_SAMPLES];
+    float cos_tab[FEAT_STREAM_MAX_SAMPLES];   // cos(2*pi*i/n)
+    float sin_tab[FEAT_STREAM_MAX_SAMPLES];   // sin(2*pi*i/n)
+
+    // sliding DFT of the amag window, bins k = 1..nbins
+    float re[FEAT_STREAM_MAX_BINS], im[FEAT_STREAM_MAX_BINS];
+    // exact DFT of the block being collected; swapped in every n samples to
+    // stop float round-off from accumulating in the sliding bins
+    float sh_re[FEAT_STREAM_MAX_BINS], sh_im[FEAT_STREAM_MAX_BINS];
+    int   sh_phase[FEAT_STREAM_MAX_BINS];
+
+    double sum[FS_NUM_CH], sumsq[FS_NUM_CH];
+    double sh_sum[FS_NUM_CH], sh_sumsq[FS_NUM_CH];
+} feat_stream_t;
+
+// Returns false if n or fs_hz are out of range (n is not clamped), or if the
+// 0-10 Hz range needs more than FEAT_STREAM_MAX_BINS bins.
+bool feat_stream_init(feat_stream_t* s, int n, float fs_hz);
+void feat_stream_push(feat_stream_t* s,
+                      float ax, float ay, float az,
+                      float gx, float gy, float gz);
+static inline bool feat_stream_ready(const feat_stream_t* s) { return s->filled >= s->n; }
+// Features of the last n pushed samples (same layout as compute_features).
+void feat_stream_get(const feat_stream_t* s, feat_vec_t* out);
+// Same behind the motion gate (see compute_features_gated). The stats come
+// from the running sums, so only the orientation deltas (a ring walk) and the
+// spectral query are skipped; the per-push sliding DFT has to keep running to
+// stay valid.
+bool feat_stream_get_gated(const feat_stream_t* s, const feat_gate_t* gate,
+                           feat_stage_counts_t* counts, feat_vec_t* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,11 @@
 #include <stdint.h>
 #include "features.h"
 
+// Spectral back-end: SPECTRAL_METHOD_FFT takes precedence, then Goertzel,
+// otherwise the rotating-phasor DFT.
+#ifndef SPECTRAL_METHOD_FFT
+#define SPECTRAL_METHOD_FFT 0
+#endif
 #ifndef SPECTRAL_METHOD_GOERTZEL
 #define SPECTRAL_METHOD_GOERTZEL 1
 #endif
@@ -30,8 +35,25 @@ static void stats_basic(const float* x, int n, float* mean, float* std, float* r
     *energy = (float)sq;                 // un-normalized energy (sum of squares)
 }
 
+// Std over the window of the angle integrated from a rate, relative to the
+// window start: deg for a dps input. Small-angle, one axis at a time.
+static float angle_std(const float* rate, int n, float fs_hz) {
+    double c = 0.0, s = 0.0, sq = 0.0;
+    for (int i = 0; i < n; i++) {
+        c  += (double)rate[i];
+        s  += c;
+        sq += c * c;
+    }
+    const double m = s / (double)n;
+    double v = sq / (double)n - m * m;
+    if (v < 0.0) v = 0.0;
+    return (float)sqrt(v) / fs_hz;
+}
+
 // ===================== tiny spectral helpers =====================
 
+// Periodic Hann (denominator n): the n-point DFT of the windowed signal is
+// then exactly the 3-tap kernel feat_stream.c applies to its sliding bins.
 static void hann_window(int n, float *w) {
     if (n <= 0) return;
     if (n == 1) { w[0] = 1.0f; return; }
@@ -44,7 +66,7 @@ static void hann_window(int n, float *w) {
 
     if (cached_n != n) {
         for (int i = 0; i < n; i++) {
-            cached[i] = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)i / (float)(n - 1)));
+            cached[i] = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)i / (float)n));
         }
         cached_n = n;
     }
@@ -52,6 +74,91 @@ static void hann_window(int n, float *w) {
     memcpy(w, cached, (size_t)n * sizeof(float));
 }
 
+#if SPECTRAL_METHOD_FFT
+// ===================== real FFT (SPECTRAL_METHOD_FFT) =====================
+// Packed real-input FFT: the m real samples are viewed as m/2 complex values
+// z[i] = x[2i] + j*x[2i+1], transformed with the lab_algorithms/fft.c radix-2
+// kernel (table-driven twiddles instead of the recurrence) and split into the
+// m/2+1 bins of the real spectrum. Everything is single precision.
+
+typedef struct { float re, im; } c32;
+
+enum { FFT_MAX_SIZE = 2048 };
+
+static c32 fft_buf[FFT_MAX_SIZE / 2];
+static float fft_tw_re[FFT_MAX_SIZE / 2];      // cos(2*pi*i/m)
+static float fft_tw_im[FFT_MAX_SIZE / 2];      // -sin(2*pi*i/m)
+static uint16_t fft_rev[FFT_MAX_SIZE / 2];     // bit reversal for m/2 points
+static int fft_cached_m = 0;
+
+static int next_pow2(int n) {
+    int m = 1;
+    while (m < n) m <<= 1;
+    return m;
+}
+
+static void fft_prepare(int m) {
+    if (fft_cached_m == m) return;
+
+    for (int i = 0; i < m / 2; i++) {
+        const float a = 2.0f * (float)M_PI * (float)i / (float)m;
+        fft_tw_re[i] = cosf(a);
+        fft_tw_im[i] = -sinf(a);
+    }
+
+    const int h = m / 2;
+    int logh = 0;
+    while ((1 << logh) < h) logh++;
+    for (int i = 0; i < h; i++) {
+        unsigned v = (unsigned)i, r = 0u;
+        for (int b = 0; b < logh; b++) { r = (r << 1) | (v & 1u); v >>= 1u; }
+        fft_rev[i] = (uint16_t)r;
+    }
+    fft_cached_m = m;
+}
+
+// In-place forward radix-2 FFT of h = m/2 points using the m-point tables.
+static void fft_radix2_tab(c32 *x, int h, int m) {
+    for (int i = 0; i < h; i++) {
+        const int j = fft_rev[i];
+        if (j > i) { c32 t = x[i]; x[i] = x[j]; x[j] = t; }
+    }
+
+    for (int len = 2; len <= h; len <<= 1) {
+        const int half = len >> 1;
+        const int stride = m / len;           // W_len^j = W_m^(j*m/len)
+        for (int k = 0; k < h; k += len) {
+            for (int j = 0; j < half; j++) {
+                const float wr = fft_tw_re[j * stride];
+                const float wi = fft_tw_im[j * stride];
+                c32 *u = &x[k + j];
+                c32 *t = &x[k + j + half];
+                const float tr = wr * t->re - wi * t->im;
+                const float ti = wr * t->im + wi * t->re;
+                t->re = u->re - tr; t->im = u->im - ti;
+                u->re += tr;        u->im += ti;
+            }
+        }
+    }
+}
+
+// |X_k|^2 of the real m-point spectrum from the packed m/2-point result.
+static float rfft_bin_mag2(const c32 *z, int m, int k) {
+    const int h = m / 2;
+    const c32 a = z[k % h];
+    const c32 b = z[(h - k) % h];
+
+    const float er = 0.5f * (a.re + b.re), ei = 0.5f * (a.im - b.im);   // even part
+    const float or_ = 0.5f * (a.im + b.im), oi = -0.5f * (a.re - b.re); // odd part
+    const float wr = (k < h) ? fft_tw_re[k] : -1.0f;
+    const float wi = (k < h) ? fft_tw_im[k] : 0.0f;
+
+    const float xr = er + wr * or_ - wi * oi;
+    const float xi = ei + wr * oi + wi * or_;
+    return xr * xr + xi * xi;
+}
+#endif
+
 static void spectral_features_capped(const float *x, int n, float fs,
                                      float *dom_freq, float *bp1, float *bp2)
 {
@@ -84,7 +191,37 @@ static void spectral_features_capped(const float *x, int n, float fs,
     float best_mag2 = 0.0f;
     float best_freq = 0.0f;
 
-#if SPECTRAL_METHOD_GOERTZEL
+#if SPECTRAL_METHOD_FFT
+    // zero-pad to the next power of two; df shrinks to fs/m, and band sums
+    // are scaled by n/m so they stay comparable with the unpadded back-ends
+    const int m = next_pow2(n);
+    const int h = m / 2;
+    fft_prepare(m);
+
+    for (int i = 0; i < h; i++) {
+        const int i0 = 2 * i, i1 = 2 * i + 1;
+        fft_buf[i].re = (i0 < n) ? work[i0] : 0.0f;
+        fft_buf[i].im = (i1 < n) ? work[i1] : 0.0f;
+    }
+    fft_radix2_tab(fft_buf, h, m);
+
+    const float dfm = fs / (float)m;
+    int kmax_m = (int)floorf(10.0f / dfm);
+    if (kmax_m > h) kmax_m = h;
+
+    float bp1_f = 0.0f, bp2_f = 0.0f;
+    for (int k = 1; k <= kmax_m; k++) {
+        const float mag2 = rfft_bin_mag2(fft_buf, m, k);
+        const float freq = dfm * (float)k;
+        if (mag2 > best_mag2) { best_mag2 = mag2; best_freq = freq; }
+        if (freq >= 0.5f && freq < 3.0f) bp1_f += mag2;
+        else if (freq >= 3.0f && freq <= 10.0f) bp2_f += mag2;
+    }
+
+    const float pad_scale = (float)n / (float)m;
+    bp1_acc = (double)(bp1_f * pad_scale);
+    bp2_acc = (double)(bp2_f * pad_scale);
+#elif SPECTRAL_METHOD_GOERTZEL
     for (int k = 1; k <= kmax; k++) {
         const double omega = 2.0 * M_PI * (double)k / (double)n;
         const double cosw = cos(omega);
@@ -161,12 +298,39 @@ static void spectral_features_capped(const float *x, int n, float fs,
     *bp2 = (float)bp2_acc;
 }
 
+// Widest max - min over the three gyro axes. A std is at most half the range,
+// so a narrow range rules motion out without the std passes.
+static float gyro_range_max(const float* gx, const float* gy, const float* gz, int n) {
+    const float* ch[3] = { gx, gy, gz };
+    float widest = 0.0f;
+    for (int c = 0; c < 3; c++) {
+        float lo = ch[c][0], hi = ch[c][0];
+        for (int i = 1; i < n; i++) {
+            if (ch[c][i] < lo) lo = ch[c][i];
+            if (ch[c][i] > hi) hi = ch[c][i];
+        }
+        if (hi - lo > widest) widest = hi - lo;
+    }
+    return widest;
+}
+
 // ===================== public API =====================
 
 void compute_features(const float* ax, const float* ay, const float* az,
                       const float* gx, const float* gy, const float* gz,
                       int n, float fs_hz, feat_vec_t* out)
 {
+    compute_features_gated(ax, ay, az, gx, gy, gz, n, fs_hz, NULL, NULL, out);
+}
+
+// gate == NULL: every stage runs.
+bool compute_features_gated(const float* ax, const float* ay, const float* az,
+                            const float* gx, const float* gy, const float* gz,
+                            int n, float fs_hz, const feat_gate_t* gate,
+                            feat_stage_counts_t* counts, feat_vec_t* out)
+{
+    feat_stage_counts_t unused;
+    if (!counts) counts = &unused;
     memset(out, 0, sizeof(*out));
 
     // 1) accel magnitude
@@ -179,19 +343,37 @@ void compute_features(const float* ax, const float* ay, const float* az,
 
     // 2) time-domain stats
     stats_basic(amag, n, &out->amag.mean, &out->amag.std, &out->amag.rms, &out->amag.energy);
+    counts->windows++;
+
+    const bool amag_moving = !gate || out->amag.std > gate->amag_std;
+    if (!amag_moving) {
+        counts->gyro_range++;
+        if (n < 1 || gyro_range_max(gx, gy, gz, n) <= 2.0f * gate->gyro_std_dps) {
+            feat_gate_idle(out, false);
+            return false;
+        }
+    }
 
-    // 3) spectrum on demeaned amag (dominant freq + bandpowers)
-    spectral_features_capped(amag, n, fs_hz, &out->amag.dom_freq, &out->amag.bp1, &out->amag.bp2);
-
-    // 4) gyro stability (std only)
+    // 3) gyro stability (std only)
     float m, s, r, e;
     stats_basic(gx, n, &m, &s, &r, &e); out->gx_std = s;
     stats_basic(gy, n, &m, &s, &r, &e); out->gy_std = s;
     stats_basic(gz, n, &m, &s, &r, &e); out->gz_std = s;
+    counts->gyro_std++;
+
+    if (!amag_moving && !feat_gate_motion(gate, out)) {
+        feat_gate_idle(out, true);
+        return false;
+    }
+
+    // 4) orientation deltas: pitch/roll integrated from gy/gx over the window
+    out->d_pitch_std = angle_std(gy, n, fs_hz);
+    out->d_roll_std  = angle_std(gx, n, fs_hz);
 
-    // 5) simple orientation deltas (placeholder: scaled gyro stds)
-    out->d_pitch_std = out->gy_std * 0.001f;
-    out->d_roll_std  = out->gx_std * 0.001f;
+    // 5) spectrum on demeaned amag (dominant freq + bandpowers)
+    spectral_features_capped(amag, n, fs_hz, &out->amag.dom_freq, &out->amag.bp1, &out->amag.bp2);
+    counts->spectral++;
+    return true;
 }
 
 void quantize_features_u8(const feat_vec_t* f, uint8_t* out_buf, int* out_len) {
@@ -206,7 +388,7 @@ void quantize_features_u8(const feat_vec_t* f, uint8_t* out_buf, int* out_len) {
     int k = 0;
     for (int i = 0; i < 5; i++) {
         float x = v[i];
-        if (x < 0) x = 0;
+        if (!(x > 0)) x = 0;   // also NaN
         if (x > 1) x = 1;
         out_buf[k++] = (uint8_t)lrintf(x * 255.0f);
     }
@@ -1,4 +1,6 @@
 #pragma once
+#include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -18,7 +20,7 @@ typedef struct {
 typedef struct {
     amag_feats_t amag;
     float gx_std, gy_std, gz_std;       // gyro stability
-    float d_pitch_std, d_roll_std;      // orientation deltas
+    float d_pitch_std, d_roll_std;      // std of pitch/roll integrated from gy/gx [deg]
 } feat_vec_t;
 
 // Compute features for one window (lab-style)
@@ -26,6 +28,50 @@ void compute_features(const float* ax, const float* ay, const float* az,
                       const float* gx, const float* gy, const float* gz,
                       int n, float fs_hz, feat_vec_t* out);
 
+// ---- Staged evaluation ----
+// Cheap time-domain stages first; the spectrum (and the classifier) only run
+// when a motion gate fires. A window is moving if the accel magnitude std or
+// the std of any gyro axis exceeds the gate. With the default thresholds an
+// idle window is one classify_rules() (and the shipped tree) calls NONE
+// whatever its spectrum; the CLASSIFIER_NN network gives no such guarantee.
+typedef struct {
+    float amag_std;         // [g]
+    float gyro_std_dps;     // [dps]
+} feat_gate_t;
+
+#define FEAT_GATE_AMAG_STD      0.01f   // classify_rules(): TILT needs > 0.01, SHAKE > 0.05
+#define FEAT_GATE_GYRO_STD_DPS  10.0f   // classify_rules(): CIRCLE needs a mean gyro std > 10
+
+// Per-stage run counts, accumulated by the *_gated() calls.
+typedef struct {
+    uint32_t windows;       // stage 0: amag stats, every window
+    uint32_t gyro_range;    // stage 1: gyro min/max (amag below the gate)
+    uint32_t gyro_std;      // stage 2: gyro stds (stage 1 could not rule motion out)
+    uint32_t spectral;      // stage 3: spectrum, classifier (gate fired)
+} feat_stage_counts_t;
+
+static inline bool feat_gate_motion(const feat_gate_t* g, const feat_vec_t* f) {
+    return f->amag.std > g->amag_std || f->gx_std > g->gyro_std_dps ||
+           f->gy_std > g->gyro_std_dps || f->gz_std > g->gyro_std_dps;
+}
+
+// Sets the fields an idle window skipped to NaN, so a log tells them from
+// measured zeros and training drops the row.
+static inline void feat_gate_idle(feat_vec_t* f, bool gyro_std_done) {
+    if (!gyro_std_done) f->gx_std = f->gy_std = f->gz_std = NAN;
+    f->d_pitch_std = f->d_roll_std = NAN;
+    f->amag.dom_freq = f->amag.bp1 = f->amag.bp2 = NAN;
+}
+
+// compute_features() behind the gate. Returns true if the window is moving
+// (out is then identical to compute_features()). Idle windows keep the amag
+// stats and whatever gyro stds were computed; the skipped fields are NaN
+// (feat_gate_idle).
+bool compute_features_gated(const float* ax, const float* ay, const float* az,
+                            const float* gx, const float* gy, const float* gz,
+                            int n, float fs_hz, const feat_gate_t* gate,
+                            feat_stage_counts_t* counts, feat_vec_t* out);
+
 // Optional: quantize feature vector to u8 (for logging/bandwidth tests)
 void quantize_features_u8(const feat_vec_t* f, uint8_t* out_buf, int* out_len);
 
@@ -0,0 +1,279 @@
+// project/src/features_q15.c
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include "features_q15.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum { FQ_MAX_SAMPLES = 2048 };
+
+// ===================== integer helpers =====================
+
+static uint32_t isqrt32(uint32_t x) {
+    uint32_t r = 0, bit = 1u << 30;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= r + bit) { x -= r + bit; r = (r >> 1) + bit; }
+        else r >>= 1;
+        bit >>= 2;
+    }
+    return r;
+}
+
+static uint64_t isqrt64(uint64_t x) {
+    uint64_t r = 0, bit = 1ull << 62;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= r + bit) { x -= r + bit; r = (r >> 1) + bit; }
+        else r >>= 1;
+        bit >>= 2;
+    }
+    return r;
+}
+
+static inline int32_t sat16(int32_t v) {
+    return (v > 32767) ? 32767 : (v < -32768) ? -32768 : v;
+}
+
+static inline int16_t q15_from_float(float v) {
+    return (int16_t)sat16((int32_t)lrintf(v * 32768.0f));
+}
+
+// ===================== basic stats =====================
+// Sums stay exact in int64/uint64 (n <= 2048, |x| < 2^16); the only rounding
+// is the final integer sqrt and the float conversion.
+
+typedef struct {
+    int64_t  sum;
+    uint64_t sumsq;
+} qsums_t;
+
+static void stats_to_float(const qsums_t* s, int n, float scale,
+                           float* mean, float* std, float* rms, float* energy)
+{
+    const uint64_t nn = (uint64_t)n;
+    const uint64_t sum2 = (uint64_t)(s->sum < 0 ? -s->sum : s->sum);
+    const uint64_t var_n2 = nn * s->sumsq - sum2 * sum2;   // n^2 * var, >= 0
+
+    const float inv_n = scale / (float)n;
+    *mean   = (float)s->sum * inv_n;
+    *std    = (float)isqrt64(var_n2) * inv_n;
+    *rms    = (float)isqrt64(nn * s->sumsq) * inv_n;
+    *energy = (float)s->sumsq * scale * scale;
+}
+
+static void gyro_std(const int16_t* x, int n, int16_t bias, float scale, float* std) {
+    qsums_t s = {0, 0};
+    for (int i = 0; i < n; i++) {
+        const int32_t v = (int32_t)x[i] - bias;
+        const uint32_t a = (uint32_t)(v < 0 ? -v : v);
+        s.sum += v;
+        s.sumsq += a * a;
+    }
+    float m, r, e;
+    stats_to_float(&s, n, scale, &m, std, &r, &e);
+}
+
+// Std of the angle integrated from one gyro axis (see features.c). The running
+// sum is block-scaled to 15 bits, like the FFT input, so the stats stay exact.
+static void angle_std_q(const int16_t* x, int n, int16_t bias, float scale, float fs, float* std) {
+    static int32_t cum[FQ_MAX_SAMPLES];
+    int32_t c = 0, peak = 0;
+    for (int i = 0; i < n; i++) {
+        c += (int32_t)x[i] - bias;          // |c| < 2048 * 2^16
+        cum[i] = c;
+        const int32_t a = c < 0 ? -c : c;
+        if (a > peak) peak = a;
+    }
+    int sh = 0;
+    while ((peak >> sh) >= (1 << 15)) sh++;
+
+    qsums_t s = {0, 0};
+    for (int i = 0; i < n; i++) {
+        const int32_t v = cum[i] >> sh;
+        const uint32_t a = (uint32_t)(v < 0 ? -v : v);
+        s.sum += v;
+        s.sumsq += a * a;
+    }
+    float m, r, e;
+    stats_to_float(&s, n, ldexpf(scale, sh) / fs, &m, std, &r, &e);
+}
+
+// ===================== Q15 DFT =====================
+// The bins of the default float back-ends (Goertzel/DFT in features.c): k*fs/n
+// up to 10 Hz, on the demeaned, Hann-windowed magnitude, so dom_freq and the
+// band edges are the same bins. The block is normalized to |x| < 2^14 first
+// (block floating point) and every product with a Q15 twiddle is rounded back
+// to that scale, so a bin sum stays below n * 2^14 and fits int32.
+
+enum { FQ_MAX_BINS = 256 };   // MAX_CAPPED_BINS of features.c
+
+static int32_t fq_amag[FQ_MAX_SAMPLES];
+static int16_t fq_hann[FQ_MAX_SAMPLES];
+static int16_t fq_cos[FQ_MAX_SAMPLES];   // cos(2*pi*i/n) in Q15
+static int16_t fq_sin[FQ_MAX_SAMPLES];   // sin(2*pi*i/n) in Q15
+static int fq_n = 0;
+
+static void fq_prepare(int n) {
+    if (fq_n == n) return;
+    for (int i = 0; i < n; i++) {
+        fq_hann[i] = q15_from_float(0.5f * (1.0f - cosf(2.0f * (float)M_PI * (float)i / (float)n)));
+        const float a = 2.0f * (float)M_PI * (float)i / (float)n;
+        fq_cos[i] = q15_from_float(cosf(a));
+        fq_sin[i] = q15_from_float(sinf(a));
+    }
+    fq_n = n;
+}
+
+static void spectral_q15(const int32_t* amag, int n, int32_t mean, float fs, float scale,
+                         float* dom_freq, float* bp1, float* bp2)
+{
+    *dom_freq = 0.0f; *bp1 = 0.0f; *bp2 = 0.0f;
+    if (n <= 1 || fs <= 0.0f) return;
+
+    // same bin range as spectral_features_capped() in features.c
+    const float df = fs / (float)n;
+    int kmax = (int)floorf(10.0f / df);
+    if (kmax > n / 2) kmax = n / 2;
+    if (kmax < 1) return;
+    if (kmax > FQ_MAX_BINS) kmax = FQ_MAX_BINS;
+    fq_prepare(n);
+
+    // demean + Hann (Q15), then normalize the block to [2^13, 2^14)
+    int32_t peak = 0;
+    for (int i = 0; i < n; i++) {
+        const int32_t y = ((amag[i] - mean) * (int32_t)fq_hann[i]) >> 15;
+        fq_amag[i] = y;
+        const int32_t a = y < 0 ? -y : y;
+        if (a > peak) peak = a;
+    }
+    if (peak == 0) return;
+
+    int sh = 0;
+    if (peak >= (1 << 14)) {
+        while ((peak >> -sh) >= (1 << 14)) sh--;
+    } else {
+        while ((peak << (sh + 1)) < (1 << 14)) sh++;
+    }
+    for (int i = 0; i < n; i++) {
+        fq_amag[i] = sh >= 0 ? (fq_amag[i] << sh) : (fq_amag[i] >> -sh);
+    }
+
+    uint64_t best_mag2 = 0, bp1_acc = 0, bp2_acc = 0;
+    float best_freq = 0.0f;
+    for (int k = 1; k <= kmax; k++) {
+        int32_t re = 0, im = 0;
+        int idx = 0;   // k*i mod n
+        for (int i = 0; i < n; i++) {
+            const int32_t x = fq_amag[i];
+            re += (x * fq_cos[idx] + (1 << 14)) >> 15;
+            im -= (x * fq_sin[idx] + (1 << 14)) >> 15;
+            idx += k;
+            if (idx >= n) idx -= n;
+        }
+        const uint64_t mag2 = (uint64_t)((int64_t)re * re) + (uint64_t)((int64_t)im * im);
+
+        const float freq = df * (float)k;
+        if (mag2 > best_mag2) { best_mag2 = mag2; best_freq = freq; }
+        if (freq >= 0.5f && freq < 3.0f) bp1_acc += mag2;
+        else if (freq >= 3.0f && freq <= 10.0f) bp2_acc += mag2;
+    }
+
+    // undo the block scaling, then counts -> g
+    const float to_g2 = ldexpf(scale * scale, -2 * sh);
+    *dom_freq = best_mag2 ? best_freq : 0.0f;
+    *bp1 = (float)bp1_acc * to_g2;
+    *bp2 = (float)bp2_acc * to_g2;
+}
+
+// Widest max - min over the three gyro axes in raw counts (see features.c).
+static int32_t gyro_range_max_q(const int16_t* gx, const int16_t* gy, const int16_t* gz, int n) {
+    const int16_t* ch[3] = { gx, gy, gz };
+    int32_t widest = 0;
+    for (int c = 0; c < 3; c++) {
+        int32_t lo = ch[c][0], hi = ch[c][0];
+        for (int i = 1; i < n; i++) {
+            if (ch[c][i] < lo) lo = ch[c][i];
+            if (ch[c][i] > hi) hi = ch[c][i];
+        }
+        if (hi - lo > widest) widest = hi - lo;
+    }
+    return widest;
+}
+
+// ===================== public API =====================
+
+void compute_features_q15(const int16_t* ax, const int16_t* ay, const int16_t* az,
+                          const int16_t* gx, const int16_t* gy, const int16_t* gz,
+                          int n, float fs_hz, const featq_cfg_t* cfg, feat_vec_t* out)
+{
+    compute_features_q15_gated(ax, ay, az, gx, gy, gz, n, fs_hz, cfg, NULL, NULL, out);
+}
+
+// gate == NULL: every stage runs.
+bool compute_features_q15_gated(const int16_t* ax, const int16_t* ay, const int16_t* az,
+                                const int16_t* gx, const int16_t* gy, const int16_t* gz,
+                                int n, float fs_hz, const featq_cfg_t* cfg,
+                                const feat_gate_t* gate, feat_stage_counts_t* counts,
+                                feat_vec_t* out)
+{
+    feat_stage_counts_t unused;
+    if (!counts) counts = &unused;
+    memset(out, 0, sizeof(*out));
+    if (n <= 0) return false;
+    if (n > FQ_MAX_SAMPLES) n = FQ_MAX_SAMPLES;
+
+    // 1) accel magnitude in raw counts (bias-corrected, saturated to int16
+    //    so the sum of squares fits in 32 bits)
+    static int32_t amag[FQ_MAX_SAMPLES];
+    qsums_t s = {0, 0};
+    for (int i = 0; i < n; i++) {
+        const int32_t x = sat16((int32_t)ax[i] - cfg->accel_bias[0]);
+        const int32_t y = sat16((int32_t)ay[i] - cfg->accel_bias[1]);
+        const int32_t z = sat16((int32_t)az[i] - cfg->accel_bias[2]);
+        const uint32_t m = isqrt32((uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z));
+        amag[i] = (int32_t)m;
+        s.sum += m;
+        s.sumsq += (uint64_t)(m * m);
+    }
+
+    // 2) time-domain stats
+    stats_to_float(&s, n, cfg->accel_scale,
+                   &out->amag.mean, &out->amag.std, &out->amag.rms, &out->amag.energy);
+    counts->windows++;
+
+    const bool amag_moving = !gate || out->amag.std > gate->amag_std;
+    if (!amag_moving) {
+        counts->gyro_range++;
+        const float range = (float)gyro_range_max_q(gx, gy, gz, n) * cfg->gyro_scale;
+        if (range <= 2.0f * gate->gyro_std_dps) {
+            feat_gate_idle(out, false);
+            return false;
+        }
+    }
+
+    // 3) gyro stability (std only)
+    gyro_std(gx, n, cfg->gyro_bias[0], cfg->gyro_scale, &out->gx_std);
+    gyro_std(gy, n, cfg->gyro_bias[1], cfg->gyro_scale, &out->gy_std);
+    gyro_std(gz, n, cfg->gyro_bias[2], cfg->gyro_scale, &out->gz_std);
+    counts->gyro_std++;
+
+    if (!amag_moving && !feat_gate_motion(gate, out)) {
+        feat_gate_idle(out, true);
+        return false;
+    }
+
+    // 4) orientation deltas: pitch/roll integrated from gy/gx over the window
+    angle_std_q(gy, n, cfg->gyro_bias[1], cfg->gyro_scale, fs_hz, &out->d_pitch_std);
+    angle_std_q(gx, n, cfg->gyro_bias[0], cfg->gyro_scale, fs_hz, &out->d_roll_std);
+
+    // 5) spectrum on demeaned amag
+    const int32_t mean = (int32_t)((s.sum + n / 2) / n);
+    spectral_q15(amag, n, mean, fs_hz, cfg->accel_scale,
+                 &out->amag.dom_freq, &out->amag.bp1, &out->amag.bp2);
+    counts->spectral++;
+    return true;
+}
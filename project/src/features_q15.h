@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include "features.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Integer counterpart of compute_features() for the FPU-less Cortex-M0+.
+// Works on the raw int16 samples from imuDataAccGyrGet(): integer sqrt for
+// the accel magnitude, int32/uint64 sums for the stats and a block-scaled
+// Q15 DFT over the bins of the default float back-end for dom_freq/bp1/bp2.
+// Floats are only touched when the final feature vector is written, so the
+// classifier is unchanged.
+
+typedef struct {
+    int16_t accel_bias[3];   // raw counts subtracted before the magnitude
+    int16_t gyro_bias[3];    // raw counts subtracted before the gyro stats
+    float accel_scale;       // g per LSB
+    float gyro_scale;        // dps per LSB
+} featq_cfg_t;
+
+void compute_features_q15(const int16_t* ax, const int16_t* ay, const int16_t* az,
+                          const int16_t* gx, const int16_t* gy, const int16_t* gz,
+                          int n, float fs_hz, const featq_cfg_t* cfg, feat_vec_t* out);
+// Same behind the motion gate (see compute_features_gated); the gyro range
+// check runs on the raw counts.
+bool compute_features_q15_gated(const int16_t* ax, const int16_t* ay, const int16_t* az,
+                                const int16_t* gx, const int16_t* gy, const int16_t* gz,
+                                int n, float fs_hz, const featq_cfg_t* cfg,
+                                const feat_gate_t* gate, feat_stage_counts_t* counts,
+                                feat_vec_t* out);
+
+#ifdef __cplusplus
+}
+#endif
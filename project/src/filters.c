@@ -1,6 +1,16 @@
 #include "filters.h"
 
-
-void filters_placeholder_init(void) {
-
+int16_t avg8_update(avg8_t* s, int16_t v) {
+    if (!s->primed) {
+        for (int i = 0; i < 8; ++i) s->buf[i] = v;
+        s->sum = (int32_t)v * 8;
+        s->idx = 0;
+        s->primed = true;
+        return v;
+    }
+    s->sum -= s->buf[s->idx];
+    s->buf[s->idx] = v;
+    s->sum += v;
+    s->idx = (s->idx + 1) & 7;
+    return (int16_t)(s->sum >> 3);
 }
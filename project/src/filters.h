@@ -1,9 +1,22 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// O(1) 8-sample moving average of raw int16 counts, used by the consumer
+// and the driver's FastRead functions. The first value primes the whole window, so the output starts at
+// the first sample instead of ramping up from zero.
+typedef struct {
+    int16_t buf[8];
+    int32_t sum;
+    uint8_t idx;
+    bool primed;
+} avg8_t;
 
+int16_t avg8_update(avg8_t* s, int16_t v);
 
 #ifdef __cplusplus
 }
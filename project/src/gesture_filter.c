@@ -0,0 +1,90 @@
+// project/src/gesture_filter.c
+#include <string.h>
+#include "gesture_filter.h"
+#include "classifier.h"
+
+// Confusion of classify() (the shipped gesture_model.h) on the synthetic
+// session of host/imu_decide_sim, 1 s / 0.5 s windows at 100 Hz; rows are the
+// true gesture. Regenerate with `imu_decide_sim --fit` after changing the
+// classifier or the windows.
+static const float kFullConfusion[GF_N_CLASSES][GF_N_CLASSES] = {
+    { 0.526f, 0.072f, 0.360f, 0.042f },   // NONE
+    { 0.004f, 0.825f, 0.166f, 0.004f },   // SHAKE
+    { 0.023f, 0.004f, 0.969f, 0.004f },   // TILT
+    { 0.004f, 0.480f, 0.155f, 0.361f },   // CIRCLE
+};
+static const float kEarlyConfusion[GF_N_CLASSES][GF_N_CLASSES] = {
+    { 0.879f, 0.034f, 0.002f, 0.084f },   // NONE
+    { 0.102f, 0.889f, 0.004f, 0.004f },   // SHAKE
+    { 0.165f, 0.004f, 0.004f, 0.828f },   // TILT
+    { 0.101f, 0.003f, 0.003f, 0.892f },   // CIRCLE
+};
+
+void gesture_filter_default_cfg(gesture_filter_cfg_t* cfg) {
+    cfg->p_stay = 0.8f;
+    cfg->enter = 0.6f;
+    memcpy(cfg->full, kFullConfusion, sizeof(cfg->full));
+    memcpy(cfg->early, kEarlyConfusion, sizeof(cfg->early));
+}
+
+void gesture_filter_confusion(float table[GF_N_CLASSES][GF_N_CLASSES],
+                              const uint32_t counts[GF_N_CLASSES][GF_N_CLASSES]) {
+    for (int g = 0; g < GF_N_CLASSES; g++) {
+        uint32_t total = GF_N_CLASSES;
+        for (int c = 0; c < GF_N_CLASSES; c++) total += counts[g][c];
+        for (int c = 0; c < GF_N_CLASSES; c++) table[g][c] = (float)(counts[g][c] + 1u) / (float)total;
+    }
+}
+
+void gesture_filter_init(gesture_filter_t* f, const gesture_filter_cfg_t* cfg) {
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    f->post[G_NONE] = 1.0f;
+    f->decision = G_NONE;
+    f->confidence = 1.0f;
+}
+
+bool gesture_filter_update(gesture_filter_t* f, int cls, bool early) {
+    if (cls < 0 || cls >= GF_N_CLASSES) return false;
+
+    // predict: stay, or move to any other class uniformly
+    const float p = f->cfg.p_stay;
+    const float q = (1.0f - p) / (GF_N_CLASSES - 1);
+    // observe: P(classifier says cls | gesture g)
+    const float (*emit)[GF_N_CLASSES] = early ? f->cfg.early : f->cfg.full;
+
+    float total = 0.0f;
+    for (int g = 0; g < GF_N_CLASSES; g++) {
+        const float prior = p * f->post[g] + q * (1.0f - f->post[g]);
+        f->post[g] = prior * emit[g][cls];
+        total += f->post[g];
+    }
+    int best = 0;
+    for (int g = 0; g < GF_N_CLASSES; g++) {
+        f->post[g] /= total;
+        if (f->post[g] > f->post[best]) best = g;
+    }
+
+    const bool changed = best != f->decision && f->post[best] >= f->cfg.enter;
+    if (changed) {
+        f->decision = best;
+        f->early = early;
+    }
+    f->confidence = f->post[f->decision];
+    return changed;
+}
+
+bool gesture_early_init(gesture_early_t* e, int n, int hop, int full_hop) {
+    if (n < 2 || hop < 1 || full_hop < 1) return false;
+    memset(e, 0, sizeof(*e));
+    e->n = n;
+    e->hop = hop;
+    e->full_hop = full_hop;
+    return true;
+}
+
+bool gesture_early_step(gesture_early_t* e) {
+    if (e->filled < e->n) e->filled++;
+    e->since_full++;
+    return e->filled >= e->n && e->since_full % e->hop == 0 && e->since_full % e->full_hop != 0;
+}
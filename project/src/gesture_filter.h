@@ -0,0 +1,76 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "features.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming decision layer on top of classify(). Per-window classes flicker
+// and only arrive once a full window covers the gesture; this turns them into
+// a held decision with a confidence, and lets shorter windows between the
+// hops bring the decision forward when they agree.
+//
+// gesture_filter_t is a forward HMM over the G_* classes: the gesture stays
+// the same from one observation to the next with probability p_stay, and
+// each observation is weighed by the classifier's confusion, P(classify()
+// says j | gesture i), one table for full windows and one for partial ones.
+// A partial window that cannot tell two gestures apart (a 0.5 s window has
+// 2 Hz bins, so a slow tilt looks like a circle) then moves the posterior
+// only as far as its confusion allows. The decision changes only when another
+// class's posterior reaches `enter` (hysteresis); confidence is the posterior
+// of the held class.
+//
+// gesture_early_t says when a partial window of the last n samples is due:
+// every `hop` samples between the full windows, which call
+// gesture_early_full() to realign the schedule. It keeps no samples; the
+// caller runs compute_features() on the tail of the float window it already
+// holds for the full windows.
+
+#define GF_N_CLASSES          4       // G_NONE .. G_CIRCLE
+
+typedef struct {
+    float p_stay;           // P(same gesture at the next observation)
+    float enter;            // posterior a class needs to take over the decision
+    float full[GF_N_CLASSES][GF_N_CLASSES];    // [gesture][class]: full windows
+    float early[GF_N_CLASSES][GF_N_CLASSES];   // same for partial windows
+} gesture_filter_cfg_t;
+
+typedef struct {
+    gesture_filter_cfg_t cfg;
+    float post[GF_N_CLASSES];
+    int decision;           // G_*, G_NONE until a class reaches cfg.enter
+    float confidence;       // post[decision]
+    bool early;             // the last change came from a partial window
+} gesture_filter_t;
+
+// p_stay 0.8, enter 0.6 and the confusion of the shipped classifier measured
+// by host/imu_decide_sim.
+void gesture_filter_default_cfg(gesture_filter_cfg_t* cfg);
+// Confusion tables from counts[gesture][class] (add-one smoothed).
+void gesture_filter_confusion(float table[GF_N_CLASSES][GF_N_CLASSES],
+                              const uint32_t counts[GF_N_CLASSES][GF_N_CLASSES]);
+void gesture_filter_init(gesture_filter_t* f, const gesture_filter_cfg_t* cfg);
+// One classifier output. Returns true if the decision changed.
+bool gesture_filter_update(gesture_filter_t* f, int cls, bool early);
+
+typedef struct {
+    int n;                  // partial window [samples]
+    int hop;                // samples between partial windows
+    int full_hop;           // samples between full windows
+    int filled, since_full;
+} gesture_early_t;
+
+// Returns false if n < 2 or a hop < 1.
+bool gesture_early_init(gesture_early_t* e, int n, int hop, int full_hop);
+// One more sample. Returns true when a partial window of the last n samples
+// is due; a due window never falls on a multiple of full_hop, where the full
+// window runs.
+bool gesture_early_step(gesture_early_t* e);
+// A full window was classified on this sample.
+static inline void gesture_early_full(gesture_early_t* e) { e->since_full = 0; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+// GENERATED by analysis/export_tree.py from the classify_rules() cascade (--rules); do not edit.
+#pragma once
+#include "dtree.h"
+
+// 1 tree(s), depth 9, 13 nodes. Features, in
+// classifier_features() order: amag_std, dom_freq, bp1, bp2, gx_std, gy_std, gz_std, gyro_std_mean
+#define GESTURE_MODEL_N_FEATURES 8
+
+static const dt_node_t kGestureModelNodes[] = {
+    {  1028443341, 0, 0, {    3,    1 } },   //    0: amag_std > 0.0500000007
+    {  1077936127, 1, 0, {    3,    2 } },   //    1: dom_freq > 2.99999976
+    {           0, 0, 1, {    2,    2 } },   //    2: -> SHAKE
+    {  1045220557, 1, 0, {    8,    4 } },   //    3: dom_freq > 0.200000003
+    {  1073741823, 1, 0, {    5,    8 } },   //    4: dom_freq > 1.99999988
+    {  1008981770, 0, 0, {    8,    6 } },   //    5: amag_std > 0.00999999978
+    {  1050253721, 0, 0, {    7,    8 } },   //    6: amag_std > 0.299999982
+    {           0, 0, 2, {    7,    7 } },   //    7: -> TILT
+    {  1092616192, 7, 0, {   12,    9 } },   //    8: gyro_std_mean > 10
+    {  1065353215, 1, 0, {   12,   10 } },   //    9: dom_freq > 0.99999994
+    {  1077936128, 1, 0, {   11,   12 } },   //   10: dom_freq > 3
+    {           0, 0, 3, {   11,   11 } },   //   11: -> CIRCLE
+    {           0, 0, 0, {   12,   12 } },   //   12: -> NONE
+};
+static const uint16_t kGestureModelRoots[] = { 0 };
+static const dt_model_t kGestureModel = {
+    kGestureModelNodes, kGestureModelRoots, 1, 9, 8, 4,
+};
@@ -0,0 +1,78 @@
+// GENERATED by analysis/export_nn.py from classify_rules() on synthetic windows (--rules); do not edit.
+#pragma once
+#include "nn_int8.h"
+
+// [1x5] -> dense 16 relu -> dense 16 relu -> dense 4
+// 400 MACs, 32 B arena. Accuracy on 4000 held-out windows: float 0.971, int8 0.961.
+// Input: quantize_features_u8() - 128: amag_std, dom_freq/10, gx_std/300, gy_std/300, gz_std/300
+#define GESTURE_NN_INPUT       NN_INPUT_FEATURES
+#define GESTURE_NN_IN_LEN      1
+#define GESTURE_NN_IN_CH       5
+#define GESTURE_NN_ARENA_BYTES 32
+
+static const int8_t kGestureNnW0[80] = {
+    9, -42, 1, 2, 2, -106, 6, -1, -6, 5, 8, -9, -19, -6, -15, -1,
+    48, -9, -8, -13, -3, 54, 1, 1, 1, -2, -14, 2, 16, -16, -127, 12,
+    -1, 1, -6, -2, -2, -10, 5, -13, 42, 0, -3, -19, -8, 36, 18, 4,
+    14, 10, 8, -32, 1, -6, -15, 3, 62, 3, -7, -11, -4, -26, -3, -10,
+    -7, -5, -8, -5, -7, -4, 0, 10, -63, -60, -61, -9, 6, -8, 37, -40,
+};
+static const int32_t kGestureNnB0[16] = {
+    -329, -12222, -3450, 1184, 4266, -3151, -14469, -3247,
+    1751, 9317, -3279, 7281, -2192, -3712, -20954, -2756,
+};
+static const int8_t kGestureNnW1[256] = {
+    32, -7, 5, 23, -10, 2, 11, -9, 3, -14, 25, -13, 2, 3, 57, -25,
+    26, 5, 8, 32, 5, -5, 23, 11, -5, -9, 20, -38, 27, -3, 31, -5,
+    10, 9, 13, -52, -50, 1, -12, -5, 4, 0, -21, 42, 26, 0, 3, 13,
+    9, 62, 6, -21, 33, -1, 60, 3, 16, 17, 15, -1, -21, 0, 1, 8,
+    32, 63, 5, -19, 3, 0, 65, -13, 8, 1, 6, -3, 22, 8, -15, -5,
+    -11, 1, -13, -4, -4, 4, -3, -5, -2, -3, -6, -12, -1, 1, 1, 9,
+    -41, -38, -11, 20, 5, -8, -68, -7, 4, 12, -21, 4, -7, 4, 7, 0,
+    4, -13, -6, -1, -6, -7, -4, -1, -3, 2, 3, 2, -6, 1, -10, -14,
+    -6, -1, -13, 1, 6, -9, 7, 20, -2, -4, -4, -19, -7, 5, -3, 2,
+    -24, -28, 13, 48, 53, 0, -37, -10, 25, 37, 6, 34, -28, 2, -5, -51,
+    27, -23, 8, 0, -60, -2, -9, -2, 2, -3, 18, -10, 38, -5, 29, -10,
+    -24, -51, -5, 1, 16, -7, -69, 5, 16, 20, -15, 5, -8, 9, 2, -8,
+    -37, -39, -14, 59, 55, 3, -41, -3, -16, 3, -19, 36, -26, 0, 7, -4,
+    35, 29, 16, -3, 6, -9, 45, 8, -3, -17, 30, 1, 7, -8, -7, -20,
+    11, -13, 2, -3, -109, -1, -7, -1, -6, -8, -4, 15, 7, -6, 127, 16,
+    -8, 62, -16, 5, 24, 3, 79, -13, -43, -25, 7, 9, -14, 2, 12, 14,
+};
+static const int32_t kGestureNnB1[16] = {
+    10903, 15885, -676, 22871, 21369, -6499, -19321, -7781,
+    -3561, 3763, 520, -15044, -4534, 14077, 3128, 12366,
+};
+static const int8_t kGestureNnW2[64] = {
+    28, 30, -32, 14, 4, 13, -19, -2, -6, 10, 18, -23, 13, 6, -5, 34,
+    1, -9, -27, 8, -43, 10, 43, 0, 2, 14, -42, 37, 21, -29, 0, -17,
+    -15, -19, 30, -112, 4, 1, -2, -4, -3, -74, 11, -5, -127, -5, 30, -81,
+    -35, -8, 18, -7, 29, 0, -15, -3, -8, -2, -11, -6, -13, 10, -77, -1,
+};
+static const int32_t kGestureNnB2[4] = {
+    10541, -4089, -47360, -16446,
+};
+static const nn_layer_t kGestureNnLayers[] = {
+    { kGestureNnW0, kGestureNnB0, 2045819030, 37, -128, 1, NN_DENSE, 1, 5, 1, 1, 1, 16 },   // out scale 0.0174398
+    { kGestureNnW1, kGestureNnB1, 2102762641, 38, -128, 1, NN_DENSE, 1, 16, 1, 1, 1, 16 },   // out scale 0.132112
+    { kGestureNnW2, kGestureNnB2, 1116553194, 38, 76, 0, NN_DENSE, 1, 16, 1, 1, 1, 4 },   // out scale 2.10791
+};
+static const nn_model_t kGestureNn = {
+    kGestureNnLayers, 3, 5, 4, GESTURE_NN_ARENA_BYTES,
+    0.00392156863f, -128, 2.10791321f, 76,
+};
+
+// Inputs and outputs of the integer reference in export_nn.py.
+#define GESTURE_NN_N_TESTS 4
+static const int8_t kGestureNnTestIn[GESTURE_NN_N_TESTS][5] = {
+    { -126, 97, -127, -123, -124 },
+    { -94, -116, -128, -95, -125 },
+    { -63, -71, -111, -127, -66 },
+    { 17, -125, -122, -68, -126 },
+};
+static const int8_t kGestureNnTestOut[GESTURE_NN_N_TESTS][4] = {
+    { 107, 88, -104, 67 },
+    { 79, 57, 81, 75 },
+    { 73, 68, 71, 78 },
+    { 82, 56, 67, 77 },
+};
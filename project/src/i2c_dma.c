@@ -0,0 +1,94 @@
+// project/src/i2c_dma.c
+#include "i2c_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+static i2c_dma_t *s_dma;   // single instance served by the IRQ handler
+
+static void i2c_dma_irq_handler(void) {
+    i2c_dma_t *d = s_dma;
+    if (!d || !dma_channel_get_irq0_status((uint)d->rx_chan)) return;
+    dma_channel_acknowledge_irq0((uint)d->rx_chan);
+
+    i2c_hw_t *hw = i2c_get_hw(d->i2c);
+    bool ok = (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) == 0;
+    if (!ok) (void)hw->clr_tx_abrt;
+    if (d->on_done) d->on_done(d->user, ok);
+}
+
+bool i2c_dma_init(i2c_dma_t *d, i2c_inst_t *i2c, uint8_t addr, i2c_dma_done_fn on_done, void *user) {
+    if (s_dma) return false;
+
+    d->i2c = i2c;
+    d->addr = addr;
+    d->on_done = on_done;
+    d->user = user;
+    d->tx_chan = dma_claim_unused_channel(false);
+    d->rx_chan = dma_claim_unused_channel(false);
+    if (d->tx_chan < 0 || d->rx_chan < 0) {
+        if (d->tx_chan >= 0) dma_channel_unclaim((uint)d->tx_chan);
+        if (d->rx_chan >= 0) dma_channel_unclaim((uint)d->rx_chan);
+        return false;
+    }
+
+    i2c_get_hw(i2c)->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+
+    s_dma = d;
+    dma_channel_set_irq0_enabled((uint)d->rx_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, i2c_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    return true;
+}
+
+bool i2c_dma_start_read(void *ctx, uint8_t reg, uint8_t *buf, size_t n) {
+    i2c_dma_t *d = (i2c_dma_t *)ctx;
+    if (n == 0 || n > I2C_DMA_MAX_READ) return false;
+    if (dma_channel_is_busy((uint)d->tx_chan) || dma_channel_is_busy((uint)d->rx_chan)) return false;
+
+    i2c_hw_t *hw = i2c_get_hw(d->i2c);
+    if (hw->tar != d->addr) {
+        hw->enable = 0;
+        hw->tar = d->addr;
+        hw->enable = 1;
+    }
+
+    // register write, then n reads: RESTART on the first, STOP on the last
+    d->cmd[0] = reg;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t c = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0) c |= I2C_IC_DATA_CMD_RESTART_BITS;
+        if (i == n - 1) c |= I2C_IC_DATA_CMD_STOP_BITS;
+        d->cmd[1 + i] = c;
+    }
+
+    // RX first so it is armed before the first byte can arrive
+    dma_channel_config rc = dma_channel_get_default_config((uint)d->rx_chan);
+    channel_config_set_transfer_data_size(&rc, DMA_SIZE_8);
+    channel_config_set_read_increment(&rc, false);
+    channel_config_set_write_increment(&rc, true);
+    channel_config_set_dreq(&rc, i2c_get_dreq(d->i2c, false));
+    dma_channel_configure((uint)d->rx_chan, &rc, buf, &hw->data_cmd, n, true);
+
+    dma_channel_config tc = dma_channel_get_default_config((uint)d->tx_chan);
+    channel_config_set_transfer_data_size(&tc, DMA_SIZE_32);
+    channel_config_set_read_increment(&tc, true);
+    channel_config_set_write_increment(&tc, false);
+    channel_config_set_dreq(&tc, i2c_get_dreq(d->i2c, true));
+    dma_channel_configure((uint)d->tx_chan, &tc, &hw->data_cmd, d->cmd, n + 1, true);
+    return true;
+}
+
+void i2c_dma_abort(void *ctx) {
+    i2c_dma_t *d = (i2c_dma_t *)ctx;
+    i2c_hw_t *hw = i2c_get_hw(d->i2c);
+
+    // aborting can raise the completion IRQ; keep it quiet meanwhile
+    dma_channel_set_irq0_enabled((uint)d->rx_chan, false);
+    dma_channel_abort((uint)d->tx_chan);
+    dma_channel_abort((uint)d->rx_chan);
+    dma_channel_acknowledge_irq0((uint)d->rx_chan);
+    dma_channel_set_irq0_enabled((uint)d->rx_chan, true);
+
+    (void)hw->clr_tx_abrt;
+    while (hw->rxflr) (void)hw->data_cmd;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// RP2040 DMA transport for icm_async: one TX channel feeds IC_DATA_CMD with
+// the register write and the read commands, one RX channel drains the RX
+// FIFO into the caller's buffer. The CPU is only involved to start the
+// transfer and in the RX-complete IRQ (DMA_IRQ_0, shared handler; the SD
+// driver uses DMA_IRQ_1).
+//
+// A NACK aborts the I2C transfer and the RX channel never finishes; the
+// caller detects that with a deadline and calls i2c_dma_abort().
+
+#define I2C_DMA_MAX_READ 32
+
+typedef void (*i2c_dma_done_fn)(void *user, bool ok);
+
+typedef struct {
+    i2c_inst_t *i2c;
+    uint8_t addr;
+    int tx_chan;
+    int rx_chan;
+    i2c_dma_done_fn on_done;
+    void *user;
+    uint32_t cmd[1 + I2C_DMA_MAX_READ];
+} i2c_dma_t;
+
+// Claims two DMA channels and installs the IRQ handler. The bus must already
+// be set up with i2c_init(). Only one instance is supported.
+bool i2c_dma_init(i2c_dma_t *d, i2c_inst_t *i2c, uint8_t addr, i2c_dma_done_fn on_done, void *user);
+
+// icm_async_transport_t callbacks (ctx = i2c_dma_t*).
+bool i2c_dma_start_read(void *ctx, uint8_t reg, uint8_t *buf, size_t n);
+void i2c_dma_abort(void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
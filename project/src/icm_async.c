@@ -0,0 +1,64 @@
+// project/src/icm_async.c
+#include <string.h>
+#include "icm_async.h"
+
+void icm_async_init(icm_async_t *a, const icm_async_transport_t *tp, const int16_t gyro_offset[3]) {
+    memset(a, 0, sizeof(*a));
+    a->tp = *tp;
+    if (gyro_offset) memcpy(a->gyro_offset, gyro_offset, sizeof(a->gyro_offset));
+    a->state = ICM_ASYNC_IDLE;
+}
+
+bool icm_async_start(icm_async_t *a, uint64_t t_us, uint32_t timeout_us) {
+    if (a->state == ICM_ASYNC_BUSY) {
+        if (t_us < a->deadline_us) {
+            a->skipped++;
+            return false;
+        }
+        // the previous transfer never finished: drop it and reuse the bus
+        if (a->tp.abort) a->tp.abort(a->tp.ctx);
+        a->timeouts++;
+        a->state = ICM_ASYNC_IDLE;
+    } else if (a->state == ICM_ASYNC_READY) {
+        a->skipped++;
+        return false;
+    }
+
+    a->t_us = t_us;
+    a->deadline_us = t_us + timeout_us;
+    a->state = ICM_ASYNC_BUSY;
+    a->started++;
+    if (!a->tp.start_read(a->tp.ctx, ICM_ASYNC_REG_ACCEL_XOUT_H, a->buf, sizeof a->buf)) {
+        a->errors++;
+        a->state = ICM_ASYNC_ERROR;
+        return false;
+    }
+    return true;
+}
+
+void icm_async_on_complete(icm_async_t *a, bool ok) {
+    if (a->state != ICM_ASYNC_BUSY) return;   // late completion after an abort
+    if (ok) {
+        a->completed++;
+        a->state = ICM_ASYNC_READY;
+    } else {
+        a->errors++;
+        a->state = ICM_ASYNC_ERROR;
+    }
+}
+
+bool icm_async_take(icm_async_t *a, imu_sample_t *out) {
+    if (a->state != ICM_ASYNC_READY) return false;
+
+    const uint8_t *b = a->buf;
+    out->t_us = a->t_us;
+    out->ax = (int16_t)((b[0] << 8) | b[1]);
+    out->ay = (int16_t)((b[2] << 8) | b[3]);
+    out->az = (int16_t)((b[4] << 8) | b[5]);
+    out->gx = (int16_t)((int32_t)(int16_t)((b[6]  << 8) | b[7])  - a->gyro_offset[0]);
+    out->gy = (int16_t)((int32_t)(int16_t)((b[8]  << 8) | b[9])  - a->gyro_offset[1]);
+    out->gz = (int16_t)((int32_t)(int16_t)((b[10] << 8) | b[11]) - a->gyro_offset[2]);
+
+    a->state = ICM_ASYNC_IDLE;
+    return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sample_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Non-blocking ICM-20948 accel+gyro read (one 12-byte burst from
+// ACCEL_XOUT_H) as a small state machine on top of an abstract transport:
+// i2c_dma.c on the RP2040, a mock on the host (host/mock_i2c.c).
+//
+//   IDLE --start--> BUSY --complete(ok)--> READY --take--> IDLE
+//                    |  \--complete(err)-> ERROR --start--> BUSY
+//                    \--deadline passed at next start--> abort, counted
+//
+// start/complete/take may run in different IRQs, but never nested.
+
+#define ICM_ASYNC_REG_ACCEL_XOUT_H 0x2D
+#define ICM_ASYNC_BURST_BYTES      12
+
+typedef struct {
+    // Queue "write reg, repeated-start read n bytes into buf" and return at
+    // once; completion is reported through icm_async_on_complete().
+    bool (*start_read)(void *ctx, uint8_t reg, uint8_t *buf, size_t n);
+    // Cancel a transfer that never completed (e.g. NACK, bus stuck).
+    void (*abort)(void *ctx);
+    void *ctx;
+} icm_async_transport_t;
+
+typedef enum {
+    ICM_ASYNC_IDLE = 0,
+    ICM_ASYNC_BUSY,
+    ICM_ASYNC_READY,
+    ICM_ASYNC_ERROR,
+} icm_async_state_t;
+
+typedef struct {
+    icm_async_transport_t tp;
+    int16_t gyro_offset[3];        // subtracted like icm20948GyroFastRead()
+
+    volatile uint8_t state;        // icm_async_state_t
+    uint8_t buf[ICM_ASYNC_BURST_BYTES];
+    uint64_t t_us;                 // trigger time of the read in flight / ready
+    uint64_t deadline_us;
+
+    uint32_t started;
+    uint32_t completed;
+    uint32_t skipped;              // start while BUSY or READY (sample lost)
+    uint32_t errors;               // transport reported failure
+    uint32_t timeouts;             // BUSY past deadline, aborted
+} icm_async_t;
+
+void icm_async_init(icm_async_t *a, const icm_async_transport_t *tp, const int16_t gyro_offset[3]);
+
+// Kick off a read stamped with t_us. Returns false (and counts a skip) if the
+// previous read is still in flight or not yet taken.
+bool icm_async_start(icm_async_t *a, uint64_t t_us, uint32_t timeout_us);
+
+// Transport completion; called from the DMA IRQ on the RP2040.
+void icm_async_on_complete(icm_async_t *a, bool ok);
+
+// READY -> IDLE: decode the burst into *out. False if nothing is ready.
+bool icm_async_take(icm_async_t *a, imu_sample_t *out);
+
+static inline bool icm_async_busy(const icm_async_t *a) {
+    return a->state == ICM_ASYNC_BUSY;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+// project/src/imu_log_format.c
+#include <stddef.h>
+#include <string.h>
+#include "imu_log_format.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "imu_log_format: records are written as in-memory structs and must be little-endian"
+#endif
+
+_Static_assert(sizeof(imu_log_header_t) <= IMU_LOG_HEADER_BYTES, "log header exceeds one sector");
+_Static_assert(offsetof(imu_log_header_t, field) == IMU_LOG_SCHEMA_OFFSET, "header fixed part changed");
+_Static_assert(sizeof(imu_log_record_t) == 64, "imu_log_record_t must stay 64 bytes");
+_Static_assert(IMU_LOG_HEADER_BYTES % sizeof(imu_log_record_t) == 0, "records must not straddle sectors");
+_Static_assert(sizeof(imu_raw_record_t) == 16, "imu_raw_record_t must stay 16 bytes");
+_Static_assert(IMU_LOG_HEADER_BYTES % sizeof(imu_raw_record_t) == 0, "records must not straddle sectors");
+
+typedef struct {
+    const char *name;
+    uint8_t type;
+    uint8_t offset;
+    uint8_t decimals;
+} schema_entry_t;
+
+#define FIELD(col, member, t, dec) \
+    { col, t, (uint8_t)offsetof(imu_log_record_t, member), dec }
+
+static const schema_entry_t kSchema[] = {
+    FIELD("t_ms",     t_ms,     IMU_LOG_U32, 0),
+    FIELD("ax",       ax,       IMU_LOG_F32, 5),
+    FIELD("ay",       ay,       IMU_LOG_F32, 5),
+    FIELD("az",       az,       IMU_LOG_F32, 5),
+    FIELD("gx",       gx,       IMU_LOG_F32, 5),
+    FIELD("gy",       gy,       IMU_LOG_F32, 5),
+    FIELD("gz",       gz,       IMU_LOG_F32, 5),
+    FIELD("amag_std", amag_std, IMU_LOG_F32, 5),
+    FIELD("dom_freq", dom_freq, IMU_LOG_F32, 5),
+    FIELD("bp1",      bp1,      IMU_LOG_F32, 5),
+    FIELD("bp2",      bp2,      IMU_LOG_F32, 5),
+    FIELD("gx_std",   gx_std,   IMU_LOG_F32, 5),
+    FIELD("gy_std",   gy_std,   IMU_LOG_F32, 5),
+    FIELD("gz_std",   gz_std,   IMU_LOG_F32, 5),
+    FIELD("cls",      cls,      IMU_LOG_I8,  0),
+    FIELD("lat_ms",   lat_ms,   IMU_LOG_F32, 3),
+    FIELD("qbytes",   qbytes,   IMU_LOG_U8,  0),
+};
+
+#undef FIELD
+#define FIELD(col, member, t) \
+    { col, t, (uint8_t)offsetof(imu_raw_record_t, member), 0 }
+
+static const schema_entry_t kRawSchema[] = {
+    FIELD("t_us", t_us, IMU_LOG_U32),
+    FIELD("ax",   ax,   IMU_LOG_I16),
+    FIELD("ay",   ay,   IMU_LOG_I16),
+    FIELD("az",   az,   IMU_LOG_I16),
+    FIELD("gx",   gx,   IMU_LOG_I16),
+    FIELD("gy",   gy,   IMU_LOG_I16),
+    FIELD("gz",   gz,   IMU_LOG_I16),
+};
+
+_Static_assert(sizeof kSchema / sizeof kSchema[0] <= IMU_LOG_MAX_FIELDS, "schema too long");
+
+static void header_init(imu_log_header_t *h, const schema_entry_t *schema, unsigned n_fields,
+                        uint16_t record_bytes, uint32_t sample_hz, uint32_t win_ms, uint32_t hop_ms) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, IMU_LOG_MAGIC, sizeof h->magic);
+    h->version = IMU_LOG_VERSION;
+    h->header_bytes = IMU_LOG_HEADER_BYTES;
+    h->record_bytes = record_bytes;
+    h->n_fields = (uint16_t)n_fields;
+    h->sample_hz = sample_hz;
+    h->win_ms = win_ms;
+    h->hop_ms = hop_ms;
+    for (unsigned i = 0; i < n_fields; i++) {
+        strncpy(h->field[i].name, schema[i].name, IMU_LOG_NAME_LEN);
+        h->field[i].type = schema[i].type;
+        h->field[i].offset = schema[i].offset;
+        h->field[i].decimals = schema[i].decimals;
+    }
+}
+
+void imu_log_header_init(imu_log_header_t *h, uint32_t sample_hz, uint32_t win_ms, uint32_t hop_ms) {
+    header_init(h, kSchema, sizeof kSchema / sizeof kSchema[0], (uint16_t)sizeof(imu_log_record_t),
+                sample_hz, win_ms, hop_ms);
+}
+
+void imu_raw_header_init(imu_log_header_t *h, uint32_t sample_hz, imu_log_codec_t codec) {
+    header_init(h, kRawSchema, sizeof kRawSchema / sizeof kRawSchema[0], (uint16_t)sizeof(imu_raw_record_t),
+                sample_hz, 0, 0);
+    h->codec = codec;
+}
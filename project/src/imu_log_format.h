@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary per-window log (.bin), written by bin_logger and turned back into
+// the kCsvHeader CSV by host/imu_log2csv. The per-sample raw log (LOG_RAW_SD,
+// raw_logger) uses the same container with imu_raw_record_t records.
+//
+// Layout of the stream, all little-endian:
+//   [0, IMU_LOG_HEADER_BYTES)  imu_log_header_t, zero padded to 512 bytes
+//   then fixed-size records    imu_log_record_t, 8 per 512 bytes
+//                              (imu_raw_record_t: 32 per 512 bytes)
+// A plain file is this stream, so records tile its sectors. A journaled file
+// (SD_JOURNAL, log_journal.h) carries it in 500-byte block payloads, so
+// records straddle sectors there.
+//
+// The header carries the schema (column name, type, offset, print precision
+// per field), so a reader does not need this file to decode a log and older
+// logs stay readable when fields are added at the end of the record.
+//
+// Version 2 added `codec`. With IMU_LOG_CODEC_DELTA_VARINT the records after
+// the header are packed per sector by src/raw_codec.c; the schema describes
+// the decoded record. Version 1 files have codec 0 (the field was reserved).
+
+#define IMU_LOG_MAGIC         "IMUL"
+#define IMU_LOG_VERSION       2
+#define IMU_LOG_HEADER_BYTES  512
+#define IMU_LOG_MAX_FIELDS    24
+#define IMU_LOG_NAME_LEN      12
+#define IMU_LOG_SCHEMA_OFFSET 32      // byte offset of field[0] in the header
+
+typedef enum {
+    IMU_LOG_U8 = 1,
+    IMU_LOG_I8,
+    IMU_LOG_U16,
+    IMU_LOG_I16,
+    IMU_LOG_U32,
+    IMU_LOG_I32,
+    IMU_LOG_F32,
+} imu_log_type_t;
+
+typedef enum {
+    IMU_LOG_CODEC_NONE = 0,           // fixed-size records back to back
+    IMU_LOG_CODEC_DELTA_VARINT = 1,   // raw_codec sectors (imu_raw_record_t only)
+} imu_log_codec_t;
+
+typedef struct {
+    char    name[IMU_LOG_NAME_LEN];   // CSV column name, NUL padded
+    uint8_t type;                     // imu_log_type_t
+    uint8_t offset;                   // byte offset inside the record
+    uint8_t decimals;                 // CSV print precision (floats)
+    uint8_t reserved;
+} imu_log_field_t;
+
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_bytes;            // offset of the first record
+    uint16_t record_bytes;
+    uint16_t n_fields;
+    uint32_t sample_hz;
+    uint32_t win_ms;
+    uint32_t hop_ms;
+    uint32_t codec;                   // imu_log_codec_t
+    uint32_t reserved;
+    imu_log_field_t field[IMU_LOG_MAX_FIELDS];
+} imu_log_header_t;
+
+// One window: same columns and order as kCsvHeader in main.c.
+typedef struct {
+    uint32_t t_ms;
+    float    ax, ay, az;              // last sample of the window
+    float    gx, gy, gz;
+    float    amag_std, dom_freq, bp1, bp2;
+    float    gx_std, gy_std, gz_std;
+    float    lat_ms;
+    int8_t   cls;
+    uint8_t  qbytes;
+    uint16_t reserved;
+} imu_log_record_t;
+
+// One sample: raw ICM-20948 counts (scale with ACCEL_SCALE_G/GYRO_SCALE_DPS,
+// no bias removed) and the trigger timestamp in us since logging started.
+// t_us wraps after ~71 minutes.
+typedef struct {
+    uint32_t t_us;
+    int16_t  ax, ay, az;
+    int16_t  gx, gy, gz;
+} imu_raw_record_t;
+
+// Fills in magic, version, sizes and the schema of imu_log_record_t.
+void imu_log_header_init(imu_log_header_t *h, uint32_t sample_hz, uint32_t win_ms, uint32_t hop_ms);
+// Same for imu_raw_record_t; win_ms and hop_ms are 0.
+void imu_raw_header_init(imu_log_header_t *h, uint32_t sample_hz, imu_log_codec_t codec);
+
+#ifdef __cplusplus
+}
+#endif
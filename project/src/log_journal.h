@@ -0,0 +1,71 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Power-loss journal around a binary log (SD_JOURNAL). The log stream (the
+// imu_log header sector, then records or raw_codec sectors) is cut into
+// blocks that each carry their own sequence number and CRC:
+//
+//   sector 0       journal header: "IMUJ", version, block size, session id
+//   sectors 1, 2   checkpoint slots, written alternately on every sync:
+//                  "IMUC", session, generation, blocks on the card, payload
+//                  bytes, state (open / closed / recovered)
+//   sectors 3 ..   blocks: LOG_JOURNAL_PAYLOAD bytes of the stream, then
+//                  u16 len, u16 magic, u32 seq, u32 crc32
+//
+// All fields little-endian. Every CRC is seeded with the random session id,
+// so blocks left on the card by an older file never validate. Only the last
+// block of a closed log has len < LOG_JOURNAL_PAYLOAD. The valid blocks of a
+// log are the ones from 0 up to the first that fails its check; a reader
+// finds the end of an unclosed log by scanning forward from the newest
+// checkpoint instead of from the start.
+
+#define LOG_JOURNAL_MAGIC         "IMUJ"
+#define LOG_JOURNAL_VERSION       1
+#define LOG_JOURNAL_BLOCK_BYTES   512
+#define LOG_JOURNAL_TRAILER_BYTES 12
+#define LOG_JOURNAL_PAYLOAD       (LOG_JOURNAL_BLOCK_BYTES - LOG_JOURNAL_TRAILER_BYTES)
+#define LOG_JOURNAL_FIRST_BLOCK   3                    // file sector of block 0
+#define LOG_JOURNAL_SLOT(gen)     (1u + ((gen) & 1u))  // file sector of checkpoint gen
+
+enum {
+    LOG_JOURNAL_OPEN = 0,       // still being written, or cut off by power loss
+    LOG_JOURNAL_CLOSED = 1,     // closed normally: blocks/payload_bytes are final
+    LOG_JOURNAL_RECOVERED = 2,  // end found by a recovery scan and truncated there
+};
+
+typedef struct {
+    uint32_t gen;               // increments with every checkpoint written
+    uint32_t blocks;            // blocks known to be on the card
+    uint32_t payload_bytes;     // stream bytes in those blocks
+    uint32_t state;             // LOG_JOURNAL_*
+} log_journal_checkpoint_t;
+
+uint32_t log_journal_crc32(uint32_t seed, const void *data, size_t len);
+
+// Header sector (zero padded) for a new session.
+void log_journal_header(uint8_t *sector, uint32_t session);
+// false if sector is not a journal header of a version this code reads.
+bool log_journal_parse_header(const uint8_t *sector, uint32_t *session);
+
+void log_journal_checkpoint(uint8_t *sector, uint32_t session, const log_journal_checkpoint_t *cp);
+// false for a slot never written, torn, or from another session.
+bool log_journal_parse_checkpoint(const uint8_t *sector, uint32_t session, log_journal_checkpoint_t *cp);
+// The valid checkpoint with the higher generation of the two slots, or a
+// zero one if neither is valid. Returns false in that case.
+bool log_journal_newest_checkpoint(const uint8_t *slot1, const uint8_t *slot2, uint32_t session,
+                                   log_journal_checkpoint_t *cp);
+
+// Zero-pads the payload past len and writes the trailer of block seq.
+void log_journal_seal(uint8_t *block, uint32_t session, uint32_t seq, uint32_t len);
+// Payload length of block seq, or -1 if it is not that block of this session.
+int log_journal_check(const uint8_t *block, uint32_t session, uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
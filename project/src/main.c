@@ -7,6 +7,8 @@
 
 #include "pico/stdlib.h"
 #include "pico/time.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
 #include "hardware/i2c.h"
 
 #include "ff.h"
@@ -18,30 +20,54 @@
 #include "icm20948.h"
 #include "filters.h"
 #include "features.h"
+#include "feat_stream.h"
+#include "features_q15.h"
+#include "sample_ring.h"
+#include "icm_async.h"
+#include "i2c_dma.h"
 #include "classifier.h"
 #include "csv_logger.h"
+#include "bin_logger.h"
+#include "raw_logger.h"
+#include "sd_bench.h"
+#include "log_journal.h"
+#include "gesture_filter.h"
+#include "feat_ext.h"
+#if NN_BENCH
+#include "hardware/structs/systick.h"
+#include "nn_int8.h"
+#include "gesture_nn.h"
+#endif
 
 // -------------------- User-tunable basics --------------------
 #define CALIB_DURATION_SEC 2
 
-
-// -------------------- IMU scaling (ICM-20948) ----------------
-#define ACCEL_SCALE_G      (1.0f / 16384.0f)
-#define GYRO_SCALE_DPS     (1.0f / 32.8f)
-
-// -------------------- CSV logging ----------------------------
+// -------------------- SD logging -----------------------------
+// One record per window, as CSV lines or (LOG_BINARY) as 64-byte
+// imu_log_record_t records; host/imu_log2csv converts the latter back to the
+// same kCsvHeader columns. LOG_RAW_SD adds a second file with every sample.
 #define CSV_PATH_MAX  96
 #define CSV_LINE_MAX  192
 
 static FATFS g_fs;                     // FatFs must persist for mount lifetime
 static sd_card_t *g_sd = NULL;
 static const char *g_drive_prefix = NULL;
+#if LOG_BINARY
+static bin_logger_t g_bin_logger;
+#else
 static csv_logger_t g_csv_logger;
-static bool g_csv_logger_ready = false;
-static bool g_csv_logger_failed = false;
+#endif
+static bool g_log_ready = false;
+static bool g_log_failed = false;
+#if LOG_RAW_SD
+static raw_logger_t g_raw_logger;
+static bool g_raw_ready = false;
+#endif
 
+#if !LOG_BINARY
 static const char kCsvHeader[] =
     "t_ms,ax,ay,az,gx,gy,gz,amag_std,dom_freq,bp1,bp2,gx_std,gy_std,gz_std,cls,lat_ms,qbytes";
+#endif
 
 // -------------------- Derived sizes --------------------------
 #define WIN_SAMPLES ((SAMPLE_HZ * WIN_MS) / 1000)
@@ -49,6 +75,36 @@ static const char kCsvHeader[] =
 
 _Static_assert(WIN_SAMPLES > 0, "WIN_MS must yield at least one sample");
 _Static_assert(HOP_SAMPLES > 0, "HOP_MS must yield at least one sample");
+#if DECISION_FILTER && DECISION_EARLY
+#define EARLY_WIN_SAMPLES ((SAMPLE_HZ * EARLY_WIN_MS) / 1000)
+#define EARLY_HOP_SAMPLES ((SAMPLE_HZ * EARLY_HOP_MS) / 1000)
+_Static_assert(EARLY_WIN_SAMPLES >= 2 && EARLY_WIN_SAMPLES <= WIN_SAMPLES,
+               "EARLY_WIN_MS must give 2..WIN_SAMPLES samples (the tail of the full window)");
+_Static_assert(EARLY_HOP_SAMPLES > 0, "EARLY_HOP_MS must yield at least one sample");
+#endif
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_FIFO
+// Drain when the FIFO is about half full, but at least FIFO_ACCEL_HZ times a
+// second: every drain is also the accel read.
+#define FIFO_MAX_FRAMES   (ICM20948_FIFO_SIZE / ICM20948_FIFO_FRAME_BYTES)
+#define FIFO_FILL_US      ((FIFO_MAX_FRAMES / 2) * 1000000u / SAMPLE_HZ)
+#define FIFO_DRAIN_US     (FIFO_FILL_US < 1000000u / FIFO_ACCEL_HZ ? FIFO_FILL_US : 1000000u / FIFO_ACCEL_HZ)
+_Static_assert(1100 % SAMPLE_HZ == 0 && 1100 / SAMPLE_HZ <= 256,
+               "FIFO frames come at the gyro ODR, 1100/(1 + div) Hz: SAMPLE_HZ must divide 1100 (5..1100)");
+_Static_assert(FIFO_ACCEL_HZ > 0 && FIFO_ACCEL_HZ <= 1000, "FIFO_ACCEL_HZ out of range");
+#endif
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_DRDY
+// INT1 pulses when either sensor has new data, and nothing tells the two
+// apart, so only equal ODRs give one pulse per sample
+_Static_assert(SAMPLE_HZ == 25 || SAMPLE_HZ == 5,
+               "DRDY needs equal accel/gyro ODRs: SAMPLE_HZ must be 25 or 5 (25/k Hz)");
+#endif
+#if USE_I2C_DMA && SAMPLE_TRIGGER != SAMPLE_TRIGGER_TIMER && SAMPLE_TRIGGER != SAMPLE_TRIGGER_DRDY
+#error "USE_I2C_DMA needs SAMPLE_TRIGGER_TIMER or SAMPLE_TRIGGER_DRDY"
+#endif
+#if USE_STREAM_FEATS && !USE_FIXED_POINT
+_Static_assert(WIN_SAMPLES >= 2 && WIN_SAMPLES <= FEAT_STREAM_MAX_SAMPLES,
+               "WIN_SAMPLES out of range for the streaming feature engine");
+#endif
 
 // -------------------- Helpers -------------------------------
 static inline absolute_time_t add_interval(absolute_time_t t, uint32_t delta_us) {
@@ -59,6 +115,7 @@ static inline void report_fresult(const char *op, FRESULT fr) {
     printf("%s -> %s (%d)\n", op, FRESULT_str(fr), fr);
 }
 
+#if !LOG_BINARY
 static void format_csv_line(char *out, size_t n,
                             uint32_t t_ms,
                             float ax, float ay, float az,
@@ -72,6 +129,7 @@ static void format_csv_line(char *out, size_t n,
              amag_std, dom_f, bp1, bp2, gx_std, gy_std, gz_std,
              cls, lat_ms, qbytes);
 }
+#endif
 
 static bool ensure_sd_mounted(void) {
     if (g_drive_prefix) {
@@ -88,6 +146,12 @@ static bool ensure_sd_mounted(void) {
         printf("sd_get_by_num(0) returned NULL\n");
         return false;
     }
+    // slot 0 is SDIO unless the build defines SPI_SD0 (IMU_SD_IF=SPI, see hw_config.c)
+    if (g_sd->type == SD_IF_SDIO) {
+        printf("SD card 0: SDIO 4-bit, clk %u kHz\n", g_sd->sdio_if_p->baud_rate / 1000u);
+    } else {
+        printf("SD card 0: SPI, clk %u kHz\n", g_sd->spi_if_p->spi->baud_rate / 1000u);
+    }
 
     g_drive_prefix = sd_get_drive_prefix(g_sd);
     if (!g_drive_prefix) {
@@ -116,55 +180,208 @@ static bool ensure_sd_mounted(void) {
     return true;
 }
 
-static bool init_csv_logging(void) {
-    if (g_csv_logger_ready) return true;
-    if (g_csv_logger_failed) return false;
+#if SD_BENCH
+// Sustained MB/s and worst-case latency of the logging path for both record
+// sizes, through FatFs and in raw mode. Build once per IMU_SD_IF to compare
+// SPI against SDIO on the same card.
+#define SD_BENCH_CSV_LINE 134   // typical format_csv_line() output incl. '\n'
+
+static void run_sd_bench(void) {
+    static const struct { const char *name; uint32_t bytes; } kRecords[] = {
+        { "bin", sizeof(imu_log_record_t) },
+        { "csv", SD_BENCH_CSV_LINE },
+    };
+    const char *if_name = (g_sd->type == SD_IF_SDIO) ? "SDIO" : "SPI";
+
+    sd_bench_crc_t crc;
+    sd_bench_crc(&crc);
+    if (crc.sniffed) {
+        printf("SDBENCH: crc16/512B sw=%lu cycles dma_sniffer=%lu cycles (0x%04x/0x%04x%s)\n",
+               (unsigned long)crc.sw_cycles, (unsigned long)crc.sniff_cycles,
+               crc.sw_crc, crc.sniff_crc, crc.sw_crc == crc.sniff_crc ? "" : " MISMATCH");
+    } else {
+        printf("SDBENCH: crc16/512B sw=%lu cycles dma_sniffer=unavailable\n", (unsigned long)crc.sw_cycles);
+    }
+
+    sd_bench_codec_t codec;
+    sd_bench_codec(&codec);
+    printf("SDBENCH: raw_codec %lu samples -> %lu B (%.2f B/sample, ratio %.2f) pack=%lu unpack=%lu cycles/sample%s\n",
+           (unsigned long)codec.samples, (unsigned long)codec.packed_bytes,
+           (double)codec.packed_bytes / codec.samples,
+           (double)codec.samples * sizeof(imu_raw_record_t) / codec.packed_bytes,
+           (unsigned long)codec.enc_cycles, (unsigned long)codec.dec_cycles,
+           codec.exact ? "" : " MISMATCH");
+
+    char path[CSV_PATH_MAX];
+    snprintf(path, sizeof path, "%s/sdbench.tmp", g_drive_prefix);
+
+    for (unsigned i = 0; i < count_of(kRecords); i++) {
+        for (int raw = 0; raw <= 1; raw++) {
+            sd_bench_result_t r;
+            FRESULT fr = sd_bench_run(path, SD_BENCH_BYTES, kRecords[i].bytes, raw, &r);
+            if (fr != FR_OK) {
+                report_fresult("sd_bench_run", fr);
+                return;
+            }
+            printf("SDBENCH: if=%s rec=%s/%luB mode=%s %lu KB in %lu ms = %.2f MB/s | "
+                   "call max=%lu us | write avg=%lu max=%lu us | sync n=%lu max=%lu us | close=%lu us\n",
+                   if_name, kRecords[i].name, (unsigned long)kRecords[i].bytes,
+                   r.raw ? "raw" : (raw ? "fatfs(no raw)" : "fatfs"),
+                   (unsigned long)(r.bytes / 1024u), (unsigned long)(r.elapsed_us / 1000u),
+                   (double)r.bytes / (double)r.elapsed_us,
+                   (unsigned long)r.max_call_us,
+                   (unsigned long)(r.w.flushes ? r.w.total_write_us / r.w.flushes : 0),
+                   (unsigned long)r.w.max_write_us,
+                   (unsigned long)r.w.syncs, (unsigned long)r.w.max_sync_us,
+                   (unsigned long)r.close_us);
+        }
+    }
+}
+#endif
+
+#if SD_JOURNAL
+// Repairs the journaled logs a power cut left open (closed ones cost one
+// header read each). Each is cut after its last valid block, found by
+// scanning at most SD_JOURNAL_SCAN_BLOCKS past its newest checkpoint.
+static void recover_sd_logs(const char *logs_dir) {
+    DIR dir;
+    FILINFO fno;
+    if (f_opendir(&dir, logs_dir) != FR_OK) return;
+    while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0]) {
+        const size_t len = strlen(fno.fname);
+        if ((fno.fattrib & AM_DIR) || len < 4 || strcmp(fno.fname + len - 4, ".bin") != 0) continue;
+
+        char path[CSV_PATH_MAX];
+        snprintf(path, sizeof path, "%s/%s", logs_dir, fno.fname);
+        sd_writer_recovery_t r;
+        FRESULT fr = sd_writer_recover(path, &r);
+        if (fr != FR_OK) {
+            report_fresult("sd_writer_recover", fr);
+        } else if (r.journaled && r.state == LOG_JOURNAL_OPEN) {
+            printf("SD recovered %s: %lu blocks (checkpoint %lu, %lu scanned) in %lu us\n", path,
+                   (unsigned long)r.blocks, (unsigned long)r.checkpoint,
+                   (unsigned long)r.scanned, (unsigned long)r.us);
+        }
+    }
+    f_closedir(&dir);
+}
+#endif
+
+static bool init_sd_logging(void) {
+    if (g_log_ready) return true;
+    if (g_log_failed) return false;
 
     if (!ensure_sd_mounted()) {
-        g_csv_logger_failed = true;
+        g_log_failed = true;
         return false;
     }
+#if SD_BENCH
+    run_sd_bench();
+#endif
 
     char logs_dir[CSV_PATH_MAX];
     snprintf(logs_dir, sizeof logs_dir, "%s/logs", g_drive_prefix);
     FRESULT fr = f_mkdir(logs_dir);
     if (fr != FR_OK && fr != FR_EXIST) {
         report_fresult("f_mkdir(logs)", fr);
-        g_csv_logger_failed = true;
+        g_log_failed = true;
         return false;
     }
+#if SD_JOURNAL
+    recover_sd_logs(logs_dir);
+#endif
 
     uint32_t session_ms = to_ms_since_boot(get_absolute_time());
     char file_path[CSV_PATH_MAX];
+#if LOG_BINARY
+    snprintf(file_path, sizeof file_path, "%s/session_%lu.bin",
+             logs_dir, (unsigned long)session_ms);
+
+    imu_log_header_t header;
+    imu_log_header_init(&header, SAMPLE_HZ, WIN_MS, HOP_MS);
+    fr = bin_open(&g_bin_logger, file_path, &header);
+    if (fr != FR_OK) {
+        report_fresult("bin_open", fr);
+        g_log_failed = true;
+        return false;
+    }
+#else
     snprintf(file_path, sizeof file_path, "%s/session_%lu.csv",
              logs_dir, (unsigned long)session_ms);
 
     fr = csv_open(&g_csv_logger, file_path, kCsvHeader);
     if (fr != FR_OK) {
         report_fresult("csv_open", fr);
-        g_csv_logger_failed = true;
+        g_log_failed = true;
         return false;
     }
+#endif
+
+    g_log_ready = true;
+#if LOG_BINARY
+    const sd_writer_t *w = &g_bin_logger.w;
+#else
+    const sd_writer_t *w = &g_csv_logger.w;
+#endif
+    if (w->prealloc) {
+        printf("SD logging to %s (%lu KB reserved%s)\n", file_path, (unsigned long)(w->prealloc / 1024u),
+               w->raw_sd ? ", raw multi-block stream" : "");
+    } else {
+        printf("SD logging to %s (no contiguous space, growing per cluster)\n", file_path);
+    }
 
-    g_csv_logger_ready = true;
-    printf("SD logging to %s\n", file_path);
+#if LOG_RAW_SD
+    // the per-window log works without it, so a failure here is not fatal
+    snprintf(file_path, sizeof file_path, "%s/raw_%lu.bin", logs_dir, (unsigned long)session_ms);
+    imu_log_header_t raw_header;
+    imu_raw_header_init(&raw_header, SAMPLE_HZ, RAW_LOG_CODEC);
+    fr = raw_open(&g_raw_logger, file_path, &raw_header);
+    if (fr != FR_OK) {
+        report_fresult("raw_open", fr);
+    } else {
+        g_raw_ready = true;
+        printf("Raw samples to %s (%lu KB reserved, ring %d records%s)\n", file_path,
+               (unsigned long)(g_raw_logger.w.prealloc / 1024u), RAW_LOG_RING_LEN,
+               RAW_LOG_COMPRESS ? ", delta/varint packed" : "");
+    }
+#endif
     return true;
 }
 
-static void append_csv_line(uint32_t t_ms,
+static void append_sd_record(uint32_t t_ms,
                             float ax, float ay, float az,
                             float gx, float gy, float gz,
                             float amag_std, float dom_f, float bp1, float bp2,
                             float gx_std, float gy_std, float gz_std,
                             int cls, float lat_ms, int qbytes) {
-    if (g_csv_logger_failed) return;
-    if (!g_csv_logger_ready) {
-        if (!init_csv_logging()) {
-            printf("CSV logger disabled (init failed).\n");
+    if (g_log_failed) return;
+    if (!g_log_ready) {
+        if (!init_sd_logging()) {
+            printf("SD logger disabled (init failed).\n");
             return;
         }
     }
 
+#if LOG_BINARY
+    // no formatting on the device: raw floats straight into the sector buffer
+    const imu_log_record_t rec = {
+        .t_ms = t_ms,
+        .ax = ax, .ay = ay, .az = az,
+        .gx = gx, .gy = gy, .gz = gz,
+        .amag_std = amag_std, .dom_freq = dom_f, .bp1 = bp1, .bp2 = bp2,
+        .gx_std = gx_std, .gy_std = gy_std, .gz_std = gz_std,
+        .lat_ms = lat_ms,
+        .cls = (int8_t)cls,
+        .qbytes = (uint8_t)qbytes,
+    };
+    FRESULT fr = bin_append(&g_bin_logger, &rec);
+    if (fr != FR_OK) {
+        report_fresult("bin_append", fr);
+        bin_close(&g_bin_logger);
+        g_log_ready = false;
+        g_log_failed = true;
+    }
+#else
     char line[CSV_LINE_MAX];
     format_csv_line(line, sizeof line,
                     t_ms, ax, ay, az,
@@ -177,19 +394,738 @@ static void append_csv_line(uint32_t t_ms,
     if (fr != FR_OK) {
         report_fresult("csv_append", fr);
         csv_close(&g_csv_logger);
-        g_csv_logger_ready = false;
-        g_csv_logger_failed = true;
+        g_log_ready = false;
+        g_log_failed = true;
+    }
+#endif
+}
+
+// Background half of the SD writer, run by the consumer once the sample ring
+// is empty: writes a full buffer and syncs on the SD_SYNC_MS/SD_SYNC_BYTES
+// budget, for the per-window log and (LOG_RAW_SD) the raw sample log.
+// Returns true if it touched the card.
+static bool service_sd_logging(void) {
+    bool did_work = false;
+    if (g_log_ready) {
+#if LOG_BINARY
+        FRESULT fr = bin_service(&g_bin_logger, &did_work);
+        if (fr != FR_OK) bin_close(&g_bin_logger);
+#else
+        FRESULT fr = csv_service(&g_csv_logger, &did_work);
+        if (fr != FR_OK) csv_close(&g_csv_logger);
+#endif
+        if (fr != FR_OK) {
+            report_fresult("SD flush", fr);
+            g_log_ready = false;
+            g_log_failed = true;
+        }
+    }
+#if LOG_RAW_SD
+    if (g_raw_ready) {
+        bool raw_work = false;
+        FRESULT fr = raw_service(&g_raw_logger, &raw_work);
+        if (fr != FR_OK) {
+            report_fresult("raw SD flush", fr);
+            raw_close(&g_raw_logger);
+            g_raw_ready = false;
+        }
+        did_work = did_work || raw_work;
     }
+#endif
+    return did_work;
+}
+
+static const sd_writer_stats_t *sd_logging_stats(void) {
+    if (!g_log_ready) return NULL;
+#if LOG_BINARY
+    return &g_bin_logger.w.stats;
+#else
+    return &g_csv_logger.w.stats;
+#endif
 }
 
+// -------------------- Window processing ----------------------
+// Everything downstream of the I2C read: scaling, windowing, features,
+// classification and logging. Runs on core1 with USE_DUAL_CORE, otherwise
+// in the core0 main loop.
+static uint64_t g_t_start_us = 0;
+static float g_bias[6];                // accel [g] then gyro [dps], incl. gravity
+
+#if LOG_FEATURES && USE_FIXED_POINT
+// raw int16 counts: no per-sample FP math. Each sample is stored twice,
+// WIN_SAMPLES apart, so the window is always contiguous from ring_index and
+// features_q15.c reads it in place (same RAM as a ring plus a window copy).
+static int16_t ax_ring[2 * WIN_SAMPLES];
+static int16_t ay_ring[2 * WIN_SAMPLES];
+static int16_t az_ring[2 * WIN_SAMPLES];
+static int16_t gx_ring[2 * WIN_SAMPLES];
+static int16_t gy_ring[2 * WIN_SAMPLES];
+static int16_t gz_ring[2 * WIN_SAMPLES];
+static featq_cfg_t g_featq_cfg;
+#elif LOG_FEATURES && USE_STREAM_FEATS
+_Static_assert(WIN_SAMPLES <= FEAT_STREAM_MAX_SAMPLES, "WIN_MS too long for FEAT_STREAM_MAX_SAMPLES");
+_Static_assert(FEAT_STREAM_BINS(WIN_SAMPLES, SAMPLE_HZ) <= FEAT_STREAM_MAX_BINS,
+               "WIN_MS too long for the 0-10 Hz bins of FEAT_STREAM_MAX_BINS");
+static feat_stream_t feat_stream;
+#elif LOG_FEATURES
+// mirrored like the Q15 rings: the window, and the partial window at its
+// tail, are read in place by every float consumer (features, FX, early)
+static float ax_ring[2 * WIN_SAMPLES];
+static float ay_ring[2 * WIN_SAMPLES];
+static float az_ring[2 * WIN_SAMPLES];
+static float gx_ring[2 * WIN_SAMPLES];
+static float gy_ring[2 * WIN_SAMPLES];
+static float gz_ring[2 * WIN_SAMPLES];
+#endif
+
 #if LOG_FEATURES
-// copy a logical window from the ring buffer to a linear buffer
-static void copy_window(float *dst, const float *ring, int ring_size, int start_idx) {
-    for (int i = 0; i < ring_size; i++) {
-        int idx = start_idx + i;
-        if (idx >= ring_size) idx -= ring_size;
-        dst[i] = ring[idx];
+static int ring_index = 0;   // next write position
+static int ring_filled = 0;  // up to WIN_SAMPLES
+static int hop_accum  = 0;   // samples since last window
+
+// Idle windows skip the spectrum and the classifier (features.h, staged
+// evaluation); the counters show how often each stage ran.
+#if MOTION_GATE
+static const feat_gate_t g_gate_cfg = { FEAT_GATE_AMAG_STD, FEAT_GATE_GYRO_STD_DPS };
+static const feat_gate_t *const g_gate = &g_gate_cfg;
+#else
+static const feat_gate_t *const g_gate = NULL;
+#endif
+static feat_stage_counts_t g_stage_counts;
+#endif
+
+#if LOG_FEATURES && FEATURE_EXT
+_Static_assert(WIN_SAMPLES <= FX_MAX_SAMPLES, "WIN_MS too long for FX_MAX_SAMPLES");
+static uint32_t g_fx_mask = FEATURE_EXT_MASK;   // 0 stops the FX: lines
+#endif
+
+// FX and the partial windows need float samples. The float path reads them
+// from its rings; feat_stream and Q15 keep none, so they get a float window
+// of the longest span needed, and nothing more.
+#define FX_USED (LOG_FEATURES && FEATURE_EXT)
+#define EARLY_USED (LOG_FEATURES && DECISION_FILTER && DECISION_EARLY)
+#define FLOAT_WINDOW ((USE_FIXED_POINT || USE_STREAM_FEATS) && (FX_USED || EARLY_USED))
+#if FLOAT_WINDOW
+#if FX_USED
+#define FLOAT_WIN_SAMPLES WIN_SAMPLES
+#else
+#define FLOAT_WIN_SAMPLES EARLY_WIN_SAMPLES
+#endif
+_Static_assert(FLOAT_WIN_SAMPLES <= FX_MAX_SAMPLES, "float window longer than FX_MAX_SAMPLES");
+static fx_window_t g_float_win;
+static float g_float_win_buf[FX_WINDOW_FLOATS(FLOAT_WIN_SAMPLES)];
+#endif
+
+#if FX_USED || EARLY_USED
+// Oldest of the last len float samples of channel c (ax, ay, az, gx, gy, gz).
+static const float *float_window(int c, int len) {
+#if FLOAT_WINDOW
+    return fx_window_channel(&g_float_win, c) + (g_float_win.n - len);
+#else
+    static float *const rings[6] = { ax_ring, ay_ring, az_ring, gx_ring, gy_ring, gz_ring };
+    return &rings[c][ring_index + WIN_SAMPLES - len];
+#endif
+}
+#endif
+
+#if LOG_FEATURES && DECISION_FILTER
+static gesture_filter_t g_decision;
+#if DECISION_EARLY
+static gesture_early_t g_early;        // partial-window schedule; samples via float_window()
+#endif
+
+static void update_decision(uint32_t t_ms, int cls, bool early) {
+    if (gesture_filter_update(&g_decision, cls, early)) {
+        printf("DECISION: %lu %s conf=%.2f%s\n", (unsigned long)t_ms,
+               gesture_name(g_decision.decision), g_decision.confidence,
+               g_decision.early ? " (early)" : "");
+    }
+}
+#endif
+
+static void process_sample(const imu_sample_t *s) {
+    const uint32_t t_ms = (uint32_t)((s->t_us - g_t_start_us) / 1000u);
+
+    // scale + bias-correct
+    const float ax = (float)s->ax * ACCEL_SCALE_G - g_bias[0];
+    const float ay = (float)s->ay * ACCEL_SCALE_G - g_bias[1];
+    const float az = (float)s->az * ACCEL_SCALE_G - g_bias[2];
+    const float gx = (float)s->gx * GYRO_SCALE_DPS - g_bias[3];
+    const float gy = (float)s->gy * GYRO_SCALE_DPS - g_bias[4];
+    const float gz = (float)s->gz * GYRO_SCALE_DPS - g_bias[5];
+
+#if LOG_RAW
+    // per-sample CSV (useful for debugging or offline feature checks)
+    printf("%lu,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f\n",
+           (unsigned long)t_ms, ax, ay, az, gx, gy, gz);
+#endif
+
+#if LOG_FEATURES
+#if FLOAT_WINDOW
+    fx_window_push(&g_float_win, ax, ay, az, gx, gy, gz);
+#elif !USE_FIXED_POINT && !USE_STREAM_FEATS
+    // update rings
+    ax_ring[ring_index] = ax_ring[ring_index + WIN_SAMPLES] = ax;
+    ay_ring[ring_index] = ay_ring[ring_index + WIN_SAMPLES] = ay;
+    az_ring[ring_index] = az_ring[ring_index + WIN_SAMPLES] = az;
+    gx_ring[ring_index] = gx_ring[ring_index + WIN_SAMPLES] = gx;
+    gy_ring[ring_index] = gy_ring[ring_index + WIN_SAMPLES] = gy;
+    gz_ring[ring_index] = gz_ring[ring_index + WIN_SAMPLES] = gz;
+
+    ring_index++;
+    if (ring_index >= WIN_SAMPLES) ring_index = 0;
+    if (ring_filled < WIN_SAMPLES) ring_filled++;
+#endif
+#if EARLY_USED
+    // partial windows between the hops; the full window below realigns them
+    if (gesture_early_step(&g_early)) {
+        feat_vec_t early_feat;
+        compute_features(float_window(0, EARLY_WIN_SAMPLES), float_window(1, EARLY_WIN_SAMPLES),
+                         float_window(2, EARLY_WIN_SAMPLES), float_window(3, EARLY_WIN_SAMPLES),
+                         float_window(4, EARLY_WIN_SAMPLES), float_window(5, EARLY_WIN_SAMPLES),
+                         EARLY_WIN_SAMPLES, (float)SAMPLE_HZ, &early_feat);
+        update_decision(t_ms, classify(&early_feat), true);
+    }
+#endif
+
+#if USE_FIXED_POINT
+    // update rings with the raw counts; bias and scale are applied in features_q15.c
+    ax_ring[ring_index] = ax_ring[ring_index + WIN_SAMPLES] = s->ax;
+    ay_ring[ring_index] = ay_ring[ring_index + WIN_SAMPLES] = s->ay;
+    az_ring[ring_index] = az_ring[ring_index + WIN_SAMPLES] = s->az;
+    gx_ring[ring_index] = gx_ring[ring_index + WIN_SAMPLES] = s->gx;
+    gy_ring[ring_index] = gy_ring[ring_index + WIN_SAMPLES] = s->gy;
+    gz_ring[ring_index] = gz_ring[ring_index + WIN_SAMPLES] = s->gz;
+
+    ring_index++;
+    if (ring_index >= WIN_SAMPLES) ring_index = 0;
+    if (ring_filled < WIN_SAMPLES) ring_filled++;
+
+    hop_accum++;
+
+    if (ring_filled < WIN_SAMPLES || hop_accum < HOP_SAMPLES) return;
+    hop_accum = 0;
+
+    // ring_index is the oldest sample; the mirror makes the next WIN_SAMPLES contiguous
+    const uint64_t t0 = time_us_64();
+
+    feat_vec_t feat;
+    const bool moving = compute_features_q15_gated(&ax_ring[ring_index], &ay_ring[ring_index],
+                                                   &az_ring[ring_index], &gx_ring[ring_index],
+                                                   &gy_ring[ring_index], &gz_ring[ring_index],
+                                                   WIN_SAMPLES, (float)SAMPLE_HZ, &g_featq_cfg,
+                                                   g_gate, &g_stage_counts, &feat);
+#elif USE_STREAM_FEATS
+    // lat_ms includes the pushes since the last window, as imu_replay --stream
+    // reports it, so it compares with the recomputing paths
+    static uint64_t push_us = 0;
+    const uint64_t tp = time_us_64();
+    feat_stream_push(&feat_stream, ax, ay, az, gx, gy, gz);
+    push_us += time_us_64() - tp;
+    hop_accum++;
+
+    // the engine keeps the window up to date; only the query runs per hop
+    if (!feat_stream_ready(&feat_stream)) push_us = 0;   // filling: no window pays for it
+    if (!feat_stream_ready(&feat_stream) || hop_accum < HOP_SAMPLES) return;
+    hop_accum = 0;
+
+    const uint64_t t0 = time_us_64() - push_us;
+    push_us = 0;
+
+    feat_vec_t feat;
+    const bool moving = feat_stream_get_gated(&feat_stream, g_gate, &g_stage_counts, &feat);
+#else
+    // the rings were updated above
+    hop_accum++;
+
+    // when a full window is available and hop reached, compute features
+    if (ring_filled < WIN_SAMPLES || hop_accum < HOP_SAMPLES) return;
+    hop_accum = 0;
+
+    const uint64_t t0 = time_us_64();
+
+    // ring_index is the oldest sample; the mirror makes the next WIN_SAMPLES contiguous
+    feat_vec_t feat;
+    const bool moving = compute_features_gated(&ax_ring[ring_index], &ay_ring[ring_index],
+                                               &az_ring[ring_index], &gx_ring[ring_index],
+                                               &gy_ring[ring_index], &gz_ring[ring_index],
+                                               WIN_SAMPLES, (float)SAMPLE_HZ, g_gate, &g_stage_counts, &feat);
+#endif
+
+    const int cls = moving ? classify(&feat) : G_NONE;
+    const float lat_ms = (float)(time_us_64() - t0) / 1000.0f;
+
+#if DECISION_FILTER
+#if DECISION_EARLY
+    gesture_early_full(&g_early);
+#endif
+    update_decision(t_ms, cls, false);
+#endif
+
+    int q_len = 0;
+#if USE_QUANT
+    uint8_t qbuf[64];
+    quantize_features_u8(&feat, qbuf, &q_len);
+#endif
+
+#if USE_GYRO
+    const float gx_sample = gx;
+    const float gy_sample = gy;
+    const float gz_sample = gz;
+    const float gx_std_val = feat.gx_std;
+    const float gy_std_val = feat.gy_std;
+    const float gz_std_val = feat.gz_std;
+#else
+    const float gx_sample = 0.0f;
+    const float gy_sample = 0.0f;
+    const float gz_sample = 0.0f;
+    const float gx_std_val = 0.0f;
+    const float gy_std_val = 0.0f;
+    const float gz_std_val = 0.0f;
+#endif
+
+    // per-window CSV (matches CSV_HEADER in config.h)
+    printf("%lu,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%d,%.3f,%d\n",
+           (unsigned long)t_ms,
+           ax, ay, az,
+           gx_sample, gy_sample, gz_sample,
+           feat.amag.mean,
+           feat.amag.std,
+           feat.amag.rms,
+           feat.amag.energy,
+           feat.amag.dom_freq,
+           feat.amag.bp1,
+           feat.amag.bp2,
+           gx_std_val,
+           gy_std_val,
+           gz_std_val,
+           feat.d_pitch_std,
+           feat.d_roll_std,
+           cls,
+           lat_ms,
+           q_len);
+
+    append_sd_record(t_ms,
+                    ax, ay, az,
+                    gx_sample, gy_sample, gz_sample,
+                    feat.amag.std,
+                    feat.amag.dom_freq,
+                    feat.amag.bp1,
+                    feat.amag.bp2,
+                    gx_std_val,
+                    gy_std_val,
+                    gz_std_val,
+                    cls,
+                    lat_ms,
+                    q_len);
+
+#if FEATURE_EXT
+    // extended features of the same window, columns as in the FX: header
+    if (g_fx_mask) {
+        float fx[FX_MAX_OUTPUTS];
+        const int n_fx = fx_compute(g_fx_mask,
+                                    float_window(0, WIN_SAMPLES), float_window(1, WIN_SAMPLES),
+                                    float_window(2, WIN_SAMPLES), float_window(3, WIN_SAMPLES),
+                                    float_window(4, WIN_SAMPLES), float_window(5, WIN_SAMPLES),
+                                    WIN_SAMPLES, (float)SAMPLE_HZ, fx);
+        printf("FX: %lu", (unsigned long)t_ms);
+        for (int i = 0; i < n_fx; i++) printf(",%.5f", fx[i]);
+        printf("\n");
     }
+#endif
+
+    if (lat_ms > 20.0f) {
+        printf("WARN: feature latency=%.2f ms (OVERRUN)\n", lat_ms);
+    }
+
+#if PRINT_DEBUG
+    printf("GESTURE: %s (lat=%.1f ms) dom=%.2fHz std=%.2f bp1=%.2f bp2=%.2f\n",
+           gesture_name(cls), lat_ms, feat.amag.dom_freq,
+           feat.amag.std, feat.amag.bp1, feat.amag.bp2);
+#endif
+#else
+    (void)t_ms; (void)ax; (void)ay; (void)az; (void)gx; (void)gy; (void)gz;
+#endif
+}
+
+// -------------------- Sample hand-off ------------------------
+// Raw samples always go through g_sample_ring. The producer is the sampling
+// loop or the sampling IRQ on core0; the consumer is core1 (USE_DUAL_CORE) or
+// the core0 main loop between samples.
+static sample_ring_t g_sample_ring;
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_FIFO
+static uint32_t g_fifo_overflows = 0;  // written in the drain IRQ, read by the consumer
+#endif
+#if USE_I2C_DMA
+static i2c_dma_t g_i2c_dma;
+static icm_async_t g_imu_async;        // counters written in core0 IRQs, read by the consumer
+#endif
+
+// -------------------- Sample timing --------------------------
+// Period statistics from the per-sample timestamps, reported once per second.
+// With a timer or data-ready trigger the timestamp is taken at IRQ entry, so
+// these show the acquisition jitter rather than the processing loop's.
+typedef struct {
+    uint64_t last_us;
+    uint32_t n;
+    uint32_t min_us, max_us;
+    uint64_t sum_us, sumsq_us;
+} period_stats_t;
+
+static period_stats_t g_period;
+
+static void period_stats_add(period_stats_t *p, uint64_t t_us) {
+    if (p->last_us != 0) {
+        const uint32_t dt = (uint32_t)(t_us - p->last_us);
+        if (p->n == 0 || dt < p->min_us) p->min_us = dt;
+        if (dt > p->max_us) p->max_us = dt;
+        p->sum_us += dt;
+        p->sumsq_us += (uint64_t)dt * dt;
+        p->n++;
+    }
+    p->last_us = t_us;
+}
+
+static void report_pipeline_stats(void) {
+    static uint64_t next_report_us = 0;
+    static uint32_t reported_drops = 0;
+
+    const uint64_t now_us = time_us_64();
+    if (now_us < next_report_us) return;
+    next_report_us = now_us + 1000000u;   // throttle to 1 Hz
+
+    period_stats_t *p = &g_period;
+    if (p->n > 0) {
+        // n^2 * var in integers: float sumsq/n - mean^2 cancels at 10 ms periods
+        const uint64_t var_n2 = (uint64_t)p->n * p->sumsq_us - p->sum_us * p->sum_us;
+        const float mean_us = (float)p->sum_us / (float)p->n;
+        const float jitter_us = sqrtf((float)var_n2) / (float)p->n;
+        const float actual_hz = 1000000.0f / mean_us;
+        const float drift = fabsf(actual_hz - (float)SAMPLE_HZ) / (float)SAMPLE_HZ;
+
+        if (drift > 0.05f || p->max_us > 2u * (1000000u / SAMPLE_HZ)) {
+            printf("WARN: sample rate drift=%.2f%% (%.2f Hz vs %d Hz) jitter=%.1f us max_gap=%lu us\n",
+                   drift * 100.0f, actual_hz, SAMPLE_HZ, jitter_us, (unsigned long)p->max_us);
+        }
+#if PRINT_DEBUG
+        printf("JITTER: n=%lu mean=%.1f us std=%.2f us min=%lu us max=%lu us\n",
+               (unsigned long)p->n, mean_us, jitter_us,
+               (unsigned long)p->min_us, (unsigned long)p->max_us);
+#endif
+        const uint64_t last_us = p->last_us;
+        memset(p, 0, sizeof(*p));
+        p->last_us = last_us;
+    }
+
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_FIFO
+    static uint32_t reported_overflows = 0;
+    const uint32_t overflows = __atomic_load_n(&g_fifo_overflows, __ATOMIC_RELAXED);
+    if (overflows != reported_overflows) {
+        printf("WARN: ICM-20948 FIFO overflow x%lu (samples lost, timestamps re-anchored)\n",
+               (unsigned long)(overflows - reported_overflows));
+        reported_overflows = overflows;
+    }
+#endif
+
+#if USE_I2C_DMA
+    static uint32_t reported_lost = 0;
+    const uint32_t skipped  = __atomic_load_n(&g_imu_async.skipped, __ATOMIC_RELAXED);
+    const uint32_t errors   = __atomic_load_n(&g_imu_async.errors, __ATOMIC_RELAXED);
+    const uint32_t timeouts = __atomic_load_n(&g_imu_async.timeouts, __ATOMIC_RELAXED);
+    if (skipped + errors + timeouts != reported_lost) {
+        printf("WARN: I2C DMA read lost samples: busy=%lu err=%lu timeout=%lu\n",
+               (unsigned long)skipped, (unsigned long)errors, (unsigned long)timeouts);
+        reported_lost = skipped + errors + timeouts;
+    }
+#endif
+
+    // same core as the logger, so the writer stats are read directly
+    const sd_writer_stats_t *sd = sd_logging_stats();
+    if (sd) {
+        static uint32_t reported_inline = 0;
+        if (sd->inline_flushes != reported_inline) {
+            printf("WARN: SD writer fell behind, inline flushes=%lu (+%lu) max_write=%lu us\n",
+                   (unsigned long)sd->inline_flushes,
+                   (unsigned long)(sd->inline_flushes - reported_inline),
+                   (unsigned long)sd->max_write_us);
+            reported_inline = sd->inline_flushes;
+        }
+#if PRINT_DEBUG
+        const uint32_t writes = sd->flushes + sd->tail_writes;
+        printf("SDLOG: flushes=%lu (async %lu) tail_writes=%lu avg_write=%lu us max_write=%lu us syncs=%lu avg_sync=%lu us max_sync=%lu us\n",
+               (unsigned long)sd->flushes, (unsigned long)sd->async_flushes, (unsigned long)sd->tail_writes,
+               (unsigned long)(writes ? sd->total_write_us / writes : 0),
+               (unsigned long)sd->max_write_us,
+               (unsigned long)sd->syncs,
+               (unsigned long)(sd->syncs ? sd->total_sync_us / sd->syncs : 0),
+               (unsigned long)sd->max_sync_us);
+#endif
+    }
+
+#if LOG_RAW_SD
+    if (g_raw_ready) {
+        static uint32_t reported_raw_drops = 0;
+        const raw_logger_t *r = &g_raw_logger;
+        if (r->dropped != reported_raw_drops) {
+            printf("WARN: raw SD ring full, dropped=%lu (+%lu) max_depth=%lu/%d max_write=%lu us\n",
+                   (unsigned long)r->dropped, (unsigned long)(r->dropped - reported_raw_drops),
+                   (unsigned long)r->max_depth, RAW_LOG_RING_LEN, (unsigned long)r->w.stats.max_write_us);
+            reported_raw_drops = r->dropped;
+        }
+#if PRINT_DEBUG
+        printf("RAWLOG: records=%u %.2f B/rec (ratio %.2f) depth=%lu max_depth=%lu flushes=%lu (async %lu) max_write=%lu us\n",
+               r->records_written,
+               r->records_out ? (double)r->bytes_out / r->records_out : 0.0,
+               r->bytes_out ? (double)r->records_out * sizeof(imu_raw_record_t) / r->bytes_out : 0.0,
+               (unsigned long)(r->head - r->tail), (unsigned long)r->max_depth,
+               (unsigned long)r->w.stats.flushes, (unsigned long)r->w.stats.async_flushes,
+               (unsigned long)r->w.stats.max_write_us);
+#endif
+    }
+#endif
+
+    const uint32_t drops = sample_ring_dropped(&g_sample_ring);
+    if (drops != reported_drops) {
+        printf("WARN: sample ring full, dropped=%lu (+%lu) q_max=%lu/%d\n",
+               (unsigned long)drops, (unsigned long)(drops - reported_drops),
+               (unsigned long)sample_ring_max_depth(&g_sample_ring), SAMPLE_RING_LEN);
+        reported_drops = drops;
+    }
+#if PRINT_DEBUG
+    printf("QUEUE: depth=%lu max=%lu dropped=%lu\n",
+           (unsigned long)sample_ring_depth(&g_sample_ring),
+           (unsigned long)sample_ring_max_depth(&g_sample_ring),
+           (unsigned long)drops);
+#if LOG_FEATURES
+    const feat_stage_counts_t *st = &g_stage_counts;
+    printf("STAGES: windows=%lu gyro_range=%lu gyro_std=%lu spectral=%lu (idle %.0f%%)\n",
+           (unsigned long)st->windows, (unsigned long)st->gyro_range,
+           (unsigned long)st->gyro_std, (unsigned long)st->spectral,
+           st->windows ? 100.0 * (st->windows - st->spectral) / st->windows : 0.0);
+#endif
+#endif
+}
+
+// Every trigger path (register burst, I2C DMA, FIFO) hands over raw counts.
+// The Avg8 the driver used to apply in imuDataAccGyrGet() runs here instead,
+// once per sample, so all paths feed the pipeline the same smoothed signal.
+static avg8_t g_smooth[6];
+
+#if LOG_RAW_SD
+// Called before smooth_sample(), so raw_*.bin holds the counts as read.
+// Only a copy into the RAM ring; the card is written from the idle pass.
+static void raw_log_sample(const imu_sample_t *s) {
+    if (!g_raw_ready) return;
+    const imu_raw_record_t rec = {
+        .t_us = (uint32_t)(s->t_us - g_t_start_us),
+        .ax = s->ax, .ay = s->ay, .az = s->az,
+        .gx = s->gx, .gy = s->gy, .gz = s->gz,
+    };
+    raw_push(&g_raw_logger, &rec);
+}
+#endif
+
+static void smooth_sample(imu_sample_t *s) {
+    s->ax = avg8_update(&g_smooth[0], s->ax);
+    s->ay = avg8_update(&g_smooth[1], s->ay);
+    s->az = avg8_update(&g_smooth[2], s->az);
+    s->gx = avg8_update(&g_smooth[3], s->gx);
+    s->gy = avg8_update(&g_smooth[4], s->gy);
+    s->gz = avg8_update(&g_smooth[5], s->gz);
+}
+
+// Consumer side: process everything queued, then give the idle time to the SD
+// writer. Returns false if there was nothing to do.
+static bool drain_samples(void) {
+    bool any = false;
+    imu_sample_t s;
+    while (sample_ring_pop(&g_sample_ring, &s)) {
+        period_stats_add(&g_period, s.t_us);
+#if LOG_RAW_SD
+        raw_log_sample(&s);
+#endif
+        smooth_sample(&s);
+        process_sample(&s);
+        any = true;
+    }
+    if (service_sd_logging()) any = true;
+    report_pipeline_stats();
+    return any;
+}
+
+// -------------------- Sampling (core0) -----------------------
+#if USE_I2C_DMA
+// DMA RX-complete IRQ: the burst started by sample_and_push() has landed.
+// Raw counts, like every path; drain_samples() smooths them.
+static void imu_dma_done(void *user, bool ok) {
+    icm_async_t *a = (icm_async_t *)user;
+    imu_sample_t sample;
+    icm_async_on_complete(a, ok);
+    if (icm_async_take(a, &sample)) {
+        sample_ring_push(&g_sample_ring, &sample);
+        __sev();
+    }
+}
+#endif
+
+// Producer side: one burst read, stamped with the trigger time. Called from
+// the sleep_until loop or directly from the timer/GPIO IRQ. With USE_I2C_DMA
+// the IRQ only queues the transfer and imu_dma_done() pushes the sample.
+static void sample_and_push(uint64_t t_us) {
+#if USE_I2C_DMA
+    icm_async_start(&g_imu_async, t_us, I2C_DMA_TIMEOUT_US);
+#else
+    IMU_ST_SENSOR_DATA gyro_raw, accel_raw;
+    imuDataAccGyrGet(&gyro_raw, &accel_raw);
+
+    const imu_sample_t sample = {
+        .t_us = t_us,
+        .ax = accel_raw.s16X, .ay = accel_raw.s16Y, .az = accel_raw.s16Z,
+        .gx = gyro_raw.s16X,  .gy = gyro_raw.s16Y,  .gz = gyro_raw.s16Z,
+    };
+    sample_ring_push(&g_sample_ring, &sample);
+    __sev();   // wake the consumer out of __wfe()
+#endif
+}
+
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_TIMER
+static repeating_timer_t g_sample_timer;
+
+static bool sample_timer_cb(repeating_timer_t *rt) {
+    (void)rt;
+    sample_and_push(time_us_64());
+    return true;   // keep repeating
+}
+#elif SAMPLE_TRIGGER == SAMPLE_TRIGGER_DRDY
+static void imu_int_cb(uint gpio, uint32_t events) {
+    if (gpio == IMU_INT_GPIO && (events & GPIO_IRQ_EDGE_RISE)) {
+        sample_and_push(time_us_64());
+    }
+}
+#elif SAMPLE_TRIGGER == SAMPLE_TRIGGER_FIFO
+// FIFO frames carry no timestamp. They are rebuilt from the sensor frame
+// period and kept locked to time_us_64(): after each drain the newest frame
+// should be on average half a period old, and 1/8 of the error is fed back,
+// which follows the sensor's clock tolerance without adding drain-phase
+// jitter to every sample.
+// The FIFO holds gyro frames only. The accel is read once per drain, and the
+// frames between two reads get it interpolated linearly in time, so its
+// bandwidth is set by the drain rate (at least FIFO_ACCEL_HZ).
+static repeating_timer_t g_fifo_timer;
+static uint32_t g_fifo_period_ns = 0;
+static uint64_t g_fifo_next_ns = 0;    // timestamp of the next frame; 0 = re-anchor
+static IMU_ST_SENSOR_DATA g_fifo_accel_prev;
+static uint64_t g_fifo_accel_prev_ns = 0;   // 0: no previous read, hold the current one
+
+static int16_t fifo_accel_lerp(int16_t a0, int16_t a1, uint32_t frac16) {
+    return (int16_t)(a0 + (int32_t)(((int64_t)(a1 - a0) * frac16) >> 16));
+}
+
+static bool fifo_drain_cb(repeating_timer_t *rt) {
+    (void)rt;
+    static IMU_ST_SENSOR_DATA gyro[FIFO_MAX_FRAMES];
+    IMU_ST_SENSOR_DATA accel;
+
+    const uint64_t now_ns = time_us_64() * 1000u;
+    const int n = icm20948FifoRead(gyro, FIFO_MAX_FRAMES, &accel);
+    if (n < 0) {
+        __atomic_store_n(&g_fifo_overflows, g_fifo_overflows + 1u, __ATOMIC_RELAXED);
+        g_fifo_next_ns = 0;
+        g_fifo_accel_prev_ns = 0;
+        return true;
+    }
+
+    if (n > 0 && g_fifo_next_ns == 0) {
+        g_fifo_next_ns = now_ns - (uint64_t)(n - 1) * g_fifo_period_ns - g_fifo_period_ns / 2;
+    }
+    const IMU_ST_SENSOR_DATA a0 = g_fifo_accel_prev_ns ? g_fifo_accel_prev : accel;
+    const uint64_t t0_ns = g_fifo_accel_prev_ns ? g_fifo_accel_prev_ns : now_ns;
+    g_fifo_accel_prev = accel;
+    g_fifo_accel_prev_ns = now_ns;
+    if (n == 0) return true;
+
+    for (int i = 0; i < n; i++) {
+        // position of the frame between the previous accel read and this one, Q16
+        uint32_t frac16 = 0x10000u;
+        if (g_fifo_next_ns <= t0_ns) frac16 = 0;
+        else if (g_fifo_next_ns < now_ns) {
+            frac16 = (uint32_t)(((g_fifo_next_ns - t0_ns) / 1000u << 16) / ((now_ns - t0_ns) / 1000u));
+        }
+        const imu_sample_t sample = {
+            .t_us = g_fifo_next_ns / 1000u,
+            .ax = fifo_accel_lerp(a0.s16X, accel.s16X, frac16),
+            .ay = fifo_accel_lerp(a0.s16Y, accel.s16Y, frac16),
+            .az = fifo_accel_lerp(a0.s16Z, accel.s16Z, frac16),
+            .gx = gyro[i].s16X, .gy = gyro[i].s16Y, .gz = gyro[i].s16Z,
+        };
+        sample_ring_push(&g_sample_ring, &sample);
+        g_fifo_next_ns += g_fifo_period_ns;
+    }
+    __sev();
+
+    const int64_t err_ns = (int64_t)(now_ns - (g_fifo_next_ns - g_fifo_period_ns))
+                         - (int64_t)(g_fifo_period_ns / 2);
+    if (err_ns > 4 * (int64_t)g_fifo_period_ns || err_ns < -4 * (int64_t)g_fifo_period_ns) {
+        g_fifo_next_ns = 0;              // lost lock (e.g. IRQ starved): re-anchor
+    } else {
+        g_fifo_next_ns += err_ns / 8;
+    }
+    return true;
+}
+#endif
+
+#if USE_DUAL_CORE
+// -------------------- Core1: consumer ------------------------
+// Core0 only samples; core1 drains g_sample_ring, runs process_sample() and
+// owns the SD card, so a slow f_write/f_sync or a long window never delays
+// the next I2C read.
+static uint32_t g_core1_stack[CORE1_STACK_BYTES / sizeof(uint32_t)];
+
+static void core1_entry(void) {
+    if (!init_sd_logging()) {
+        printf("SD logging not active (initialization failed).\n");
+    }
+
+    while (true) {
+        if (!drain_samples()) {
+            __wfe();   // core0 signals every push with __sev()
+        }
+    }
+}
+#endif
+
+#if NN_BENCH
+// -------------------- Int8 network check ---------------------
+// src/gesture_nn.h on the device: every output must equal what export_nn.py
+// computed (and host/imu_nncheck reproduces), byte for byte. Cycles are the
+// best of a few runs per input, counted with SysTick on the processor clock.
+static void run_nn_bench(void) {
+    static int8_t arena[GESTURE_NN_ARENA_BYTES];
+    const uint32_t saved_csr = systick_hw->csr, saved_rvr = systick_hw->rvr;
+    systick_hw->rvr = 0xFFFFFFu;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;   // enabled, processor clock, no interrupt
+
+    int exact = 0;
+    uint32_t best = 0xFFFFFFu;
+    for (int t = 0; t < GESTURE_NN_N_TESTS; t++) {
+        bool ok = true;
+        for (int rep = 0; rep < 4; rep++) {
+            memcpy(nn_input(&kGestureNn, arena), kGestureNnTestIn[t], kGestureNn.n_in);
+            const uint32_t t0 = systick_hw->cvr;
+            const int8_t *out = nn_run(&kGestureNn, arena);
+            const uint32_t cycles = (t0 - systick_hw->cvr) & 0xFFFFFFu;
+            if (cycles < best) best = cycles;
+            ok = ok && memcmp(out, kGestureNnTestOut[t], kGestureNn.n_out) == 0;
+        }
+        exact += ok;
+    }
+    systick_hw->rvr = saved_rvr;
+    systick_hw->csr = saved_csr;
+
+    printf("NN: gesture_nn %lu MACs, %u B arena, %lu cycles/inference, %d/%d reference outputs exact%s\n",
+           (unsigned long)nn_macs(&kGestureNn), (unsigned)GESTURE_NN_ARENA_BYTES, (unsigned long)best,
+           exact, GESTURE_NN_N_TESTS, exact == GESTURE_NN_N_TESTS ? "" : " MISMATCH");
 }
 #endif
 
@@ -200,8 +1136,11 @@ int main(void) {
     setvbuf(stdout, NULL, _IONBF, 0);
 
     printf("PICO IMU features build starting...\n");
-    printf("SAMPLE_HZ=%d, WIN_MS=%d, HOP_MS=%d, LOG_RAW=%d, LOG_FEATURES=%d, USE_GYRO=%d, USE_FFT=%d, USE_QUANT=%d\n",
-           SAMPLE_HZ, WIN_MS, HOP_MS, LOG_RAW, LOG_FEATURES, USE_GYRO, USE_FFT, USE_QUANT);
+    printf("SAMPLE_HZ=%d, WIN_MS=%d, HOP_MS=%d, LOG_RAW=%d, LOG_RAW_SD=%d, LOG_FEATURES=%d, USE_GYRO=%d, USE_FFT=%d, USE_QUANT=%d, USE_DUAL_CORE=%d, SAMPLE_TRIGGER=%d\n",
+           SAMPLE_HZ, WIN_MS, HOP_MS, LOG_RAW, LOG_RAW_SD, LOG_FEATURES, USE_GYRO, USE_FFT, USE_QUANT, USE_DUAL_CORE, SAMPLE_TRIGGER);
+#if NN_BENCH
+    run_nn_bench();
+#endif
 
     // ---- IMU init (ICM-20948) ----
     IMU_EN_SENSOR_TYPE sensor_type = IMU_EN_SENSOR_TYPE_NULL;
@@ -223,6 +1162,9 @@ int main(void) {
 
     float sum_ax = 0.0f, sum_ay = 0.0f, sum_az = 0.0f;
     float sum_gx = 0.0f, sum_gy = 0.0f, sum_gz = 0.0f;
+#if USE_FIXED_POINT
+    int32_t raw_sum[6] = {0};   // same biases in raw counts for features_q15.c
+#endif
 
     IMU_ST_SENSOR_DATA gyro_raw = {0};
     IMU_ST_SENSOR_DATA accel_raw = {0};
@@ -244,36 +1186,49 @@ int main(void) {
         sum_gx += (float)gyro_raw.s16X * GYRO_SCALE_DPS;
         sum_gy += (float)gyro_raw.s16Y * GYRO_SCALE_DPS;
         sum_gz += (float)gyro_raw.s16Z * GYRO_SCALE_DPS;
+
+#if USE_FIXED_POINT
+        raw_sum[0] += accel_raw.s16X; raw_sum[1] += accel_raw.s16Y; raw_sum[2] += accel_raw.s16Z;
+        raw_sum[3] += gyro_raw.s16X;  raw_sum[4] += gyro_raw.s16Y;  raw_sum[5] += gyro_raw.s16Z;
+#endif
     }
 
-    const float bias_ax = sum_ax / (float)calib_samples;
-    const float bias_ay = sum_ay / (float)calib_samples;
-    const float bias_az = sum_az / (float)calib_samples;
-    const float bias_gx = sum_gx / (float)calib_samples;
-    const float bias_gy = sum_gy / (float)calib_samples;
-    const float bias_gz = sum_gz / (float)calib_samples;
+    g_bias[0] = sum_ax / (float)calib_samples;
+    g_bias[1] = sum_ay / (float)calib_samples;
+    g_bias[2] = sum_az / (float)calib_samples;
+    g_bias[3] = sum_gx / (float)calib_samples;
+    g_bias[4] = sum_gy / (float)calib_samples;
+    g_bias[5] = sum_gz / (float)calib_samples;
 
 #if PRINT_DEBUG
     printf("Calibration done. Bias accel[g]: %.5f %.5f %.5f | gyro[dps]: %.5f %.5f %.5f\n",
-           bias_ax, bias_ay, bias_az, bias_gx, bias_gy, bias_gz);
+           g_bias[0], g_bias[1], g_bias[2], g_bias[3], g_bias[4], g_bias[5]);
 #endif
 
-    if (!init_csv_logging()) {
-        printf("SD logging not active (initialization failed).\n");
+    // --------- Window processing state ----------
+#if LOG_FEATURES && USE_FIXED_POINT
+    g_featq_cfg.accel_scale = ACCEL_SCALE_G;
+    g_featq_cfg.gyro_scale  = GYRO_SCALE_DPS;
+    for (int c = 0; c < 3; c++) {
+        g_featq_cfg.accel_bias[c] = (int16_t)(raw_sum[c] / (int32_t)calib_samples);
+        g_featq_cfg.gyro_bias[c]  = (int16_t)(raw_sum[c + 3] / (int32_t)calib_samples);
     }
-
-    // --------- Buffers for windowed feature computation ----------
-#if LOG_FEATURES
-    static float ax_ring[WIN_SAMPLES] = {0};
-    static float ay_ring[WIN_SAMPLES] = {0};
-    static float az_ring[WIN_SAMPLES] = {0};
-    static float gx_ring[WIN_SAMPLES] = {0};
-    static float gy_ring[WIN_SAMPLES] = {0};
-    static float gz_ring[WIN_SAMPLES] = {0};
-
-    int ring_index = 0;   // next write position
-    int ring_filled = 0;  // up to WIN_SAMPLES
-    int hop_accum  = 0;   // samples since last window
+#elif LOG_FEATURES && USE_STREAM_FEATS
+    if (!feat_stream_init(&feat_stream, WIN_SAMPLES, (float)SAMPLE_HZ)) {
+        printf("Error: feat_stream cannot hold this window. Halting.\n");
+        while (true) { sleep_ms(1000); }
+    }
+#endif
+#if FLOAT_WINDOW
+    fx_window_init(&g_float_win, FLOAT_WIN_SAMPLES, g_float_win_buf);
+#endif
+#if LOG_FEATURES && DECISION_FILTER
+    gesture_filter_cfg_t decision_cfg;
+    gesture_filter_default_cfg(&decision_cfg);
+    gesture_filter_init(&g_decision, &decision_cfg);
+#if DECISION_EARLY
+    gesture_early_init(&g_early, EARLY_WIN_SAMPLES, EARLY_HOP_SAMPLES, HOP_SAMPLES);
+#endif
 #endif
 
     // --------- CSV headers ----------
@@ -283,169 +1238,93 @@ int main(void) {
 #if LOG_FEATURES
     printf(CSV_HEADER "\n");
 #endif
+#if LOG_FEATURES && FEATURE_EXT
+    if (g_fx_mask) {
+        printf("FX: t_ms");
+        for (int i = 0; i < fx_count(g_fx_mask); i++) printf(",%s", fx_name(g_fx_mask, i));
+        printf("\n");
+    }
+#endif
+
+    sample_ring_init(&g_sample_ring);
+#if USE_DUAL_CORE
+    // core1 takes over processing and the SD card from here on
+    multicore_launch_core1_with_stack(core1_entry, g_core1_stack, sizeof g_core1_stack);
+#else
+    if (!init_sd_logging()) {
+        printf("SD logging not active (initialization failed).\n");
+    }
+#endif
 
     // main sampling loop
-    next_tick = get_absolute_time();
-    const uint32_t t_start_ms = to_ms_since_boot(get_absolute_time());
-    uint64_t last_sample_us = time_us_64();
-    uint64_t next_rate_warn_us = last_sample_us;
+    g_t_start_us = time_us_64();
 
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_SLEEP
+    next_tick = get_absolute_time();
     while (true) {
         // pace to target sampling rate
         next_tick = add_interval(next_tick, sample_period_us);
         sleep_until(next_tick);
 
-        // read raw
-        imuDataAccGyrGet(&gyro_raw, &accel_raw);
-
-        // scale + bias-correct
-        float ax = (float)accel_raw.s16X * ACCEL_SCALE_G - bias_ax;
-        float ay = (float)accel_raw.s16Y * ACCEL_SCALE_G - bias_ay;
-        float az = (float)accel_raw.s16Z * ACCEL_SCALE_G - bias_az;
-        float gx = (float)gyro_raw.s16X * GYRO_SCALE_DPS - bias_gx;
-        float gy = (float)gyro_raw.s16Y * GYRO_SCALE_DPS - bias_gy;
-        float gz = (float)gyro_raw.s16Z * GYRO_SCALE_DPS - bias_gz;
-
-        // simple rate monitor
-        const uint64_t sample_time_us = time_us_64();
-        const uint64_t dt_us = sample_time_us - last_sample_us;
-        if (dt_us > 0) {
-            const float actual_hz = 1000000.0f / (float)dt_us;
-            const float drift = fabsf(actual_hz - (float)SAMPLE_HZ) / (float)SAMPLE_HZ;
-            if (drift > 0.05f && sample_time_us >= next_rate_warn_us) {
-                printf("WARN: sample rate drift=%.2f%% (%.2f Hz vs %d Hz)\n",
-                       drift * 100.0f, actual_hz, SAMPLE_HZ);
-                next_rate_warn_us = sample_time_us + 1000000u; // throttle to 1 Hz
-            }
-        }
-        last_sample_us = sample_time_us;
-
-        const uint32_t now_ms = to_ms_since_boot(get_absolute_time());
-        const uint32_t t_ms = now_ms - t_start_ms;
-
-#if LOG_RAW
-        // per-sample CSV (useful for debugging or offline feature checks)
-        printf("%lu,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f\n",
-               (unsigned long)t_ms, ax, ay, az, gx, gy, gz);
+        sample_and_push(time_us_64());
+#if !USE_DUAL_CORE
+        drain_samples();
 #endif
-
-#if LOG_FEATURES
-        // update rings
-        ax_ring[ring_index] = ax;
-        ay_ring[ring_index] = ay;
-        az_ring[ring_index] = az;
-        gx_ring[ring_index] = gx;
-        gy_ring[ring_index] = gy;
-        gz_ring[ring_index] = gz;
-
-        ring_index++;
-        if (ring_index >= WIN_SAMPLES) ring_index = 0;
-        if (ring_filled < WIN_SAMPLES) ring_filled++;
-
-        hop_accum++;
-
-        // when a full window is available and hop reached, compute features
-        if (ring_filled == WIN_SAMPLES && hop_accum >= HOP_SAMPLES) {
-            hop_accum = 0;
-
-            float ax_win[WIN_SAMPLES];
-            float ay_win[WIN_SAMPLES];
-            float az_win[WIN_SAMPLES];
-            float gx_win[WIN_SAMPLES];
-            float gy_win[WIN_SAMPLES];
-            float gz_win[WIN_SAMPLES];
-
-            // ring_index points to the NEXT write position -> it's also the start of the logical window
-            copy_window(ax_win, ax_ring, WIN_SAMPLES, ring_index);
-            copy_window(ay_win, ay_ring, WIN_SAMPLES, ring_index);
-            copy_window(az_win, az_ring, WIN_SAMPLES, ring_index);
-            copy_window(gx_win, gx_ring, WIN_SAMPLES, ring_index);
-            copy_window(gy_win, gy_ring, WIN_SAMPLES, ring_index);
-            copy_window(gz_win, gz_ring, WIN_SAMPLES, ring_index);
-
-            const uint64_t t0 = time_us_64();
-
-            feat_vec_t feat;
-            compute_features(ax_win, ay_win, az_win, gx_win, gy_win, gz_win,
-                             WIN_SAMPLES, (float)SAMPLE_HZ, &feat);
-
-            const int cls = classify(&feat);
-            const float lat_ms = (float)(time_us_64() - t0) / 1000.0f;
-
-            int q_len = 0;
-#if USE_QUANT
-            uint8_t qbuf[64];
-            quantize_features_u8(&feat, qbuf, &q_len);
+    }
+#else
+#if USE_I2C_DMA
+    const icm_async_transport_t dma_tp = { i2c_dma_start_read, i2c_dma_abort, &g_i2c_dma };
+    const int16_t gyro_offset[3] = { gstGyroOffset.s16X, gstGyroOffset.s16Y, gstGyroOffset.s16Z };
+    icm_async_init(&g_imu_async, &dma_tp, gyro_offset);
+    if (!i2c_dma_init(&g_i2c_dma, i2c1, I2C_ADD_ICM20948, imu_dma_done, &g_imu_async)) {
+        printf("Error: no free DMA channels for the IMU. Halting.\n");
+        while (true) { sleep_ms(1000); }
+    }
 #endif
-
-
-#if USE_GYRO
-            const float gx_sample = gx;
-            const float gy_sample = gy;
-            const float gz_sample = gz;
-            const float gx_std_val = feat.gx_std;
-            const float gy_std_val = feat.gy_std;
-            const float gz_std_val = feat.gz_std;
+#if SAMPLE_TRIGGER == SAMPLE_TRIGGER_TIMER
+    // negative period: spaced start-to-start, independent of callback duration
+    add_repeating_timer_us(-(int64_t)sample_period_us, sample_timer_cb, NULL, &g_sample_timer);
+#elif SAMPLE_TRIGGER == SAMPLE_TRIGGER_FIFO
+    g_fifo_period_ns = icm20948FifoEnable(SAMPLE_HZ);
+    printf("ICM-20948 FIFO: gyro frame period %lu ns, drain + accel read every %lu us (~%lu frames)\n",
+           (unsigned long)g_fifo_period_ns, (unsigned long)FIFO_DRAIN_US,
+           (unsigned long)((uint64_t)FIFO_DRAIN_US * 1000u / g_fifo_period_ns));
+    add_repeating_timer_us(-(int64_t)FIFO_DRAIN_US, fifo_drain_cb, NULL, &g_fifo_timer);
 #else
-            const float gx_sample = 0.0f;
-            const float gy_sample = 0.0f;
-            const float gz_sample = 0.0f;
-            const float gx_std_val = 0.0f;
-            const float gy_std_val = 0.0f;
-            const float gz_std_val = 0.0f;
-#endif
-
-            // per-window CSV (matches CSV_HEADER in config.h)
-            printf("%lu,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%d,%.3f,%d\n",
-                   (unsigned long)t_ms,
-                   ax, ay, az,
-                   gx_sample, gy_sample, gz_sample,
-                   feat.amag.mean,
-                   feat.amag.std,
-                   feat.amag.rms,
-                   feat.amag.energy,
-                   feat.amag.dom_freq,
-                   feat.amag.bp1,
-                   feat.amag.bp2,
-                   gx_std_val,
-                   gy_std_val,
-                   gz_std_val,
-                   feat.d_pitch_std,
-                   feat.d_roll_std,
-                   cls,
-                   lat_ms,
-                   q_len);
-
-            append_csv_line(t_ms,
-                            ax, ay, az,
-                            gx_sample, gy_sample, gz_sample,
-                            feat.amag.std,
-                            feat.amag.dom_freq,
-                            feat.amag.bp1,
-                            feat.amag.bp2,
-                            gx_std_val,
-                            gy_std_val,
-                            gz_std_val,
-                            cls,
-                            lat_ms,
-                            q_len);
-
-            if (lat_ms > 20.0f) {
-                printf("WARN: feature latency=%.2f ms (OVERRUN)\n", lat_ms);
-            }
-
-#if PRINT_DEBUG
-            printf("GESTURE: %s (lat=%.1f ms) dom=%.2fHz std=%.2f bp1=%.2f bp2=%.2f\n",
-                   gesture_name(cls), lat_ms, feat.amag.dom_freq,
-                   feat.amag.std, feat.amag.bp1, feat.amag.bp2);
+    {
+        // equal at the rates allowed above; both printed as a check
+        uint32_t accel_period_ns = 0;
+        const uint32_t gyro_period_ns = icm20948SetSampleRate(SAMPLE_HZ, &accel_period_ns);
+        printf("ICM-20948 ODR: gyro %.2f Hz, accel %.2f Hz\n",
+               1e9 / (double)gyro_period_ns, 1e9 / (double)accel_period_ns);
+    }
+    gpio_init(IMU_INT_GPIO);
+    gpio_set_dir(IMU_INT_GPIO, GPIO_IN);
+    gpio_pull_down(IMU_INT_GPIO);
+    gpio_set_irq_enabled_with_callback(IMU_INT_GPIO, GPIO_IRQ_EDGE_RISE, true, &imu_int_cb);
+    icm20948DataReadyIntEnable(true);
 #endif
-        }
+
+    // sampling happens in the IRQ; core0 only processes (single core) or sleeps
+    while (true) {
+#if USE_DUAL_CORE
+        __wfe();
+#else
+        if (!drain_samples()) __wfe();
 #endif
     }
+#endif
 
-    if (g_csv_logger_ready) {
+    if (g_log_ready) {
+#if LOG_BINARY
+        bin_close(&g_bin_logger);
+#else
         csv_close(&g_csv_logger);
+#endif
     }
+#if LOG_RAW_SD
+    if (g_raw_ready) raw_close(&g_raw_logger);
+#endif
 
     return 0;
 }
@@ -0,0 +1,94 @@
+// project/src/nn_int8.c
+#include <math.h>
+#include "nn_int8.h"
+
+// int8 dot product, unrolled by four (the M0+ multiplies in one cycle, the
+// loop overhead is what costs).
+static int32_t dot_s8(const int8_t *w, const int8_t *x, int n) {
+    int32_t acc = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc += w[i] * x[i] + w[i + 1] * x[i + 1] + w[i + 2] * x[i + 2] + w[i + 3] * x[i + 3];
+    }
+    for (; i < n; i++) acc += w[i] * x[i];
+    return acc;
+}
+
+static int8_t requantize(int32_t acc, const nn_layer_t *l) {
+    const int64_t round = (int64_t)1 << (l->shift - 1);
+    // clamp before narrowing: a small shift can leave the product past int32
+    int64_t v = (((int64_t)acc * l->mult + round) >> l->shift) + l->out_zp;
+    const int64_t lo = l->relu ? l->out_zp : -128;
+    if (v < lo) v = lo;
+    if (v > 127) v = 127;
+    return (int8_t)v;
+}
+
+static void run_layer(const nn_layer_t *l, const int8_t *in, int8_t *out) {
+    const int taps = l->kernel * l->in_ch;
+    const int step = l->stride * l->in_ch;
+    for (int t = 0; t < l->out_len; t++) {
+        const int8_t *x = in + t * step;
+        const int8_t *w = l->w;
+        for (int o = 0; o < l->out_ch; o++, w += taps) {
+            *out++ = requantize(l->bias[o] + dot_s8(w, x, taps), l);
+        }
+    }
+}
+
+int8_t *nn_input(const nn_model_t *m, int8_t *arena) {
+    (void)m;
+    return arena;
+}
+
+// Even layers read from the front of the arena and write to the back, odd
+// layers the other way round.
+const int8_t *nn_run(const nn_model_t *m, int8_t *arena) {
+    const int8_t *in = arena;
+    for (unsigned i = 0; i < m->n_layers; i++) {
+        const nn_layer_t *l = &m->layers[i];
+        int8_t *out = (i & 1u) ? arena : arena + m->arena_bytes - l->out_len * l->out_ch;
+        run_layer(l, in, out);
+        in = out;
+    }
+    return in;
+}
+
+int nn_argmax(const int8_t *v, int n) {
+    int best = 0;
+    for (int i = 1; i < n; i++) {
+        if (v[i] > v[best]) best = i;
+    }
+    return best;
+}
+
+uint32_t nn_macs(const nn_model_t *m) {
+    uint32_t macs = 0;
+    for (unsigned i = 0; i < m->n_layers; i++) {
+        const nn_layer_t *l = &m->layers[i];
+        macs += (uint32_t)l->out_len * l->out_ch * l->kernel * l->in_ch;
+    }
+    return macs;
+}
+
+void nn_quantize_q7(const float *x, int n, float full_scale, int8_t *q, int stride) {
+    const float inv = 1.0f / full_scale;
+    for (int i = 0; i < n; i++, q += stride) {
+        float s = x[i] * inv;
+        if (s < -1.0f) s = -1.0f;
+        if (s > 127.0f / 128.0f) s = 127.0f / 128.0f;
+        if (s != s) s = 0.0f;   // NaN
+        *q = (int8_t)lrintf(s * 128.0f);
+    }
+}
+
+void nn_window_input(const float *ax, const float *ay, const float *az,
+                     const float *gx, const float *gy, const float *gz,
+                     int n, int8_t *q) {
+    nn_quantize_q7(ax, n, NN_ACCEL_FS_G, q + 0, 6);
+    nn_quantize_q7(ay, n, NN_ACCEL_FS_G, q + 1, 6);
+    nn_quantize_q7(az, n, NN_ACCEL_FS_G, q + 2, 6);
+    nn_quantize_q7(gx, n, NN_GYRO_FS_DPS, q + 3, 6);
+    nn_quantize_q7(gy, n, NN_GYRO_FS_DPS, q + 4, 6);
+    nn_quantize_q7(gz, n, NN_GYRO_FS_DPS, q + 5, 6);
+}
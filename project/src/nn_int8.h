@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Int8 inference for small dense / 1D-conv networks, with tables generated by
+// analysis/export_nn.py (e.g. src/gesture_nn.h).
+//
+// Every activation tensor is int8 with one scale and zero point:
+// real = scale * (q - zp). Weights are int8 with zero point 0, biases int32 at
+// scale s_in * s_w with the input zero point already folded in, so a layer is
+// int8 x int8 -> int32 dot products and one requantization per output:
+//
+//   q_out = clamp(zp_out + round(acc * mult / 2^shift), relu ? zp_out : -128, 127)
+//
+// with mult / 2^shift = s_in * s_w / s_out. No float on the hot path.
+//
+// Activations are laid out [time][channel]. A CONV1D output step is the dot
+// product of one output channel's [kernel][in_ch] taps with a contiguous
+// slice of the input, so flattening before a dense layer costs nothing and
+// NN_DENSE is a conv whose kernel covers the whole input. Convolutions are
+// "valid" (no padding).
+//
+// nn_run() ping-pongs between the two ends of a caller-provided arena of
+// m->arena_bytes (the largest input + output of any layer), so a model needs
+// no heap and its RAM is fixed at compile time:
+//
+//   static int8_t arena[GESTURE_NN_ARENA_BYTES];
+
+enum { NN_DENSE = 0, NN_CONV1D = 1 };
+enum { NN_INPUT_FEATURES = 0, NN_INPUT_WINDOW = 1 };
+
+// NN_INPUT_WINDOW inputs are samples divided by these full scales.
+#ifndef NN_ACCEL_FS_G
+#define NN_ACCEL_FS_G   2.0f
+#endif
+#ifndef NN_GYRO_FS_DPS
+#define NN_GYRO_FS_DPS  1000.0f
+#endif
+
+typedef struct {
+    const int8_t *w;        // [out_ch][kernel][in_ch]
+    const int32_t *bias;    // [out_ch]
+    int32_t mult;           // requantization multiplier, [2^30, 2^31)
+    uint8_t shift;          // 1..62
+    int8_t out_zp;
+    uint8_t relu;
+    uint8_t op;             // NN_DENSE / NN_CONV1D
+    uint16_t in_len, in_ch;
+    uint16_t kernel, stride;
+    uint16_t out_len, out_ch;
+} nn_layer_t;
+
+typedef struct {
+    const nn_layer_t *layers;
+    uint8_t n_layers;
+    uint16_t n_in;          // input values, in_len * in_ch of the first layer
+    uint16_t n_out;
+    uint16_t arena_bytes;
+    float in_scale;         // for dequantizing / documentation only
+    int8_t in_zp;
+    float out_scale;
+    int8_t out_zp;
+} nn_model_t;
+
+// Where the caller writes the n_in input values before nn_run().
+int8_t *nn_input(const nn_model_t *m, int8_t *arena);
+// Runs every layer; returns the n_out outputs, inside the arena.
+const int8_t *nn_run(const nn_model_t *m, int8_t *arena);
+// Index of the largest value; ties go to the lower index.
+int nn_argmax(const int8_t *v, int n);
+// Multiply-accumulates per inference.
+uint32_t nn_macs(const nn_model_t *m);
+
+// quantize_bits(x, n, 8, ...) of lab_algorithms/quantization.c: x / full_scale
+// clamped to [-1, 127/128] as Q7, written every `stride` bytes.
+void nn_quantize_q7(const float *x, int n, float full_scale, int8_t *q, int stride);
+// Six channels of n samples (g, dps) to the [n][6] input of an
+// NN_INPUT_WINDOW model.
+void nn_window_input(const float *ax, const float *ay, const float *az,
+                     const float *gx, const float *gy, const float *gz,
+                     int n, int8_t *q);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+// project/src/raw_codec.c
+#include <string.h>
+#include "raw_codec.h"
+
+_Static_assert(RAW_CODEC_HEAD_BYTES == 4 + sizeof(imu_raw_record_t), "head is count, size, first sample");
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t *p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+static uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t *p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+
+static uint8_t *put_varint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80u) {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// NULL if the varint runs past end or is longer than 5 bytes
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v) {
+    uint32_t x = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (p >= end) return NULL;
+        const uint8_t b = *p++;
+        x |= (uint32_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) {
+            *v = x;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t zigzag32(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t unzigzag32(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u); }
+static uint32_t zigzag16(int16_t v) { return (uint16_t)(((uint16_t)v << 1) ^ (uint16_t)(v >> 15)); }
+static int16_t unzigzag16(uint32_t v) { return (int16_t)((uint16_t)(v >> 1) ^ (uint16_t)-(int16_t)(v & 1u)); }
+
+static void channels(const imu_raw_record_t *r, int16_t ch[6]) {
+    ch[0] = r->ax; ch[1] = r->ay; ch[2] = r->az;
+    ch[3] = r->gx; ch[4] = r->gy; ch[5] = r->gz;
+}
+
+void raw_codec_begin(raw_codec_enc_t *e, uint8_t *sector) {
+    memset(e, 0, sizeof(*e));
+    e->sector = sector;
+    e->used = RAW_CODEC_HEAD_BYTES;
+}
+
+bool raw_codec_put(raw_codec_enc_t *e, const imu_raw_record_t *r) {
+    uint8_t *s = e->sector;
+    if (e->n == 0) {
+        put32(s + 4, r->t_us);
+        int16_t ch[6];
+        channels(r, ch);
+        for (int i = 0; i < 6; i++) put16(s + 8 + 2 * i, (uint16_t)ch[i]);
+    } else {
+        if (e->used + RAW_CODEC_MAX_SAMPLE_BYTES > RAW_CODEC_SECTOR_BYTES) return false;
+        uint8_t *p = s + e->used;
+        const uint32_t dt = r->t_us - e->prev.t_us;
+        p = put_varint(p, zigzag32((int32_t)(dt - e->prev_dt)));
+        e->prev_dt = dt;
+
+        int16_t cur[6], prev[6];
+        channels(r, cur);
+        channels(&e->prev, prev);
+        for (int i = 0; i < 6; i++) p = put_varint(p, zigzag16((int16_t)(uint16_t)(cur[i] - prev[i])));
+        e->used = (uint32_t)(p - s);
+    }
+    e->prev = *r;
+    e->n++;
+    return true;
+}
+
+uint16_t raw_codec_finish(raw_codec_enc_t *e) {
+    put16(e->sector, e->n);
+    put16(e->sector + 2, (uint16_t)e->used);
+    memset(e->sector + e->used, 0, RAW_CODEC_SECTOR_BYTES - e->used);
+    return e->n;
+}
+
+int raw_codec_decode(const uint8_t *sector, imu_raw_record_t *out) {
+    const unsigned n = get16(sector);
+    const unsigned used = get16(sector + 2);
+    if (n == 0 && used == 0) return 0;
+    if (n == 0 || n > RAW_CODEC_MAX_SAMPLES || used < RAW_CODEC_HEAD_BYTES || used > RAW_CODEC_SECTOR_BYTES) {
+        return -1;
+    }
+
+    imu_raw_record_t r;
+    r.t_us = get32(sector + 4);
+    r.ax = (int16_t)get16(sector + 8);  r.ay = (int16_t)get16(sector + 10); r.az = (int16_t)get16(sector + 12);
+    r.gx = (int16_t)get16(sector + 14); r.gy = (int16_t)get16(sector + 16); r.gz = (int16_t)get16(sector + 18);
+    out[0] = r;
+
+    const uint8_t *p = sector + RAW_CODEC_HEAD_BYTES;
+    const uint8_t *end = sector + used;
+    uint32_t dt = 0;
+    for (unsigned k = 1; k < n; k++) {
+        uint32_t v[7];
+        for (int i = 0; i < 7; i++) {
+            p = get_varint(p, end, &v[i]);
+            if (!p) return -1;
+        }
+        dt += (uint32_t)unzigzag32(v[0]);
+        r.t_us += dt;
+        r.ax = (int16_t)(uint16_t)(r.ax + unzigzag16(v[1]));
+        r.ay = (int16_t)(uint16_t)(r.ay + unzigzag16(v[2]));
+        r.az = (int16_t)(uint16_t)(r.az + unzigzag16(v[3]));
+        r.gx = (int16_t)(uint16_t)(r.gx + unzigzag16(v[4]));
+        r.gy = (int16_t)(uint16_t)(r.gy + unzigzag16(v[5]));
+        r.gz = (int16_t)(uint16_t)(r.gz + unzigzag16(v[6]));
+        out[k] = r;
+    }
+    return p == end ? (int)n : -1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "imu_log_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lossless codec for the raw sample log (LOG_RAW_SD with RAW_LOG_COMPRESS),
+// IMU_LOG_CODEC_DELTA_VARINT in the file header. Every 512-byte codec sector
+// decodes on its own. Without SD_JOURNAL codec sectors are card sectors, so a
+// sector lost or left stale by a power cut does not affect the others. With
+// SD_JOURNAL they are 512-byte units of the log stream, which the journal cuts
+// into LOG_JOURNAL_PAYLOAD-byte blocks, so one codec sector spans two blocks;
+// a power cut then costs the blocks after the last valid one, i.e. at most a
+// partial last codec sector that the reader drops:
+//
+//   u16 n_samples, u16 used_bytes (incl. this 20-byte head)
+//   first sample verbatim: u32 t_us, i16 ax, ay, az, gx, gy, gz
+//   per further sample:    varint(zigzag(dt - previous dt)),
+//                          varint(zigzag(int16 delta)) for ax .. gz
+//   zero padding
+//
+// All fields little-endian. The timestamp is coded as the change of the
+// sample period, so a steady rate costs one byte. Small sample-to-sample
+// changes cost one byte per channel. A typical sample takes 7-9 bytes
+// instead of 16.
+
+#define RAW_CODEC_SECTOR_BYTES     512
+#define RAW_CODEC_HEAD_BYTES       20
+#define RAW_CODEC_MAX_SAMPLE_BYTES (5 + 6 * 3)   // worst case per coded sample
+#define RAW_CODEC_MAX_SAMPLES      (1 + (RAW_CODEC_SECTOR_BYTES - RAW_CODEC_HEAD_BYTES) / 7)
+
+typedef struct {
+    uint8_t *sector;          // RAW_CODEC_SECTOR_BYTES being filled
+    uint32_t used;
+    uint16_t n;
+    imu_raw_record_t prev;
+    uint32_t prev_dt;
+} raw_codec_enc_t;
+
+// Starts a new sector in `sector`.
+void raw_codec_begin(raw_codec_enc_t *e, uint8_t *sector);
+// Adds one sample. Returns false, and leaves the sector unchanged, if it might
+// not fit; finish the sector and begin a new one.
+bool raw_codec_put(raw_codec_enc_t *e, const imu_raw_record_t *r);
+// Writes the sector head and zeroes the unused tail. Returns the sample count.
+uint16_t raw_codec_finish(raw_codec_enc_t *e);
+
+// Decodes one sector into out[RAW_CODEC_MAX_SAMPLES]. Returns the number of
+// samples, 0 for an empty (zero) sector, or -1 if the sector is not valid.
+int raw_codec_decode(const uint8_t *sector, imu_raw_record_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+#include <string.h>
+#include "raw_logger.h"
+
+static_assert((RAW_LOG_RING_LEN & (RAW_LOG_RING_LEN - 1)) == 0, "RAW_LOG_RING_LEN must be a power of two");
+static_assert(RAW_LOG_RING_LEN % RAW_LOG_SECTOR_RECORDS == 0, "ring sectors must not wrap");
+static_assert(SD_SECTOR_BYTES % sizeof(imu_raw_record_t) == 0, "records must fill a sector exactly");
+static_assert(RAW_CODEC_SECTOR_BYTES == SD_SECTOR_BYTES, "codec sectors are card sectors (stream units with SD_JOURNAL)");
+
+extern "C" {
+
+FRESULT raw_open(raw_logger_t* lg, const char* abs_path, const imu_log_header_t* header) {
+  if (!lg || !header) return FR_INVALID_OBJECT;
+  if (header->codec != RAW_LOG_CODEC) return FR_INVALID_PARAMETER;
+  memset(lg, 0, sizeof(*lg));
+
+  FRESULT fr = sd_writer_open(&lg->w, abs_path, RAW_LOG_PREALLOC_BYTES, SD_RAW_STREAM, SD_JOURNAL);
+  if (fr != FR_OK) return fr;
+
+  uint8_t sector[IMU_LOG_HEADER_BYTES] = {0};   // rest of the sector stays zero
+  memcpy(sector, header, sizeof(*header));
+  fr = sd_writer_append(&lg->w, sector, sizeof sector);
+  if (fr != FR_OK) { sd_writer_close(&lg->w); return fr; }
+
+#if RAW_LOG_COMPRESS
+  raw_codec_begin(&lg->enc, lg->sector);
+#endif
+  lg->open = true;
+  return FR_OK;
+}
+
+bool raw_push(raw_logger_t* lg, const imu_raw_record_t* rec) {
+  const uint32_t depth = lg->head - lg->tail;
+  if (!lg->open || depth >= RAW_LOG_RING_LEN) {
+    lg->dropped++;
+    return false;
+  }
+  lg->ring[lg->head & (RAW_LOG_RING_LEN - 1)] = *rec;
+  lg->head++;
+  if (depth + 1u > lg->max_depth) lg->max_depth = depth + 1u;
+  return true;
+}
+
+// Hands n records starting at the tail to the writer (contiguous in the ring).
+static FRESULT raw_hand_over(raw_logger_t* lg, uint32_t n) {
+  FRESULT fr = sd_writer_append(&lg->w, &lg->ring[lg->tail & (RAW_LOG_RING_LEN - 1)],
+                                n * sizeof(imu_raw_record_t));
+  lg->tail += n;
+  lg->records_written += n;
+  lg->records_out += n;
+  lg->bytes_out += n * sizeof(imu_raw_record_t);
+  return fr;
+}
+
+#if RAW_LOG_COMPRESS
+// Hands the sector being packed to the writer and starts the next one.
+static FRESULT raw_emit_sector(raw_logger_t* lg) {
+  lg->records_out += raw_codec_finish(&lg->enc);
+  lg->bytes_out += RAW_CODEC_SECTOR_BYTES;
+  FRESULT fr = sd_writer_append(&lg->w, lg->sector, RAW_CODEC_SECTOR_BYTES);
+  raw_codec_begin(&lg->enc, lg->sector);
+  return fr;
+}
+
+// Packs ring records; returns true if any was taken. Stops with a full
+// sector while the writer has a buffer pending.
+static bool raw_pack(raw_logger_t* lg, bool flush, FRESULT* fr) {
+  bool moved = false;
+  *fr = FR_OK;
+  while (lg->head != lg->tail) {
+    if (raw_codec_put(&lg->enc, &lg->ring[lg->tail & (RAW_LOG_RING_LEN - 1)])) {
+      lg->tail++;
+      lg->records_written++;
+      moved = true;
+      continue;
+    }
+    if (lg->w.pending && !flush) break;
+    *fr = raw_emit_sector(lg);
+    if (*fr != FR_OK) break;
+  }
+  return moved;
+}
+#endif
+
+FRESULT raw_service(raw_logger_t* lg, bool* did_work) {
+  if (did_work) *did_work = false;
+  if (!lg || !lg->open) return FR_INVALID_OBJECT;
+
+  bool moved = false;
+#if RAW_LOG_COMPRESS
+  FRESULT pack_fr;
+  moved = raw_pack(lg, false, &pack_fr);
+  if (pack_fr != FR_OK) return pack_fr;
+#else
+  while (!lg->w.pending && lg->head - lg->tail >= RAW_LOG_SECTOR_RECORDS) {
+    FRESULT fr = raw_hand_over(lg, RAW_LOG_SECTOR_RECORDS);
+    if (fr != FR_OK) return fr;
+    moved = true;
+  }
+#endif
+
+  FRESULT fr = sd_writer_service(&lg->w, did_work);
+  if (did_work && moved) *did_work = true;
+  return fr;
+}
+
+FRESULT raw_close(raw_logger_t* lg) {
+  if (!lg || !lg->open) return FR_INVALID_OBJECT;
+  lg->open = false;
+  FRESULT fr = FR_OK;
+#if RAW_LOG_COMPRESS
+  raw_pack(lg, true, &fr);
+  if (fr == FR_OK && lg->enc.n) fr = raw_emit_sector(lg);
+#endif
+  while (fr == FR_OK && lg->head != lg->tail) {
+    // up to the end of the ring, then from its start
+    const uint32_t idx = lg->tail & (RAW_LOG_RING_LEN - 1);
+    uint32_t n = lg->head - lg->tail;
+    if (n > RAW_LOG_RING_LEN - idx) n = RAW_LOG_RING_LEN - idx;
+    fr = raw_hand_over(lg, n);
+  }
+  FRESULT fr2 = sd_writer_close(&lg->w);
+  return (fr != FR_OK) ? fr : fr2;
+}
+
+} // extern "C"
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+#include "imu_log_format.h"
+#include "raw_codec.h"
+#include "sd_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-sample raw log (LOG_RAW_SD): every sample as an imu_raw_record_t, in its
+// own .bin next to the per-window log.
+//
+// raw_push() only copies the record into a RAM ring. raw_service(), called
+// from the consumer's idle pass, moves whole sectors from the ring into the
+// sd_writer. It stops as soon as the writer has a buffer pending, so the
+// append can never turn into an inline flush. Then it runs the writer's
+// background flush/sync. While the card is slow the ring takes up the slack.
+// If the ring fills anyway, new records are dropped and counted. Push and
+// service run on the same core, so the ring needs no atomics.
+//
+// With RAW_LOG_COMPRESS the idle pass packs the records into raw_codec
+// sectors instead (about half the bytes) and hands over one sector whenever
+// it is full. The push side costs the same either way.
+
+#ifndef RAW_LOG_RING_LEN
+#define RAW_LOG_RING_LEN       1024    // records, ~1 s at 1 kHz
+#endif
+#ifndef RAW_LOG_PREALLOC_BYTES
+#define RAW_LOG_PREALLOC_BYTES (32u * 1024u * 1024u)
+#endif
+#ifndef RAW_LOG_COMPRESS
+#define RAW_LOG_COMPRESS       1
+#endif
+#define RAW_LOG_CODEC (RAW_LOG_COMPRESS ? IMU_LOG_CODEC_DELTA_VARINT : IMU_LOG_CODEC_NONE)
+
+#define RAW_LOG_SECTOR_RECORDS (SD_SECTOR_BYTES / sizeof(imu_raw_record_t))
+
+typedef struct {
+  sd_writer_t w;
+  bool open;
+  uint32_t head;            // next ring slot to fill
+  uint32_t tail;            // next record for the writer (whole sectors unless compressed)
+  uint32_t dropped;         // records lost to a full ring
+  uint32_t max_depth;       // ring high-water mark
+  unsigned records_written; // taken from the ring (encoded or handed to the writer)
+  uint32_t records_out;     // ...of which in bytes_out
+  uint32_t bytes_out;       // handed to the writer, header excluded
+  imu_raw_record_t ring[RAW_LOG_RING_LEN] __attribute__((aligned(4)));
+#if RAW_LOG_COMPRESS
+  raw_codec_enc_t enc;
+  uint8_t sector[RAW_CODEC_SECTOR_BYTES] __attribute__((aligned(4)));
+#endif
+} raw_logger_t;
+
+// header->codec must be RAW_LOG_CODEC.
+FRESULT raw_open(raw_logger_t* lg, const char* abs_path, const imu_log_header_t* header);
+// Never touches the card. Returns false (and counts a drop) if the ring is full.
+bool raw_push(raw_logger_t* lg, const imu_raw_record_t* rec);
+// Background ring drain + flush/sync; call when there is nothing else to do.
+FRESULT raw_service(raw_logger_t* lg, bool* did_work);
+// Writes everything still in the ring, including a partial sector.
+FRESULT raw_close(raw_logger_t* lg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lock-free single-producer/single-consumer ring of raw IMU samples, used to
+// hand samples from the sampling core to the processing core. Only the
+// producer writes `head` and only the consumer writes `tail`; the
+// release/acquire pair on those indices publishes the slot contents, so no
+// spinlock or interrupt masking is needed on the RP2040.
+//
+// When the ring is full the newest sample is dropped and counted: the
+// sampling side never waits on the consumer.
+
+#ifndef SAMPLE_RING_LEN
+#define SAMPLE_RING_LEN 256
+#endif
+_Static_assert((SAMPLE_RING_LEN & (SAMPLE_RING_LEN - 1)) == 0,
+               "SAMPLE_RING_LEN must be a power of two");
+
+typedef struct {
+    uint64_t t_us;            // time_us_64() when the sample was read
+    int16_t ax, ay, az;       // raw accel counts
+    int16_t gx, gy, gz;       // raw gyro counts
+} imu_sample_t;
+
+typedef struct {
+    imu_sample_t slot[SAMPLE_RING_LEN];
+    uint32_t head;            // next slot to write (producer only)
+    uint32_t tail;            // next slot to read (consumer only)
+    uint32_t dropped;         // samples lost to a full ring (producer only)
+    uint32_t max_depth;       // high-water mark seen by the consumer
+} sample_ring_t;
+
+static inline void sample_ring_init(sample_ring_t* r) {
+    memset(r, 0, sizeof(*r));
+}
+
+// Samples currently queued; safe to call from either side.
+static inline uint32_t sample_ring_depth(const sample_ring_t* r) {
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t sample_ring_dropped(const sample_ring_t* r) {
+    return __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t sample_ring_max_depth(const sample_ring_t* r) {
+    return __atomic_load_n(&r->max_depth, __ATOMIC_RELAXED);
+}
+
+// Producer side. Returns false (and counts a drop) if the ring is full.
+static inline bool sample_ring_push(sample_ring_t* r, const imu_sample_t* s) {
+    const uint32_t head = r->head;
+    const uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= SAMPLE_RING_LEN) {
+        __atomic_store_n(&r->dropped, r->dropped + 1u, __ATOMIC_RELAXED);
+        return false;
+    }
+    r->slot[head & (SAMPLE_RING_LEN - 1)] = *s;
+    __atomic_store_n(&r->head, head + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side. Returns false if the ring is empty.
+static inline bool sample_ring_pop(sample_ring_t* r, imu_sample_t* out) {
+    const uint32_t tail = r->tail;
+    const uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+
+    const uint32_t depth = head - tail;
+    if (depth > r->max_depth) __atomic_store_n(&r->max_depth, depth, __ATOMIC_RELAXED);
+
+    *out = r->slot[tail & (SAMPLE_RING_LEN - 1)];
+    __atomic_store_n(&r->tail, tail + 1u, __ATOMIC_RELEASE);
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,168 @@
+#include <string.h>
+#include "pico/time.h"
+#include "hardware/dma.h"
+#include "hardware/structs/systick.h"
+#include "raw_codec.h"
+#include "sd_bench.h"
+extern "C" {
+#include "crc.h"
+}
+
+#define SD_BENCH_MAX_RECORD 256
+
+extern "C" {
+
+static sd_writer_t g_bench_writer;   // too big for the core1 stack
+
+FRESULT sd_bench_run(const char* abs_path, uint32_t total_bytes, uint32_t record_bytes, bool raw,
+                     sd_bench_result_t* r) {
+  if (!abs_path || !r || record_bytes == 0 || record_bytes > SD_BENCH_MAX_RECORD) return FR_INVALID_PARAMETER;
+  memset(r, 0, sizeof(*r));
+
+  uint8_t rec[SD_BENCH_MAX_RECORD];
+  for (uint32_t i = 0; i < record_bytes; i++) rec[i] = (uint8_t)(i * 37u + 11u);
+
+  sd_writer_t* w = &g_bench_writer;
+  const uint64_t t_open = time_us_64();
+  FRESULT fr = sd_writer_open(w, abs_path, total_bytes + SD_BUF_BYTES, raw, false);
+  if (fr != FR_OK) return fr;
+  r->raw = w->raw_sd != NULL;
+
+  while (fr == FR_OK && r->bytes < total_bytes) {
+    const uint64_t t0 = time_us_64();
+    fr = sd_writer_append(w, rec, record_bytes);
+    if (fr == FR_OK) fr = sd_writer_service(w, NULL);
+    const uint32_t dt = (uint32_t)(time_us_64() - t0);
+    if (dt > r->max_call_us) r->max_call_us = dt;
+    r->bytes += record_bytes;
+    rec[0]++;
+  }
+
+  const uint64_t t_close = time_us_64();
+  FRESULT fr2 = sd_writer_close(w);
+  const uint64_t t_end = time_us_64();
+  r->close_us = (uint32_t)(t_end - t_close);
+  r->elapsed_us = (uint32_t)(t_end - t_open);
+  r->w = w->stats;
+  f_unlink(abs_path);
+  return (fr != FR_OK) ? fr : fr2;
+}
+
+// SysTick as a 24-bit down counter at clk_sys, borrowed for the measurement
+typedef struct { uint32_t csr, rvr; } systick_saved_t;
+
+static systick_saved_t cycles_begin(void) {
+  const systick_saved_t saved = { systick_hw->csr, systick_hw->rvr };
+  systick_hw->rvr = 0xFFFFFFu;
+  systick_hw->cvr = 0;
+  systick_hw->csr = 0x5;   // enabled, processor clock, no interrupt
+  return saved;
+}
+
+static void cycles_end(systick_saved_t saved) {
+  systick_hw->rvr = saved.rvr;
+  systick_hw->csr = saved.csr;
+}
+
+static inline uint32_t cycles_since(uint32_t t0) { return (t0 - systick_hw->cvr) & 0xFFFFFFu; }
+
+void sd_bench_crc(sd_bench_crc_t* r) {
+  static uint8_t block[SD_SECTOR_BYTES] __attribute__((aligned(4)));
+  static uint8_t sink;
+  memset(r, 0, sizeof(*r));
+  for (uint32_t i = 0; i < sizeof block; i++) block[i] = (uint8_t)(i * 37u + 11u);
+
+  const systick_saved_t saved = cycles_begin();
+  uint32_t t0 = systick_hw->cvr;
+  r->sw_crc = crc16(block, sizeof block);
+  r->sw_cycles = cycles_since(t0);
+
+  const int ch = dma_claim_unused_channel(false);
+  if (ch >= 0 && !(dma_hw->sniff_ctrl & DMA_SNIFF_CTRL_EN_BITS)) {
+    // same shape as an SPI block write: 8-bit reads, fixed destination
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+    dma_channel_configure(ch, &c, &sink, block, sizeof block, false);
+
+    t0 = systick_hw->cvr;
+    dma_sniffer_enable(ch, DMA_SNIFF_CTRL_CALC_VALUE_CRC16, false);
+    dma_sniffer_set_data_accumulator(0);
+    uint32_t cycles = cycles_since(t0);
+
+    dma_channel_start(ch);
+    dma_channel_wait_for_finish_blocking(ch);   // the SPI driver waits for the bus anyway
+
+    t0 = systick_hw->cvr;
+    r->sniff_crc = (uint16_t)dma_sniffer_get_data_accumulator();
+    dma_sniffer_disable();
+    r->sniff_cycles = cycles + cycles_since(t0);
+    r->sniffed = true;
+  }
+  if (ch >= 0) dma_channel_unclaim((uint)ch);
+  cycles_end(saved);
+}
+
+// Synthetic 1 kHz stream: gravity on z, sensor noise, a 2 s swing on x and
+// a few us of trigger jitter.
+static uint32_t s_lcg = 12345u;
+
+static int16_t bench_noise(int32_t amp) {
+  s_lcg = s_lcg * 1664525u + 1013904223u;
+  return (int16_t)((int32_t)((s_lcg >> 16) % (uint32_t)(2 * amp + 1)) - amp);
+}
+
+static void bench_sample(uint32_t i, imu_raw_record_t* r) {
+  const int32_t phase = (int32_t)(i % 2000u);
+  const int32_t swing = (phase < 1000 ? phase : 2000 - phase) - 500;
+  r->t_us = i * 1000u + (uint32_t)(bench_noise(3) + 3);
+  r->ax = (int16_t)(swing * 8 + bench_noise(20));
+  r->ay = bench_noise(20);
+  r->az = (int16_t)(16384 + bench_noise(20));
+  r->gx = (int16_t)(swing * 4 + bench_noise(8));
+  r->gy = bench_noise(8);
+  r->gz = bench_noise(8);
+}
+
+void sd_bench_codec(sd_bench_codec_t* r) {
+  static imu_raw_record_t src[RAW_CODEC_MAX_SAMPLES], out[RAW_CODEC_MAX_SAMPLES];
+  static uint8_t sector[RAW_CODEC_SECTOR_BYTES];
+  memset(r, 0, sizeof(*r));
+  r->exact = true;
+  uint64_t enc = 0, dec = 0;
+  uint32_t i = 0;
+
+  const systick_saved_t saved = cycles_begin();
+  while (r->samples < SD_BENCH_CODEC_SAMPLES) {
+    raw_codec_enc_t e;
+    raw_codec_begin(&e, sector);
+    int n = 0;
+    while (n < RAW_CODEC_MAX_SAMPLES) {
+      bench_sample(i, &src[n]);
+      const uint32_t t0 = systick_hw->cvr;
+      const bool ok = raw_codec_put(&e, &src[n]);
+      enc += cycles_since(t0);
+      if (!ok) break;   // sector full, sample i opens the next one
+      n++;
+      i++;
+    }
+    uint32_t t0 = systick_hw->cvr;
+    raw_codec_finish(&e);
+    enc += cycles_since(t0);
+
+    t0 = systick_hw->cvr;
+    const int got = raw_codec_decode(sector, out);
+    dec += cycles_since(t0);
+
+    if (got != n || memcmp(out, src, (size_t)n * sizeof *src) != 0) r->exact = false;
+    r->samples += (uint32_t)n;
+    r->packed_bytes += RAW_CODEC_SECTOR_BYTES;
+  }
+  cycles_end(saved);
+
+  r->enc_cycles = (uint32_t)(enc / r->samples);
+  r->dec_cycles = (uint32_t)(dec / r->samples);
+}
+
+} // extern "C"
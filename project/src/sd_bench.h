@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+#include "sd_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Write benchmark for the logging path (SD_BENCH). Streams total_bytes of
+// record_bytes-sized appends through an sd_writer as fast as it can, with
+// sd_writer_service() after every append like the consumer loop, so the
+// numbers include FatFs, the buffer hand-over and the card interface that
+// hw_config.c selected. The file is deleted afterwards.
+typedef struct {
+  uint32_t bytes;
+  uint32_t elapsed_us;      // open to close, i.e. sustained rate incl. syncs
+  uint32_t max_call_us;     // worst single append+service, what the logger stalls for
+  uint32_t close_us;
+  bool raw;                 // raw mode actually engaged (needs a contiguous reservation)
+  sd_writer_stats_t w;      // per-buffer write and sync latencies
+} sd_bench_result_t;
+
+FRESULT sd_bench_run(const char* abs_path, uint32_t total_bytes, uint32_t record_bytes, bool raw,
+                     sd_bench_result_t* r);
+
+// CPU cycles per 512-byte block for the SD data CRC16: the driver's
+// table-driven crc16() against the DMA sniffer that the SPI driver uses
+// (SPI_CRC_DMA_SNIFFER), which only costs its setup and readback. Counted
+// with SysTick at clk_sys on a memory-to-memory DMA, with both results
+// compared.
+typedef struct {
+  uint32_t sw_cycles;
+  uint32_t sniff_cycles;    // 0 if no DMA channel or the sniffer is busy
+  uint16_t sw_crc;
+  uint16_t sniff_crc;
+  bool sniffed;
+} sd_bench_crc_t;
+
+void sd_bench_crc(sd_bench_crc_t* r);
+
+// raw_codec (RAW_LOG_COMPRESS) on a synthetic 1 kHz IMU stream: SysTick
+// cycles per sample to pack and to unpack, packed size, and whether the
+// round trip is exact.
+#define SD_BENCH_CODEC_SAMPLES 4096
+
+typedef struct {
+  uint32_t samples;
+  uint32_t packed_bytes;    // whole sectors
+  uint32_t enc_cycles;      // per sample
+  uint32_t dec_cycles;
+  bool exact;
+} sd_bench_codec_t;
+
+void sd_bench_codec(sd_bench_codec_t* r);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,463 @@
+#include <string.h>
+#include "pico/rand.h"
+#include "pico/time.h"
+#include "sd_card.h"
+#include "hw_config.h"
+#include "log_journal.h"
+#include "sd_writer.h"
+
+static_assert(SD_BUF_BYTES % SD_SECTOR_BYTES == 0, "SD_BUF_BYTES must be a whole number of sectors");
+static_assert(LOG_JOURNAL_BLOCK_BYTES == SD_SECTOR_BYTES, "journal blocks are card sectors");
+static_assert(SD_BUF_BYTES >= LOG_JOURNAL_FIRST_BLOCK * SD_SECTOR_BYTES, "journal head must fit a buffer");
+
+extern "C" {
+
+// The writer whose write_blocks_start() write is in flight. That write holds
+// the card lock until it is polled to completion, so with more than one
+// writer open (session log + raw sample log) every card access first
+// finishes the other writer's write (sd_writer_claim_card).
+static sd_writer_t* s_in_flight = NULL;
+
+static FRESULT sd_writer_poll(sd_writer_t* w, bool wait);
+
+static void sd_writer_claim_card(sd_writer_t* w) {
+  sd_writer_t* other = s_in_flight;
+  if (!other || other == w) return;
+  const FRESULT fr = sd_writer_poll(other, true);
+  if (fr != FR_OK) other->error = fr;   // reported by its own next call
+}
+
+// Raw mode ran past the reservation: end the multi-block write, point FatFs
+// at the end of the raw data and carry on through f_write.
+static FRESULT sd_writer_leave_raw(sd_writer_t* w) {
+  sd_card_t* sd = w->raw_sd;
+  w->raw_sd = NULL;
+  if (sd->sync(sd) != SD_BLOCK_DEVICE_ERROR_NONE) return FR_DISK_ERR;
+  return f_lseek(&w->file, w->raw_bytes);
+}
+
+// Writes len bytes at the raw cursor; a tail that is not a whole sector is
+// zero padded in place (only ever the last write, from sd_writer_close).
+static FRESULT sd_writer_put_raw(sd_writer_t* w, uint8_t* data, uint32_t len, UINT* bw) {
+  const uint32_t n = (len + SD_SECTOR_BYTES - 1) / SD_SECTOR_BYTES;
+  if (len % SD_SECTOR_BYTES) memset(data + len, 0, n * SD_SECTOR_BYTES - len);
+  if (w->raw_sd->write_blocks(w->raw_sd, data, w->raw_lba, n) != SD_BLOCK_DEVICE_ERROR_NONE) {
+    return FR_DISK_ERR;
+  }
+  w->raw_lba += n;
+  w->raw_bytes += len;
+  *bw = len;
+  return FR_OK;
+}
+
+static void sd_writer_count_write(sd_writer_t* w, uint64_t t0, uint32_t bytes) {
+  const uint32_t dt = (uint32_t)(time_us_64() - t0);
+  w->stats.last_write_us = dt;
+  if (dt > w->stats.max_write_us) w->stats.max_write_us = dt;
+  w->stats.total_write_us += dt;
+  w->stats.bytes += bytes;
+  w->unsynced += bytes;
+}
+
+static FRESULT sd_writer_put(sd_writer_t* w, uint8_t* data, uint32_t len) {
+  sd_writer_claim_card(w);
+  if (w->raw_sd && w->raw_lba + (len + SD_SECTOR_BYTES - 1) / SD_SECTOR_BYTES > w->raw_end) {
+    FRESULT fr = sd_writer_leave_raw(w);
+    if (fr != FR_OK) return fr;
+  }
+  // fast seek cannot follow the chain past the mapped run
+  if (w->file.cltbl && f_tell(&w->file) + len > w->prealloc) w->file.cltbl = NULL;
+
+  const uint64_t t0 = time_us_64();
+  UINT bw = 0;
+  FRESULT fr = w->raw_sd ? sd_writer_put_raw(w, data, len, &bw)
+                         : f_write(&w->file, data, len, &bw);
+  if (fr == FR_OK && bw != len) fr = FR_DENIED;   // volume full
+  sd_writer_count_write(w, t0, bw);
+  return fr;
+}
+
+// Journal: writes checkpoint w->jgen into its slot. The slots alternate, so a
+// write cut off by power loss leaves the previous checkpoint intact. Only
+// called with nothing pending, so the inactive buffer is free to build it in.
+static FRESULT sd_writer_checkpoint(sd_writer_t* w, uint32_t state, uint32_t blocks, uint32_t payload) {
+  uint8_t* sector = w->buf[w->active ^ 1u];
+  const log_journal_checkpoint_t cp = { w->jgen, blocks, payload, state };
+  log_journal_checkpoint(sector, w->session, &cp);
+  const uint32_t slot = LOG_JOURNAL_SLOT(w->jgen);
+  w->jgen++;
+
+  if (w->raw_sd) {
+    return w->raw_sd->write_blocks(w->raw_sd, sector, w->raw_lba0 + slot, 1) == SD_BLOCK_DEVICE_ERROR_NONE
+               ? FR_OK : FR_DISK_ERR;
+  }
+  const FSIZE_t pos = f_tell(&w->file);
+  UINT bw = 0;
+  FRESULT fr = f_lseek(&w->file, (FSIZE_t)slot * SD_SECTOR_BYTES);
+  if (fr == FR_OK) fr = f_write(&w->file, sector, SD_SECTOR_BYTES, &bw);
+  if (fr == FR_OK && bw != SD_SECTOR_BYTES) fr = FR_DENIED;
+  const FRESULT fr2 = f_lseek(&w->file, pos);
+  return (fr != FR_OK) ? fr : fr2;
+}
+
+// Timed sync: puts what the active buffer holds so far on the card at the
+// cursor, without advancing it. The flush of the full buffer later writes the
+// same sectors again. Journal: the block being filled is sealed short in place
+// (appends overwrite the padding and the trailer); the file then ends in a
+// short block, which recovery takes as the end. Only called with nothing
+// pending, so the cursor is where this buffer goes.
+static FRESULT sd_writer_put_tail(sd_writer_t* w) {
+  const uint32_t part = w->fill % SD_SECTOR_BYTES;
+  if (w->journal && part) {
+    log_journal_seal(&w->buf[w->active][w->fill - part], w->session, w->jseq, part);
+  }
+  const uint32_t len = w->journal ? w->fill - part + (part ? SD_SECTOR_BYTES : 0u) : w->fill;
+  const uint32_t n = (len + SD_SECTOR_BYTES - 1) / SD_SECTOR_BYTES;
+
+  sd_writer_claim_card(w);
+  if (w->raw_sd && w->raw_lba + n > w->raw_end) {
+    FRESULT fr = sd_writer_leave_raw(w);
+    if (fr != FR_OK) return fr;
+  }
+  if (w->file.cltbl && f_tell(&w->file) + len > w->prealloc) w->file.cltbl = NULL;
+
+  const uint64_t t0 = time_us_64();
+  FRESULT fr = FR_OK;
+  if (w->raw_sd) {
+    if (len % SD_SECTOR_BYTES) memset(&w->buf[w->active][len], 0, n * SD_SECTOR_BYTES - len);
+    if (w->raw_sd->write_blocks(w->raw_sd, w->buf[w->active], w->raw_lba, n) != SD_BLOCK_DEVICE_ERROR_NONE) {
+      fr = FR_DISK_ERR;
+    }
+  } else {
+    const FSIZE_t pos = f_tell(&w->file);
+    UINT bw = 0;
+    fr = f_write(&w->file, w->buf[w->active], len, &bw);
+    if (fr == FR_OK && bw != len) fr = FR_DENIED;
+    const FRESULT fr2 = f_lseek(&w->file, pos);
+    if (fr == FR_OK) fr = fr2;
+  }
+  sd_writer_count_write(w, t0, 0);
+  w->stats.tail_writes++;
+  if (fr == FR_OK) w->tail = w->fill;
+  return fr;
+}
+
+static FRESULT sd_writer_sync(sd_writer_t* w) {
+  sd_writer_claim_card(w);
+  const uint64_t t0 = time_us_64();
+  FRESULT fr = FR_OK;
+  if (w->raw_sd) {
+    // nothing to commit on the FAT side until close; flush the card instead
+    if (w->raw_sd->sync(w->raw_sd) != SD_BLOCK_DEVICE_ERROR_NONE) fr = FR_DISK_ERR;
+  } else {
+    fr = f_sync(&w->file);
+  }
+  if (fr == FR_OK && w->journal) {
+    // everything written so far is whole sealed blocks, now on the card, and
+    // so are the full blocks of a tail written by sd_writer_put_tail
+    const uint32_t blocks = (w->stats.bytes + w->tail) / SD_SECTOR_BYTES - LOG_JOURNAL_FIRST_BLOCK;
+    fr = sd_writer_checkpoint(w, LOG_JOURNAL_OPEN, blocks, blocks * LOG_JOURNAL_PAYLOAD);
+  }
+  const uint64_t t1 = time_us_64();
+
+  const uint32_t dt = (uint32_t)(t1 - t0);
+  w->stats.syncs++;
+  w->stats.last_sync_us = dt;
+  if (dt > w->stats.max_sync_us) w->stats.max_sync_us = dt;
+  w->stats.total_sync_us += dt;
+  w->unsynced = 0;
+  w->last_sync_at_us = t1;
+  return fr;
+}
+
+// Raw mode, async driver, and the buffer fits the reservation.
+static bool sd_writer_can_start(const sd_writer_t* w) {
+  return SD_ASYNC_WRITE && w->raw_sd && w->raw_sd->write_blocks_start &&
+         w->raw_lba + SD_BUF_BYTES / SD_SECTOR_BYTES <= w->raw_end;
+}
+
+static FRESULT sd_writer_start_pending(sd_writer_t* w) {
+  sd_writer_claim_card(w);
+  w->in_flight_t0 = time_us_64();
+  if (w->raw_sd->write_blocks_start(w->raw_sd, w->buf[w->active ^ 1u], w->raw_lba,
+                                    SD_BUF_BYTES / SD_SECTOR_BYTES) != SD_BLOCK_DEVICE_ERROR_NONE) {
+    return FR_DISK_ERR;
+  }
+  w->in_flight = true;
+  s_in_flight = w;
+  w->stats.async_flushes++;
+  return FR_OK;
+}
+
+// One poll of the write in flight, or (wait) until it is done.
+static FRESULT sd_writer_poll(sd_writer_t* w, bool wait) {
+  const block_dev_err_t rc = wait ? sd_write_blocks_complete(w->raw_sd)
+                                  : w->raw_sd->write_blocks_poll(w->raw_sd);
+  if (rc == SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK) return FR_OK;
+
+  w->in_flight = false;
+  s_in_flight = NULL;
+  w->pending = false;
+  w->stats.flushes++;
+  if (rc != SD_BLOCK_DEVICE_ERROR_NONE) {
+    sd_writer_count_write(w, w->in_flight_t0, 0);
+    return FR_DISK_ERR;
+  }
+  w->raw_lba += SD_BUF_BYTES / SD_SECTOR_BYTES;
+  w->raw_bytes += SD_BUF_BYTES;
+  sd_writer_count_write(w, w->in_flight_t0, SD_BUF_BYTES);
+  return FR_OK;
+}
+
+// Writes the full buffer that is not being filled (or finishes it). Syncs
+// once that reaches the byte budget: when appends keep flushing inline and
+// the service loop never gets to sync, the journal still checkpoints, so the
+// blocks past the newest checkpoint stay within SD_JOURNAL_SCAN_BLOCKS.
+static FRESULT sd_writer_flush_pending(sd_writer_t* w) {
+  FRESULT fr;
+  if (w->in_flight) {
+    fr = sd_writer_poll(w, true);
+  } else {
+    fr = sd_writer_put(w, w->buf[w->active ^ 1u], SD_BUF_BYTES);
+    w->pending = false;
+    w->stats.flushes++;
+  }
+  if (fr == FR_OK && w->unsynced >= SD_SYNC_BYTES) fr = sd_writer_sync(w);
+  return fr;
+}
+
+// Reserves one contiguous run of clusters and maps it for fast seek.
+static void sd_writer_prealloc(sd_writer_t* w, uint32_t bytes) {
+  if (f_expand(&w->file, bytes, 1) != FR_OK) return;   // no contiguous space: grow normally
+
+  w->clmt[0] = SD_CLMT_LEN;
+  w->file.cltbl = w->clmt;
+  if (f_lseek(&w->file, CREATE_LINKMAP) != FR_OK) {
+    w->file.cltbl = NULL;   // still contiguous, just without the FAT shortcut
+  }
+  w->prealloc = bytes;
+}
+
+// Locates the reservation on the card: first data sector of its start cluster.
+static void sd_writer_enter_raw(sd_writer_t* w) {
+  FATFS* fs = w->file.obj.fs;
+  sd_card_t* sd = sd_get_by_num(fs->pdrv);
+  if (!sd || w->file.obj.sclust < 2) return;
+
+  w->raw_lba = (uint32_t)(fs->database + (LBA_t)fs->csize * (w->file.obj.sclust - 2));
+  w->raw_end = w->raw_lba + w->prealloc / SD_SECTOR_BYTES;
+  w->raw_bytes = 0;
+  w->file.cltbl = NULL;   // FatFs does not write inside the reservation in raw mode
+  w->raw_sd = sd;
+}
+
+// Journal header, first checkpoint and an empty second slot, written before
+// any data.
+static FRESULT sd_writer_start_journal(sd_writer_t* w) {
+  w->journal = true;
+  w->session = get_rand_32();
+  w->raw_lba0 = w->raw_lba;
+
+  uint8_t* head = w->buf[0];
+  log_journal_header(head, w->session);
+  const log_journal_checkpoint_t cp = { 0, 0, 0, LOG_JOURNAL_OPEN };
+  log_journal_checkpoint(head + LOG_JOURNAL_SLOT(0) * SD_SECTOR_BYTES, w->session, &cp);
+  memset(head + LOG_JOURNAL_SLOT(1) * SD_SECTOR_BYTES, 0, SD_SECTOR_BYTES);
+  w->jgen = 1;
+  FRESULT fr = sd_writer_put(w, head, LOG_JOURNAL_FIRST_BLOCK * SD_SECTOR_BYTES);
+  // Put size and start cluster in the directory now: raw mode would not
+  // until close, and a cut-off log must still be there to recover.
+  if (fr == FR_OK) fr = f_sync(&w->file);
+  return fr;
+}
+
+FRESULT sd_writer_open(sd_writer_t* w, const char* abs_path, uint32_t prealloc_bytes, bool raw,
+                       bool journal) {
+  if (!w) return FR_INVALID_OBJECT;
+  memset(w, 0, sizeof(*w));
+  sd_writer_claim_card(w);
+  FRESULT fr = f_open(&w->file, abs_path, FA_WRITE | FA_CREATE_ALWAYS);
+  if (fr != FR_OK) return fr;
+  if (prealloc_bytes) sd_writer_prealloc(w, prealloc_bytes);
+  if (raw && w->prealloc) sd_writer_enter_raw(w);
+  if (journal) {
+    fr = sd_writer_start_journal(w);
+    if (fr != FR_OK) {
+      f_close(&w->file);
+      return fr;
+    }
+  }
+  w->open = true;
+  w->last_sync_at_us = time_us_64();
+  return FR_OK;
+}
+
+// Journal: seals the block being filled with the payload it has so far and
+// moves to the next one.
+static void sd_writer_seal(sd_writer_t* w) {
+  const uint32_t len = w->fill % SD_SECTOR_BYTES;
+  log_journal_seal(&w->buf[w->active][w->fill - len], w->session, w->jseq++, len);
+  w->jpayload += len;
+  w->fill += SD_SECTOR_BYTES - len;
+}
+
+FRESULT sd_writer_append(sd_writer_t* w, const void* data, size_t len) {
+  if (!w || !w->open) return FR_INVALID_OBJECT;
+  const uint8_t* p = (const uint8_t*)data;
+  while (len) {
+    // journal: up to the trailer of the current block
+    const uint32_t end = w->journal ? w->fill - w->fill % SD_SECTOR_BYTES + LOG_JOURNAL_PAYLOAD
+                                    : SD_BUF_BYTES;
+    uint32_t n = end - w->fill;
+    if (n > len) n = (uint32_t)len;
+    memcpy(&w->buf[w->active][w->fill], p, n);
+    w->fill += n;
+    p += n;
+    len -= n;
+
+    if (w->journal && w->fill == end) sd_writer_seal(w);
+    if (w->fill == SD_BUF_BYTES) {
+      if (w->pending) {
+        // the service loop fell behind: stall here rather than drop data
+        w->stats.inline_flushes++;
+        FRESULT fr = sd_writer_flush_pending(w);
+        if (fr != FR_OK) return fr;
+      }
+      w->pending = true;
+      w->active ^= 1u;
+      w->fill = 0;
+      w->tail = 0;
+    }
+  }
+  return FR_OK;
+}
+
+FRESULT sd_writer_service(sd_writer_t* w, bool* did_work) {
+  if (did_work) *did_work = false;
+  if (!w || !w->open) return FR_INVALID_OBJECT;
+  if (w->error != FR_OK) return w->error;
+
+  if (w->in_flight || w->pending) {
+    if (did_work) *did_work = true;
+    FRESULT fr;
+    if (w->in_flight) {
+      fr = sd_writer_poll(w, false);
+    } else if (sd_writer_can_start(w)) {
+      fr = sd_writer_start_pending(w);
+    } else {
+      fr = sd_writer_flush_pending(w);
+    }
+    if (fr != FR_OK || w->in_flight) return fr;   // no sync while the card is busy
+  }
+
+  if (w->unsynced >= SD_SYNC_BYTES) {
+    if (did_work) *did_work = true;
+    return sd_writer_sync(w);
+  }
+  if ((w->unsynced || w->fill != w->tail) &&
+      time_us_64() - w->last_sync_at_us >= (uint64_t)SD_SYNC_MS * 1000u) {
+    if (did_work) *did_work = true;
+    FRESULT fr = (w->fill != w->tail) ? sd_writer_put_tail(w) : FR_OK;
+    if (fr == FR_OK) fr = sd_writer_sync(w);
+    return fr;
+  }
+  return FR_OK;
+}
+
+FRESULT sd_writer_close(sd_writer_t* w) {
+  if (!w || !w->open) return FR_INVALID_OBJECT;
+  sd_writer_claim_card(w);
+  FRESULT fr = w->error;
+  if (fr == FR_OK && w->pending) fr = sd_writer_flush_pending(w);
+  if (w->journal && w->fill % SD_SECTOR_BYTES) sd_writer_seal(w);   // short last block
+  if (fr == FR_OK && w->fill) {
+    fr = sd_writer_put(w, w->buf[w->active], w->fill);   // partial tail
+    w->fill = 0;
+  }
+  if (fr == FR_OK && w->raw_sd) {
+    // end the multi-block write, then the one metadata update of the session
+    fr = sd_writer_leave_raw(w);
+  }
+  if (fr == FR_OK && w->journal) {
+    fr = sd_writer_checkpoint(w, LOG_JOURNAL_CLOSED, w->jseq, w->jpayload);
+    w->journal = false;   // the final sync must not checkpoint again
+  }
+  if (fr == FR_OK && w->prealloc) {
+    w->file.cltbl = NULL;
+    fr = f_truncate(&w->file);   // drop the unused part of the reservation
+  }
+  FRESULT fr2 = sd_writer_sync(w);
+  FRESULT fr3 = f_close(&w->file);
+  w->open = false;
+  if (fr != FR_OK) return fr;
+  return (fr2 != FR_OK) ? fr2 : fr3;
+}
+
+// Boot-time only, so shared by all files: both checkpoint slots, or a block.
+static uint8_t s_recover[2][SD_SECTOR_BYTES] __attribute__((aligned(4)));
+
+static FRESULT sd_writer_read_sector(FIL* f, uint32_t sector, uint8_t* dst) {
+  UINT br = 0;
+  FRESULT fr = f_lseek(f, (FSIZE_t)sector * SD_SECTOR_BYTES);
+  if (fr == FR_OK) fr = f_read(f, dst, SD_SECTOR_BYTES, &br);
+  if (fr == FR_OK && br != SD_SECTOR_BYTES) fr = FR_INT_ERR;   // past the end
+  return fr;
+}
+
+FRESULT sd_writer_recover(const char* abs_path, sd_writer_recovery_t* r) {
+  if (!r) return FR_INVALID_OBJECT;
+  memset(r, 0, sizeof(*r));
+  const uint64_t t0 = time_us_64();
+  FIL f;
+  FRESULT fr = f_open(&f, abs_path, FA_READ | FA_WRITE);
+  if (fr != FR_OK) return fr;
+
+  uint32_t session = 0;
+  if (f_size(&f) < LOG_JOURNAL_FIRST_BLOCK * SD_SECTOR_BYTES ||
+      sd_writer_read_sector(&f, 0, s_recover[0]) != FR_OK || !log_journal_parse_header(s_recover[0], &session)) {
+    return f_close(&f);   // not journaled
+  }
+  r->journaled = true;
+
+  fr = sd_writer_read_sector(&f, LOG_JOURNAL_SLOT(0), s_recover[0]);
+  if (fr == FR_OK) fr = sd_writer_read_sector(&f, LOG_JOURNAL_SLOT(1), s_recover[1]);
+  if (fr != FR_OK) {
+    f_close(&f);
+    return fr;
+  }
+  log_journal_checkpoint_t cp;
+  log_journal_newest_checkpoint(s_recover[0], s_recover[1], session, &cp);   // none: scan from block 0
+  r->state = cp.state;
+  r->checkpoint = r->blocks = cp.blocks;
+  if (cp.state != LOG_JOURNAL_OPEN) return f_close(&f);
+
+  // The blocks up to the checkpoint are on the card; look only past it.
+  uint32_t payload = cp.payload_bytes;
+  while (r->scanned < SD_JOURNAL_SCAN_BLOCKS &&
+         sd_writer_read_sector(&f, LOG_JOURNAL_FIRST_BLOCK + r->blocks, s_recover[0]) == FR_OK) {
+    r->scanned++;
+    const int len = log_journal_check(s_recover[0], session, r->blocks);
+    if (len < 0) break;
+    r->blocks++;
+    payload += (uint32_t)len;
+    if (len < LOG_JOURNAL_PAYLOAD) break;   // short block: the log was being closed
+  }
+
+  // Truncate before marking it recovered: if power fails in between, the next
+  // boot just scans the same tail again.
+  fr = f_lseek(&f, (FSIZE_t)(LOG_JOURNAL_FIRST_BLOCK + r->blocks) * SD_SECTOR_BYTES);
+  if (fr == FR_OK) fr = f_truncate(&f);
+  if (fr == FR_OK) fr = f_sync(&f);
+  if (fr == FR_OK) {
+    const log_journal_checkpoint_t done = { cp.gen + 1u, r->blocks, payload, LOG_JOURNAL_RECOVERED };
+    log_journal_checkpoint(s_recover[0], session, &done);
+    UINT bw = 0;
+    fr = f_lseek(&f, (FSIZE_t)LOG_JOURNAL_SLOT(done.gen) * SD_SECTOR_BYTES);
+    if (fr == FR_OK) fr = f_write(&f, s_recover[0], SD_SECTOR_BYTES, &bw);
+  }
+  const FRESULT fr2 = f_close(&f);
+  r->us = (uint32_t)(time_us_64() - t0);
+  return (fr != FR_OK) ? fr : fr2;
+}
+
+} // extern "C"
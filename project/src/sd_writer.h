@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Double-buffered, sector-aligned file writer shared by csv_logger and
+// bin_logger. Appends only copy into the active RAM buffer. A full buffer is
+// handed over to sd_writer_service(), which the consumer loop calls when it
+// has no samples to process, and goes out as one whole-sector f_write. f_sync
+// only runs when SD_SYNC_MS or SD_SYNC_BYTES is exceeded.
+//
+// If both buffers are full when an append arrives, the pending one is
+// written inline; that stall is counted in inline_flushes. A writer whose
+// service loop is starved this way still syncs on SD_SYNC_BYTES, inline too.
+//
+// A sync on SD_SYNC_MS also writes what the active buffer holds so far, in
+// place: the write position does not move, and the flush of the full buffer
+// writes the same sectors again. A power loss therefore costs at most about
+// SD_SYNC_MS of data, or SD_SYNC_BYTES plus both buffers at rates where the
+// byte budget syncs first.
+//
+// sd_writer_open() can reserve one contiguous cluster run with f_expand and
+// map it for FatFs fast seek. Writes inside it then never touch the FAT, so
+// crossing a cluster costs nothing extra. The file is truncated to the data
+// on close. Past the reservation the file grows cluster by cluster as usual.
+// After a power loss the file keeps its reserved size with stale data after
+// the last sync.
+//
+// Raw mode (SD_RAW_STREAM) goes one step further for high-rate capture: full
+// buffers bypass FatFs and go to the reserved sectors through the driver's
+// write_blocks(). Consecutive LBAs keep one open-ended CMD25 multi-block write
+// running on both the SPI and the SDIO driver. The budget "sync" only ends
+// the multi-block write (card-level flush). File size and directory entry are
+// updated once, at close. A session longer than the reservation continues
+// through f_write.
+//
+// With SD_ASYNC_WRITE and a driver that has write_blocks_start(), raw mode
+// does not wait for the card either. sd_writer_service() starts the pending
+// buffer and returns. Later calls poll it until it is programmed, and the
+// consumer keeps processing samples in between. Anything that needs the card
+// (inline flush, sync, close) first waits for the write in flight, including
+// one started by another open writer.
+//
+// With journal (SD_JOURNAL, binary logs only) the file is framed as in
+// log_journal.h. Appends fill the payload of each block and seal it with its
+// sequence number and CRC when full. Every budget sync also writes a
+// checkpoint: the number of whole blocks on the card, alternating between
+// two slots. A timed sync seals the block being filled short, in place.
+// Closing writes a final checkpoint. At boot sd_writer_recover() finds the
+// end of a log that was never closed by checking blocks forward from its
+// newest checkpoint. It reads at most SD_JOURNAL_SCAN_BLOCKS blocks, then
+// truncates the file there and marks it recovered. Recovery time is bounded
+// by the sync budget, not by the length of the session.
+
+#ifndef SD_BUF_BYTES
+#define SD_BUF_BYTES   2048
+#endif
+#ifndef SD_SYNC_MS
+#define SD_SYNC_MS     1000
+#endif
+#ifndef SD_SYNC_BYTES
+#define SD_SYNC_BYTES  (16u * 1024u)
+#endif
+
+#ifndef SD_PREALLOC_BYTES
+#define SD_PREALLOC_BYTES (8u * 1024u * 1024u)
+#endif
+#ifndef SD_RAW_STREAM
+#define SD_RAW_STREAM  0
+#endif
+#ifndef SD_ASYNC_WRITE
+#define SD_ASYNC_WRITE 1
+#endif
+#ifndef SD_JOURNAL
+#define SD_JOURNAL     1
+#endif
+
+#define SD_SECTOR_BYTES 512
+#define SD_CLMT_LEN     8       // fast-seek map: one fragment is enough when contiguous
+
+// Blocks that can be on the card past the newest checkpoint: one sync budget
+// plus both buffers, twice over in case the last checkpoint write was lost.
+#define SD_JOURNAL_SCAN_BLOCKS (2u * (SD_SYNC_BYTES + 2u * SD_BUF_BYTES) / SD_SECTOR_BYTES)
+
+typedef struct {
+  uint32_t flushes;         // buffers written
+  uint32_t inline_flushes;  // ...of which from sd_writer_append (caller stalled)
+  uint32_t async_flushes;   // ...of which started non-blocking (write_us: start to done)
+  uint32_t syncs;
+  uint32_t tail_writes;     // partial buffers written in place by a timed sync
+  uint32_t bytes;           // bytes handed to f_write (tail writes not included)
+  uint32_t last_write_us;
+  uint32_t max_write_us;
+  uint32_t last_sync_us;
+  uint32_t max_sync_us;
+  uint64_t total_write_us;
+  uint64_t total_sync_us;
+} sd_writer_stats_t;
+
+typedef struct sd_card_t sd_card_t;
+
+typedef struct {
+  FIL file;
+  bool open;
+  uint32_t prealloc;        // reserved contiguous bytes, 0 if f_expand failed
+  DWORD clmt[SD_CLMT_LEN];
+  sd_card_t* raw_sd;        // raw mode: card written directly, NULL = FatFs
+  uint32_t raw_lba;         // next sector of the reservation
+  uint32_t raw_end;         // first sector past it
+  uint32_t raw_bytes;       // bytes written in raw mode (file size at close)
+  bool in_flight;           // pending buffer is being written (write_blocks_start)
+  uint64_t in_flight_t0;
+  FRESULT error;            // async write that failed while another writer waited on it
+  uint8_t active;           // buffer currently being filled
+  bool pending;             // the other buffer is full and waiting
+  uint32_t fill;            // bytes in the active buffer
+  uint32_t tail;            // ...of which the last timed sync put on the card
+  uint32_t unsynced;        // bytes written since the last f_sync
+  uint64_t last_sync_at_us;
+  bool journal;             // file framed as log_journal.h blocks
+  uint32_t session;         // journal: CRC seed of this file
+  uint32_t jseq;            // journal: blocks sealed
+  uint32_t jpayload;        // journal: stream bytes in them
+  uint32_t jgen;            // journal: checkpoints written
+  uint32_t raw_lba0;        // raw mode: first sector of the file
+  sd_writer_stats_t stats;
+  uint8_t buf[2][SD_BUF_BYTES] __attribute__((aligned(4)));
+} sd_writer_t;
+
+// prealloc_bytes = 0 skips the reservation. Failing to reserve is not an
+// error (w->prealloc stays 0). raw asks for raw mode, which needs the
+// reservation; without it the writer stays on FatFs (w->raw_sd == NULL).
+// journal frames the file for power-loss recovery.
+FRESULT sd_writer_open(sd_writer_t* w, const char* abs_path, uint32_t prealloc_bytes, bool raw,
+                       bool journal);
+FRESULT sd_writer_append(sd_writer_t* w, const void* data, size_t len);
+// Background work: write a pending buffer (or advance the one in flight)
+// and/or sync on budget. Returns FR_OK with nothing done if there is no work;
+// *did_work tells which, and stays true while a write is in flight.
+FRESULT sd_writer_service(sd_writer_t* w, bool* did_work);
+FRESULT sd_writer_close(sd_writer_t* w);
+
+typedef struct {
+  bool journaled;           // file has a journal header (others are left alone)
+  uint32_t state;           // LOG_JOURNAL_* of its newest checkpoint
+  uint32_t checkpoint;      // blocks in that checkpoint
+  uint32_t blocks;          // valid blocks (after recovery)
+  uint32_t scanned;         // blocks read past the checkpoint
+  uint32_t us;
+} sd_writer_recovery_t;
+
+// Boot-time repair of a journaled log that was not closed: truncates it after
+// its last valid block and marks it recovered. Closed logs and files without
+// a journal are only read (one or three sectors).
+FRESULT sd_writer_recover(const char* abs_path, sd_writer_recovery_t* r);
+
+#ifdef __cplusplus
+}
+#endif
@@ -73,6 +73,7 @@ typedef struct sd_sdio_if_state_t {
     // Variables for extended block writes
     bool ongoing_wr_mlt_blk;
     uint32_t wr_mlt_blk_cnt_sector;
+    bool wr_async; // write_blocks_start() transfer in progress
     
     // Variables for block reads
     // This is used to perform DMA into data buffers and checksum buffers separately.
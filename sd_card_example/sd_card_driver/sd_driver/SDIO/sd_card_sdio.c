@@ -608,6 +608,59 @@ static block_dev_err_t sd_sdio_write_blocks(sd_card_t *sd_card_p, const uint8_t
     else
         return SD_BLOCK_DEVICE_ERROR_WRITE;
 }
+/* Non-blocking counterpart of sd_sdio_writeSectors(): the transfer already
+runs from the DMA IRQ, so start returns right after rp2040_sdio_tx_start()
+and poll wraps rp2040_sdio_tx_poll() (timeout: sd_timeouts.rp2040_sdio_tx_poll).
+The card stays locked until the poll reports completion. */
+static block_dev_err_t sd_sdio_write_blocks_start(sd_card_t *sd_card_p, const uint8_t *buffer,
+                                                  uint32_t ulSectorNumber, uint32_t blockCnt) {
+    TRACE_PRINTF("%s(,,,%zu)\n", __func__, blockCnt);
+    // No bounce buffer here: the DMA streams straight from the caller's words
+    if (!blockCnt || ((uint32_t)buffer & 3) != 0 || STATE.wr_async)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+
+    sd_lock(sd_card_p);
+
+    bool ok;
+    if (STATE.ongoing_wr_mlt_blk && ulSectorNumber == STATE.wr_mlt_blk_cnt_sector) {
+        /* Continue a multiblock write */
+        ok = checkReturnOk(rp2040_sdio_tx_start(sd_card_p, buffer, blockCnt));
+    } else {
+        uint32_t reply;
+        ok = (!STATE.ongoing_wr_mlt_blk || sd_sdio_stopTransmission(sd_card_p, true)) &&
+             checkReturnOk(rp2040_sdio_command_R1(sd_card_p, CMD25_WRITE_MULTIPLE_BLOCK, ulSectorNumber, &reply)) &&
+             checkReturnOk(rp2040_sdio_tx_start(sd_card_p, buffer, blockCnt));
+    }
+    if (!ok) {
+        sd_unlock(sd_card_p);
+        return SD_BLOCK_DEVICE_ERROR_WRITE;
+    }
+    // Not continuable until the transfer is through
+    STATE.ongoing_wr_mlt_blk = false;
+    STATE.wr_mlt_blk_cnt_sector = ulSectorNumber + blockCnt;
+    STATE.wr_async = true;
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+static block_dev_err_t sd_sdio_write_blocks_poll(sd_card_t *sd_card_p) {
+    if (!STATE.wr_async) return SD_BLOCK_DEVICE_ERROR_NONE;
+
+    uint32_t bytes_done;
+    STATE.error = rp2040_sdio_tx_poll(sd_card_p, &bytes_done);
+    if (STATE.error == SDIO_BUSY) return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+
+    STATE.wr_async = false;
+    block_dev_err_t rc = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (STATE.error != SDIO_OK) {
+        EMSG_PRINTF("%s(%lu) failed: %s (%d)\n", __func__, STATE.wr_mlt_blk_cnt_sector,
+                    errstr(STATE.error), (int)STATE.error);
+        sd_sdio_stopTransmission(sd_card_p, true);
+        rc = SD_BLOCK_DEVICE_ERROR_WRITE;
+    } else {
+        STATE.ongoing_wr_mlt_blk = true;
+    }
+    sd_unlock(sd_card_p);
+    return rc;
+}
 static block_dev_err_t sd_sdio_read_blocks(sd_card_t *sd_card_p, uint8_t *buffer, uint32_t ulSectorNumber,
                                            uint32_t ulSectorCount) {
     bool ok = true;
@@ -658,6 +711,8 @@ void sd_sdio_ctor(sd_card_t *sd_card_p) {
     sd_card_p->write_blocks = sd_sdio_write_blocks;
     sd_card_p->read_blocks = sd_sdio_read_blocks;
     sd_card_p->sync = sd_sync;
+    sd_card_p->write_blocks_start = sd_sdio_write_blocks_start;
+    sd_card_p->write_blocks_poll = sd_sdio_write_blocks_poll;
     sd_card_p->get_num_sectors = sd_sdio_sectorCount;
     sd_card_p->sd_test_com = sd_sdio_test_com;
 }
@@ -98,19 +98,20 @@ static bool chk_dmas(spi_t *spi_p) {
     return tx_ok && rx_ok;
 }
 
-/**
- * @brief Start a SPI transfer by configuring and starting the DMA channels.
- *
- * @param spi_p Pointer to the SPI object.
- * @param tx Pointer to the transmit buffer. If NULL, data will be filled with SPI_FILL_CHAR.
- * @param rx Pointer to the receive buffer. If NULL, data will be ignored.
- * @param length Length of the transfer.
- */
-void __not_in_flash_func(spi_transfer_start)(spi_t *spi_p, const uint8_t *tx, uint8_t *rx,
-                                             size_t length) {
+static void __not_in_flash_func(spi_transfer_start_ex)(spi_t *spi_p, const uint8_t *tx,
+                                                       uint8_t *rx, size_t length, bool sniff) {
     myASSERT(spi_p);
     myASSERT(tx || rx);
 
+    // The sniffer watches the channel that carries the data: RX for reads, TX for writes.
+    // Both configs are persistent, so the bit is set (or cleared) on every transfer.
+    channel_config_set_sniff_enable(&spi_p->rx_dma_cfg, sniff && rx);
+    channel_config_set_sniff_enable(&spi_p->tx_dma_cfg, sniff && !rx);
+    if (sniff) {
+        dma_sniffer_enable(rx ? spi_p->rx_dma : spi_p->tx_dma, DMA_SNIFF_CTRL_CALC_VALUE_CRC16, false);
+        dma_sniffer_set_data_accumulator(0);  // SD CRC16: CRC-16-CCITT with a zero seed
+    }
+
     // tx write increment is already false
     if (tx) {
         channel_config_set_read_increment(&spi_p->tx_dma_cfg, true);
@@ -150,6 +151,48 @@ void __not_in_flash_func(spi_transfer_start)(spi_t *spi_p, const uint8_t *tx, ui
     dma_start_channel_mask((1u << spi_p->tx_dma) | (1u << spi_p->rx_dma));
 }
 
+/**
+ * @brief Start a SPI transfer by configuring and starting the DMA channels.
+ *
+ * @param spi_p Pointer to the SPI object.
+ * @param tx Pointer to the transmit buffer. If NULL, data will be filled with SPI_FILL_CHAR.
+ * @param rx Pointer to the receive buffer. If NULL, data will be ignored.
+ * @param length Length of the transfer.
+ */
+void __not_in_flash_func(spi_transfer_start)(spi_t *spi_p, const uint8_t *tx, uint8_t *rx,
+                                             size_t length) {
+    spi_transfer_start_ex(spi_p, tx, rx, length, false);
+}
+
+/**
+ * @brief Start a SPI transfer with the DMA sniffer computing the SD CRC16 of the data.
+ *
+ * The CRC covers the received data if rx is given, otherwise the transmitted data,
+ * and costs no CPU time. Collect it with spi_transfer_sniffed_crc16() once the
+ * transfer is complete.
+ *
+ * The sniffer is a single resource shared by all DMA channels. If it is compiled out
+ * (SPI_CRC_DMA_SNIFFER=0) or already enabled by someone else, the transfer is started
+ * without it and the caller falls back to crc16().
+ *
+ * @return true if the sniffer is computing the CRC.
+ */
+bool __not_in_flash_func(spi_transfer_start_sniff_crc)(spi_t *spi_p, const uint8_t *tx,
+                                                       uint8_t *rx, size_t length) {
+    bool sniff = SPI_CRC_DMA_SNIFFER && !(dma_hw->sniff_ctrl & DMA_SNIFF_CTRL_EN_BITS);
+    spi_transfer_start_ex(spi_p, tx, rx, length, sniff);
+    return sniff;
+}
+
+/**
+ * @brief Read the CRC16 of a spi_transfer_start_sniff_crc() transfer and release the sniffer.
+ */
+uint16_t __not_in_flash_func(spi_transfer_sniffed_crc16)(void) {
+    uint16_t crc = (uint16_t)dma_sniffer_get_data_accumulator();
+    dma_sniffer_disable();
+    return crc;
+}
+
 /**
  * Calculate the time in milliseconds to transfer the given number of blocks
  * over the SPI bus at the given baud rate.
@@ -37,6 +37,12 @@ extern "C" {
 
 #define SPI_FILL_CHAR (0xFF)
 
+// 1: compute the SD data CRC16 with the DMA sniffer during the transfer
+// (spi_transfer_start_sniff_crc), 0: always in software (crc16)
+#ifndef SPI_CRC_DMA_SNIFFER
+#define SPI_CRC_DMA_SNIFFER 1
+#endif
+
 // "Class" representing SPIs
 typedef struct spi_t {
     spi_inst_t *hw_inst;    // SPI HW
@@ -80,6 +86,8 @@ typedef struct spi_t {
 } spi_t;
 
 void spi_transfer_start(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length);
+bool spi_transfer_start_sniff_crc(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length);
+uint16_t spi_transfer_sniffed_crc16(void);
 uint32_t calculate_transfer_time_ms(spi_t *spi_p, uint32_t bytes);
 bool spi_transfer_wait_complete(spi_t *spi_p, uint32_t timeout_ms);
 bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length);
@@ -854,8 +854,12 @@ static block_dev_err_t in_sd_read_blocks(sd_card_t *sd_card_p, uint8_t *buffer,
             DBG_PRINTF("%s:%d Read timeout\n", __func__, __LINE__);
             return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
         }
-        // read data
-        sd_spi_transfer_start(sd_card_p, NULL, buffer, sd_block_size);
+        // read data; if it can, the DMA sniffer computes the CRC on the way in
+        bool sniffed = false;
+        if (crc_on)
+            sniffed = sd_spi_transfer_start_sniff_crc(sd_card_p, NULL, buffer, sd_block_size);
+        else
+            sd_spi_transfer_start(sd_card_p, NULL, buffer, sd_block_size);
 
         // Check the CRC16 checksum for the previous data block
         if (prev_buffer_addr) {
@@ -863,18 +867,30 @@ static block_dev_err_t in_sd_read_blocks(sd_card_t *sd_card_p, uint8_t *buffer,
             if (!chk_crc16(prev_buffer_addr, sd_block_size, prev_block_crc)) {
                 DBG_PRINTF("%s: Invalid CRC received: 0x%" PRIx16 "\n", __func__,
                            prev_block_crc);
+                if (sniffed) spi_transfer_sniffed_crc16();  // release the sniffer
                 return SD_BLOCK_DEVICE_ERROR_CRC;
             }
+            prev_buffer_addr = 0;
         }
         
         uint32_t timeout = calculate_transfer_time_ms(sd_card_p->spi_if_p->spi, sd_block_size);
         bool ok = sd_spi_transfer_wait_complete(sd_card_p, timeout);
+        uint16_t sniffed_crc = sniffed ? spi_transfer_sniffed_crc16() : 0;
         if (!ok) return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
 
         // Read the CRC16 checksum for the data block
         prev_block_crc = sd_spi_read(sd_card_p) << 8;
         prev_block_crc |= sd_spi_read(sd_card_p);
-        prev_buffer_addr = buffer;
+        if (sniffed) {
+            // Already computed during the transfer
+            if (sniffed_crc != prev_block_crc) {
+                DBG_PRINTF("%s: Invalid CRC received: 0x%" PRIx16 " computed: 0x%" PRIx16 "\n",
+                           __func__, prev_block_crc, sniffed_crc);
+                return SD_BLOCK_DEVICE_ERROR_CRC;
+            }
+        } else {
+            prev_buffer_addr = buffer;
+        }
         buffer += sd_block_size;
         --blk_cnt;
     }
@@ -884,8 +900,8 @@ static block_dev_err_t in_sd_read_blocks(sd_card_t *sd_card_p, uint8_t *buffer,
         status = sd_cmd(sd_card_p, CMD12_STOP_TRANSMISSION, 0x0, false, 0);
         if (SD_BLOCK_DEVICE_ERROR_NONE != status) return status;
     }
-    // Check final block's CRC:
-    if (!chk_crc16(prev_buffer_addr, sd_block_size, prev_block_crc)) {
+    // Check final block's CRC (unless the sniffer did):
+    if (prev_buffer_addr && !chk_crc16(prev_buffer_addr, sd_block_size, prev_block_crc)) {
         DBG_PRINTF("%s: Invalid CRC received: 0x%" PRIx16 "\n", __func__, prev_block_crc);
         return SD_BLOCK_DEVICE_ERROR_CRC;
     }
@@ -977,8 +993,12 @@ static block_dev_err_t send_block(sd_card_t *sd_card_p, const uint8_t *buffer, u
         return SD_BLOCK_DEVICE_ERROR_WRITE;
     }
 
-    // Write the data
-    sd_spi_transfer_start(sd_card_p, buffer, NULL, length);
+    // Write the data; if it can, the DMA sniffer computes the CRC on the way out
+    bool sniffed = false;
+    if (crc_on)
+        sniffed = sd_spi_transfer_start_sniff_crc(sd_card_p, buffer, NULL, length);
+    else
+        sd_spi_transfer_start(sd_card_p, buffer, NULL, length);
 
     /* Optimization:
     While the DMA is busy transfering the block data,
@@ -989,12 +1009,13 @@ static block_dev_err_t send_block(sd_card_t *sd_card_p, const uint8_t *buffer, u
 
     uint16_t crc = (~0);
     // While DMA transfers the block, compute CRC:
-    if (crc_on) {
+    if (crc_on && !sniffed) {
         // Compute CRC
         crc = crc16((void *)buffer, length);
     }
     uint32_t timeout = calculate_transfer_time_ms(sd_card_p->spi_if_p->spi, length);
     bool ok = sd_spi_transfer_wait_complete(sd_card_p, timeout);
+    if (sniffed) crc = spi_transfer_sniffed_crc16();
     if (!ok) return SD_BLOCK_DEVICE_ERROR_WRITE;
 
     // Write the checksum CRC16
@@ -1306,6 +1327,158 @@ static block_dev_err_t sd_sync(sd_card_t *sd_card_p) {
     return status;
 }
 
+/* Phases of a write_blocks_start()/write_blocks_poll() write */
+enum { SPI_ASYNC_IDLE, SPI_ASYNC_DMA, SPI_ASYNC_PROGRAMMING };
+
+/**
+ * @brief Start clocking out the current block of a non-blocking write.
+ *
+ * Same sequence as send_block() up to the DMA: start token, DMA start and,
+ * while the DMA runs, the CRC16. The rest happens in sd_write_blocks_poll().
+ */
+static bool async_send_block(sd_card_t *sd_card_p) {
+    sd_spi_if_state_t *st = &sd_card_p->spi_if_p->state;
+
+    if (!sd_spi_write_read(sd_card_p, SPI_START_BLK_MUL_WRITE)) {
+        DBG_PRINTF("Start Block Token not accepted\n");
+        return false;
+    }
+    st->async_sniffed = false;
+    if (crc_on)
+        st->async_sniffed = sd_spi_transfer_start_sniff_crc(sd_card_p, st->async_buf, NULL, sd_block_size);
+    else
+        sd_spi_transfer_start(sd_card_p, st->async_buf, NULL, sd_block_size);
+    st->async_crc = (crc_on && !st->async_sniffed) ? crc16((void *)st->async_buf, sd_block_size) : (uint16_t)~0;
+    st->async_phase = SPI_ASYNC_DMA;
+    st->async_phase_ms = millis();
+    return true;
+}
+
+static block_dev_err_t async_fail(sd_card_t *sd_card_p) {
+    sd_card_p->spi_if_p->state.async_phase = SPI_ASYNC_IDLE;
+    stop_wr_tran(sd_card_p);  // Ignore return value
+    sd_release(sd_card_p);
+    return SD_BLOCK_DEVICE_ERROR_WRITE;
+}
+
+/**
+ * @brief Start a non-blocking multiple block write
+ *
+ * Continues an ongoing CMD25 if data_address is contiguous, like
+ * in_sd_write_blocks(), otherwise stops it and issues a new one. Returns
+ * as soon as the first block is being clocked out by DMA. The card stays
+ * acquired until sd_write_blocks_poll() reports completion.
+ *
+ * @return SD_BLOCK_DEVICE_ERROR_NONE if the write was started, an error code otherwise
+ */
+static block_dev_err_t sd_write_blocks_start(sd_card_t *sd_card_p, const uint8_t *buffer,
+                                             uint32_t data_address, uint32_t num_wrt_blks)
+{
+    TRACE_PRINTF("%s(0x%p, 0x%lx, 0x%lx)\n", __func__, buffer, data_address, num_wrt_blks);
+    if (NULL == sd_card_p) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (sd_card_p->state.m_Status & (STA_NOINIT | STA_NODISK))
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (!num_wrt_blks) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (data_address + num_wrt_blks >= sd_card_p->state.sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+
+    sd_spi_if_state_t *st = &sd_card_p->spi_if_p->state;
+    if (SPI_ASYNC_IDLE != st->async_phase) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+
+    sd_acquire(sd_card_p);
+
+    block_dev_err_t status;
+    if (!(st->ongoing_mlt_blk_wrt && st->cont_sector_wrt == data_address)) {
+        if (st->ongoing_mlt_blk_wrt) {
+            status = stop_wr_tran(sd_card_p);
+            if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+                sd_release(sd_card_p);
+                return status;
+            }
+        }
+        status = sd_cmd(sd_card_p, CMD25_WRITE_MULTIPLE_BLOCK, data_address, false, 0);
+        if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+            sd_release(sd_card_p);
+            return status;
+        }
+        st->n_wrt_blks_reqd = 0;
+    }
+    st->n_wrt_blks_reqd += num_wrt_blks;
+    // Not continuable until every block is through
+    st->ongoing_mlt_blk_wrt = false;
+    st->cont_sector_wrt = data_address;
+    st->async_buf = buffer;
+    st->async_blks = num_wrt_blks;
+
+    if (!async_send_block(sd_card_p)) return async_fail(sd_card_p);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+/**
+ * @brief Advance a write started by sd_write_blocks_start()
+ *
+ * Never waits: each call checks the DMA, or sends the CRC and checks the data
+ * response token, or reads one busy byte while the card programs the block.
+ * The DMA phase times out after calculate_transfer_time_ms(), programming
+ * after sd_timeouts.sd_command, as in send_block().
+ *
+ * @return
+ * - SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK while the write is in progress
+ * - SD_BLOCK_DEVICE_ERROR_NONE once all blocks are written (or if none was started)
+ * - SD_BLOCK_DEVICE_ERROR_WRITE if the write failed; the transmission is stopped
+ */
+static block_dev_err_t sd_write_blocks_poll(sd_card_t *sd_card_p) {
+    sd_spi_if_state_t *st = &sd_card_p->spi_if_p->state;
+    spi_t *spi_p = sd_card_p->spi_if_p->spi;
+
+    switch (st->async_phase) {
+        case SPI_ASYNC_IDLE:
+            return SD_BLOCK_DEVICE_ERROR_NONE;
+
+        case SPI_ASYNC_DMA: {
+            bool busy = dma_channel_is_busy(spi_p->rx_dma) || dma_channel_is_busy(spi_p->tx_dma) ||
+                        spi_is_busy(spi_p->hw_inst);
+            if (busy && millis() - st->async_phase_ms < calculate_transfer_time_ms(spi_p, sd_block_size))
+                return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+            // Finished or timed out: a zero wait checks which, and aborts the DMA if needed
+            bool ok = sd_spi_transfer_wait_complete(sd_card_p, 0);
+            if (st->async_sniffed) st->async_crc = spi_transfer_sniffed_crc16();
+            if (!ok) return async_fail(sd_card_p);
+
+            sd_spi_write(sd_card_p, st->async_crc >> 8);
+            sd_spi_write(sd_card_p, st->async_crc);
+            uint8_t response = sd_spi_read(sd_card_p);
+            if ((response & SPI_DATA_RESPONSE_MASK) != SPI_DATA_ACCEPTED) {
+                EMSG_PRINTF("%s: Block Write not accepted. Response token: 0x%x\n",
+                            sd_get_drive_prefix(sd_card_p), response);
+                return async_fail(sd_card_p);
+            }
+            st->async_phase = SPI_ASYNC_PROGRAMMING;
+            st->async_phase_ms = millis();
+            return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+        }
+
+        case SPI_ASYNC_PROGRAMMING:
+            if (sd_spi_write_read(sd_card_p, 0xFF) != 0xFF) {
+                if (millis() - st->async_phase_ms < sd_timeouts.sd_command)
+                    return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+                DBG_PRINTF("%s: Card not ready yet\n", __func__);
+                return async_fail(sd_card_p);
+            }
+            st->async_buf += sd_block_size;
+            ++st->cont_sector_wrt;
+            if (--st->async_blks) {
+                if (!async_send_block(sd_card_p)) return async_fail(sd_card_p);
+                return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+            }
+            st->async_phase = SPI_ASYNC_IDLE;
+            st->ongoing_mlt_blk_wrt = true;  // The next contiguous write continues the CMD25
+            sd_release(sd_card_p);
+            return SD_BLOCK_DEVICE_ERROR_NONE;
+    }
+    return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+}
+
 /*!< Number of retries for sending CMDO */
 #define SD_CMD0_GO_IDLE_STATE_RETRIES 10
 
@@ -1710,6 +1883,8 @@ void sd_spi_ctor(sd_card_t *sd_card_p) {
     sd_card_p->write_blocks = sd_write_blocks;
     sd_card_p->read_blocks = sd_read_blocks;
     sd_card_p->sync = sd_sync;
+    sd_card_p->write_blocks_start = sd_write_blocks_start;
+    sd_card_p->write_blocks_poll = sd_write_blocks_poll;
     sd_card_p->init = sd_card_spi_init;
     sd_card_p->deinit = sd_deinit;
     sd_card_p->get_num_sectors = sd_spi_sectors;
@@ -120,6 +120,10 @@ static inline void sd_spi_transfer_start(sd_card_t *sd_card_p, const uint8_t *tx
                                          size_t length) {
     return spi_transfer_start(sd_card_p->spi_if_p->spi, tx, rx, length);
 }
+static inline bool sd_spi_transfer_start_sniff_crc(sd_card_t *sd_card_p, const uint8_t *tx,
+                                                   uint8_t *rx, size_t length) {
+    return spi_transfer_start_sniff_crc(sd_card_p->spi_if_p->spi, tx, rx, length);
+}
 static inline bool sd_spi_transfer_wait_complete(sd_card_t *sd_card_p, uint32_t timeout_ms) {
     return spi_transfer_wait_complete(sd_card_p->spi_if_p->spi, timeout_ms);
 }
@@ -58,6 +58,14 @@ bool sd_is_locked(sd_card_t *sd_card_p) {
     return !mutex_try_enter(&sd_card_p->state.mutex, &owner_out);
 }
 
+block_dev_err_t sd_write_blocks_complete(sd_card_t *sd_card_p) {
+    block_dev_err_t rc;
+    do {
+        rc = sd_card_p->write_blocks_poll(sd_card_p);
+    } while (SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK == rc);
+    return rc;
+}
+
 sd_card_t *sd_get_by_drive_prefix(const char *const drive_prefix) {
     // Numeric drive number is always valid
     if (2 == strlen(drive_prefix) && isdigit((unsigned char)drive_prefix[0]) &&
@@ -46,6 +46,13 @@ typedef struct sd_spi_if_state_t {
     bool ongoing_mlt_blk_wrt;
     uint32_t cont_sector_wrt;
     uint32_t n_wrt_blks_reqd;
+    // write_blocks_start()/write_blocks_poll() in progress
+    const uint8_t *async_buf;  // block currently on the bus
+    uint32_t async_blks;       // blocks left, including that one
+    uint32_t async_phase_ms;   // start of the current phase, for the timeouts
+    uint16_t async_crc;
+    bool async_sniffed;        // async_crc comes from the DMA sniffer
+    uint8_t async_phase;
 } sd_spi_if_state_t;
 
 typedef struct sd_spi_if_t {
@@ -137,6 +144,17 @@ struct sd_card_t {
     block_dev_err_t (*sync)(sd_card_t *sd_card_p);
     uint32_t (*get_num_sectors)(sd_card_t *sd_card_p);
 
+    /* Non-blocking multi-block write. write_blocks_start() issues (or continues)
+    the CMD25 and returns once the first block is on its way; write_blocks_poll()
+    advances it and returns SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK until the last
+    block is programmed (or the write failed). The buffer must stay untouched
+    until then, and the card is held locked in between: no other operation on
+    this card may be issued before completion (see sd_write_blocks_complete()).
+    Timeouts come from sd_timeouts, as for write_blocks(). */
+    block_dev_err_t (*write_blocks_start)(sd_card_t *sd_card_p, const uint8_t *buffer,
+                                          uint32_t ulSectorNumber, uint32_t blockCnt);
+    block_dev_err_t (*write_blocks_poll)(sd_card_t *sd_card_p);
+
     // Useful when use_card_detect is false - call periodically to check for presence of SD card
     // Returns true if and only if SD card was sensed on the bus
     bool (*sd_test_com)(sd_card_t *sd_card_p);
@@ -151,6 +169,8 @@ bool sd_card_detect(sd_card_t *sd_card_p);
 void cidDmp(sd_card_t *sd_card_p, printer_t printer);
 void csdDmp(sd_card_t *sd_card_p, printer_t printer);
 bool sd_allocation_unit(sd_card_t *sd_card_p, size_t *au_size_bytes_p);
+// Polls a write_blocks_start() write until it has finished.
+block_dev_err_t sd_write_blocks_complete(sd_card_t *sd_card_p);
 sd_card_t *sd_get_by_drive_prefix(const char *const name);
 
 // sd_init_driver() must be called before this: